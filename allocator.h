@@ -0,0 +1,857 @@
+/********************************************************
+ * \file
+ * \brief Заголовочный файл с аллокаторами для контейнеров pva
+ ********************************************************
+ * Файл содержит в себе реализацию аллокатора на malloc/realloc
+ * 'malloc_allocator', аллокатора выровненной памяти с большими
+ * страницами 'aligned_allocator', монотонного буфера
+ * 'monotonic_buffer', аллокатора 'arena_allocator' и
+ * аллокатора с внутренним буфером 'inline_allocator'
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace pva {
+    
+    /********************************************************
+     * \brief Результат allocate_at_least
+     ********************************************************
+     * Аналог std::allocation_result из C++23. Контейнеры pva
+     * вызывают allocate_at_least, если аллокатор его умеет,
+     * и используют всю выделенную память
+     */
+    
+    template<class Pointer>
+    struct allocation_result {
+        Pointer ptr; /*< Указатель на выделенную память*/
+        std::size_t count; /*< Число элементов, под которые выделена память*/
+    };
+    
+    /********************************************************
+     * \brief Аллокатор на malloc/realloc
+     ********************************************************
+     * Аллокатор по умолчанию для контейнеров pva. Кроме
+     * обычных allocate/deallocate умеет reallocate: буфер
+     * побайтово переносимых элементов растет через realloc,
+     * а буферы от MmapThreshold байт (на Linux) выделяются
+     * через mmap и растут через mremap, то есть без
+     * копирования даже для многогигабайтных векторов
+     */
+    
+    template<class T, std::size_t MmapThreshold = (std::size_t(64) << 20)>
+    class malloc_allocator {
+    public:
+        typedef T value_type;
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type is_always_equal;
+        
+        template<class U>
+        struct rebind {
+            typedef malloc_allocator<U, MmapThreshold> other;
+        };
+        
+        static const std::size_t mmap_threshold = MmapThreshold; /*< Размер буфера для mmap*/
+        
+        malloc_allocator() noexcept {}
+        
+        template<class U>
+        malloc_allocator(const malloc_allocator<U, MmapThreshold>&) noexcept {}
+        
+        /********************************************************
+         * Выделение памяти под count элементов
+         */
+        
+        T* allocate(const std::size_t &count) {
+            if (count > std::size_t(-1) / sizeof(T))
+                throw std::bad_array_new_length();
+            return static_cast<T*>(allocate_bytes(count * sizeof(T)));
+        }
+        
+        /********************************************************
+         * Освобождение памяти под count элементов
+         */
+        
+        void deallocate(T* data, const std::size_t &count) noexcept {
+            deallocate_bytes(data, count * sizeof(T));
+        }
+        
+        /********************************************************
+         * Занимает ли буфер под count элементов собственные
+         * страницы (выделен через mmap, а не в куче malloc)
+         ********************************************************
+         * Только такой буфер можно размещать по узлам NUMA
+         * через mbind, не задевая соседние данные кучи
+         */
+        
+        static bool owns_pages(const std::size_t &count) noexcept {
+            return mapped(count * sizeof(T));
+        }
+        
+        /********************************************************
+         * Изменение размера буфера с сохранением содержимого
+         ********************************************************
+         * Содержимое переносится побайтово, поэтому годится
+         * только для побайтово переносимых элементов. При
+         * исключении старый буфер остается нетронутым
+         ********************************************************
+         * \param data Буфер, выделенный этим аллокатором
+         * \param count Число элементов, под которые выделен data
+         * \param size Новое число элементов
+         * \return Новый буфер (может совпадать с data)
+         */
+        
+        T* reallocate(T* data, const std::size_t &count, const std::size_t &size) {
+            if (size > std::size_t(-1) / sizeof(T))
+                throw std::bad_array_new_length();
+            const std::size_t from = count * sizeof(T);
+            const std::size_t to = size * sizeof(T);
+#if defined(__linux__)
+            if (mapped(from) && mapped(to)) {
+                void* result = mremap(data, from, to, MREMAP_MAYMOVE);
+                if (result == MAP_FAILED)
+                    throw std::bad_alloc();
+                return static_cast<T*>(result);
+            }
+#endif
+            if (!mapped(from) && !mapped(to) && !over_aligned) {
+                void* result = std::realloc(static_cast<void*>(data), to);
+                if (!result)
+                    throw std::bad_alloc();
+                return static_cast<T*>(result);
+            }
+            void* result = allocate_bytes(to);
+            std::memcpy(result, data, from < to ? from : to);
+            deallocate_bytes(data, from);
+            return static_cast<T*>(result);
+        }
+        
+    private:
+        static const bool over_aligned = alignof(T) > alignof(std::max_align_t); /*< malloc не выровняет*/
+        
+        /********************************************************
+         * Выделяется ли буфер такого размера через mmap
+         */
+        
+        static bool mapped(const std::size_t &bytes) noexcept {
+#if defined(__linux__)
+            return bytes >= MmapThreshold;
+#else
+            (void)bytes;
+            return false;
+#endif
+        }
+        
+        static void* allocate_bytes(const std::size_t &bytes) {
+            void* result;
+#if defined(__linux__)
+            if (mapped(bytes)) {
+                result = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (result == MAP_FAILED)
+                    throw std::bad_alloc();
+                return result;
+            }
+#endif
+            if (over_aligned)
+                result = std::aligned_alloc(alignof(T), (bytes + alignof(T) - 1) / alignof(T) * alignof(T));
+            else
+                result = std::malloc(bytes);
+            if (!result)
+                throw std::bad_alloc();
+            return result;
+        }
+        
+        static void deallocate_bytes(void* data, const std::size_t &bytes) noexcept {
+#if defined(__linux__)
+            if (mapped(bytes)) {
+                munmap(data, bytes);
+                return;
+            }
+#endif
+            std::free(data);
+        }
+    };
+    
+    /********************************************************
+     * Перегруженный оператор == (сравнение)
+     ********************************************************
+     * \return True - любые malloc_allocator взаимозаменяемы
+     */
+    
+    template<class T, class U, std::size_t MmapThreshold>
+    inline bool
+    operator ==(const malloc_allocator<T, MmapThreshold>&, const malloc_allocator<U, MmapThreshold>&) noexcept {
+        return true;
+    }
+    
+    /********************************************************
+     * Перегруженный оператор != (не равно)
+     */
+    
+    template<class T, class U, std::size_t MmapThreshold>
+    inline bool
+    operator !=(const malloc_allocator<T, MmapThreshold>&, const malloc_allocator<U, MmapThreshold>&) noexcept {
+        return false;
+    }
+    
+    /********************************************************
+     * \brief Аллокатор выровненной памяти
+     ********************************************************
+     * Буфер выравнивается на Alignment байт (например, 64 -
+     * строка кэша для выровненных загрузок AVX-512, 4096 -
+     * страница). Буферы от HugePageThreshold байт (на Linux)
+     * выделяются через mmap с выравниванием на 2 МБ и
+     * помечаются MADV_HUGEPAGE, чтобы ядро отдало их большими
+     * страницами (transparent huge pages) и обход большого
+     * вектора реже промахивался мимо TLB. Такой буфер
+     * округляется до целого числа больших страниц, и
+     * allocate_at_least сообщает контейнеру всю его емкость.
+     * По умолчанию большие страницы не используются
+     */
+    
+    template<class T, std::size_t Alignment = 64, std::size_t HugePageThreshold = std::size_t(-1)>
+    class aligned_allocator {
+        static_assert(Alignment != 0 && (Alignment & (Alignment - 1)) == 0,
+                      "Alignment must be a power of two");
+        
+    public:
+        typedef T value_type;
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type is_always_equal;
+        
+        template<class U>
+        struct rebind {
+            typedef aligned_allocator<U, Alignment, HugePageThreshold> other;
+        };
+        
+        static const std::size_t alignment = Alignment > alignof(T) ? Alignment : alignof(T); /*< Выравнивание буфера*/
+        static const std::size_t huge_page_threshold = HugePageThreshold; /*< Размер буфера для больших страниц*/
+        static const std::size_t huge_page_size = std::size_t(2) << 20; /*< Размер большой страницы*/
+        
+        aligned_allocator() noexcept {}
+        
+        template<class U>
+        aligned_allocator(const aligned_allocator<U, Alignment, HugePageThreshold>&) noexcept {}
+        
+        /********************************************************
+         * Выделение памяти под count элементов
+         */
+        
+        T* allocate(const std::size_t &count) {
+            return allocate_at_least(count).ptr;
+        }
+        
+        /********************************************************
+         * Выделение памяти не меньше чем под count элементов
+         ********************************************************
+         * Буфер на больших страницах вмещает больше элементов,
+         * чем запрошено, и все они возвращаются контейнеру
+         */
+        
+        allocation_result<T*> allocate_at_least(const std::size_t &count) {
+            if (count > (std::size_t(-1) - huge_page_size) / sizeof(T))
+                throw std::bad_array_new_length();
+            const std::size_t bytes = rounded(count * sizeof(T));
+            return allocation_result<T*>{static_cast<T*>(allocate_bytes(bytes)), bytes / sizeof(T)};
+        }
+        
+        /********************************************************
+         * Освобождение памяти под count элементов
+         */
+        
+        void deallocate(T* data, const std::size_t &count) noexcept {
+            deallocate_bytes(data, rounded(count * sizeof(T)));
+        }
+        
+        /********************************************************
+         * Занимает ли буфер под count элементов собственные
+         * страницы (большие страницы через mmap)
+         */
+        
+        static bool owns_pages(const std::size_t &count) noexcept {
+            return huge(rounded(count * sizeof(T)));
+        }
+        
+        /********************************************************
+         * Изменение размера буфера с сохранением содержимого
+         ********************************************************
+         * Буфер на больших страницах растет через mremap без
+         * копирования: на месте, а если за ним занято - переносом
+         * страниц (MREMAP_FIXED) на заранее выровненный на 2 МБ
+         * адрес (MREMAP_MAYMOVE сохраняет только выравнивание
+         * на страницу). Остальные копируются в новый буфер.
+         * При исключении старый буфер остается нетронутым
+         ********************************************************
+         * \param data Буфер, выделенный этим аллокатором
+         * \param count Число элементов, под которые выделен data
+         * \param size Новое число элементов
+         * \return Новый буфер (может совпадать с data)
+         */
+        
+        T* reallocate(T* data, const std::size_t &count, const std::size_t &size) {
+            if (size > (std::size_t(-1) - huge_page_size) / sizeof(T))
+                throw std::bad_array_new_length();
+            const std::size_t from = rounded(count * sizeof(T));
+            const std::size_t to = rounded(size * sizeof(T));
+#if defined(__linux__)
+            if (huge(from) && huge(to)) {
+                void* result = mremap(data, from, to, 0);
+                if (result == MAP_FAILED) {
+                    void* target = allocate_bytes(to);
+                    result = mremap(data, from, to, MREMAP_MAYMOVE | MREMAP_FIXED, target);
+                    if (result == MAP_FAILED) {
+                        deallocate_bytes(target, to);
+                        throw std::bad_alloc();
+                    }
+                }
+                madvise(result, to, MADV_HUGEPAGE);
+                return static_cast<T*>(result);
+            }
+#endif
+            void* result = allocate_bytes(to);
+            std::memcpy(result, data, from < to ? from : to);
+            deallocate_bytes(data, from);
+            return static_cast<T*>(result);
+        }
+        
+    private:
+        
+        /********************************************************
+         * Выделяется ли буфер такого размера на больших страницах
+         */
+        
+        static bool huge(const std::size_t &bytes) noexcept {
+#if defined(__linux__)
+            return bytes >= HugePageThreshold;
+#else
+            (void)bytes;
+            return false;
+#endif
+        }
+        
+        /********************************************************
+         * Размер буфера под bytes байт: кратный выравниванию
+         * (этого требует aligned_alloc) или большой странице
+         */
+        
+        static std::size_t rounded(const std::size_t &bytes) noexcept {
+            const std::size_t step = huge(bytes) ? huge_page_size : alignment;
+            return (bytes + step - 1) / step * step;
+        }
+        
+        static void* allocate_bytes(const std::size_t &bytes) {
+            void* result;
+#if defined(__linux__)
+            if (huge(bytes)) {
+                // Лишние 2 МБ позволяют выровнять начало буфера на большую страницу
+                const std::size_t mapped = bytes + huge_page_size;
+                void* region = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (region == MAP_FAILED)
+                    throw std::bad_alloc();
+                char* begin = static_cast<char*>(region);
+                char* aligned = reinterpret_cast<char*>(
+                    (reinterpret_cast<std::uintptr_t>(begin) + huge_page_size - 1) / huge_page_size * huge_page_size);
+                if (aligned != begin)
+                    munmap(begin, aligned - begin);
+                if (aligned + bytes != begin + mapped)
+                    munmap(aligned + bytes, begin + mapped - aligned - bytes);
+                madvise(aligned, bytes, MADV_HUGEPAGE);
+                return aligned;
+            }
+#endif
+            if (alignment <= alignof(std::max_align_t))
+                result = std::malloc(bytes);
+            else
+                result = std::aligned_alloc(alignment, bytes);
+            if (!result)
+                throw std::bad_alloc();
+            return result;
+        }
+        
+        static void deallocate_bytes(void* data, const std::size_t &bytes) noexcept {
+#if defined(__linux__)
+            if (huge(bytes)) {
+                munmap(data, bytes);
+                return;
+            }
+#endif
+            std::free(data);
+        }
+    };
+    
+    /********************************************************
+     * Перегруженный оператор == (сравнение)
+     ********************************************************
+     * \return True - любые aligned_allocator с одинаковыми
+     * параметрами взаимозаменяемы
+     */
+    
+    template<class T, class U, std::size_t Alignment, std::size_t HugePageThreshold>
+    inline bool operator ==(const aligned_allocator<T, Alignment, HugePageThreshold>&,
+                            const aligned_allocator<U, Alignment, HugePageThreshold>&) noexcept {
+        return true;
+    }
+    
+    /********************************************************
+     * Перегруженный оператор != (не равно)
+     */
+    
+    template<class T, class U, std::size_t Alignment, std::size_t HugePageThreshold>
+    inline bool operator !=(const aligned_allocator<T, Alignment, HugePageThreshold>&,
+                            const aligned_allocator<U, Alignment, HugePageThreshold>&) noexcept {
+        return false;
+    }
+    
+    /********************************************************
+     * \brief Монотонный буфер памяти (арена)
+     ********************************************************
+     * Память выделяется сдвигом указателя внутри блоков и
+     * освобождается только целиком: при вызове release() или
+     * в деструкторе. Освобождение отдельных участков ничего не
+     * делает, кроме возврата последнего выделенного участка.
+     * Класс не потокобезопасен
+     */
+    
+    class monotonic_buffer {
+    public:
+        /********************************************************
+         * Конструктор арены
+         ********************************************************
+         * \param block_size Размер первого блока в байтах
+         */
+        
+        explicit monotonic_buffer(const std::size_t &block_size = 64 * 1024) noexcept
+        :block_size_(block_size ? block_size : 1), blocks_(nullptr),
+        begin_(nullptr), current_(nullptr), end_(nullptr), initial_(nullptr), initial_size_(0) {}
+        
+        /********************************************************
+         * Конструктор арены над внешним буфером
+         ********************************************************
+         * Сначала используется buffer, затем блоки из кучи.
+         * Буфер должен жить дольше арены
+         ********************************************************
+         * \param buffer Начало внешнего буфера
+         * \param size Размер внешнего буфера в байтах
+         */
+        
+        monotonic_buffer(void* buffer, const std::size_t &size) noexcept
+        :block_size_(size ? size : 1), blocks_(nullptr),
+        begin_(static_cast<char*>(buffer)), current_(begin_), end_(begin_ + size),
+        initial_(begin_), initial_size_(size) {}
+        
+        monotonic_buffer(const monotonic_buffer&) = delete;
+        monotonic_buffer& operator =(const monotonic_buffer&) = delete;
+        
+        /********************************************************
+         * Деструктор
+         ********************************************************
+         * Освобождает все блоки арены
+         */
+        
+        ~monotonic_buffer() {
+            release();
+        }
+        
+        /********************************************************
+         * Выделение памяти
+         ********************************************************
+         * \param bytes Размер участка в байтах
+         * \param alignment Выравнивание участка (степень двойки)
+         * \return Указатель на выделенный участок
+         */
+        
+        void* allocate(const std::size_t &bytes, const std::size_t &alignment) {
+            char* place = align(current_, alignment);
+            if (!place || static_cast<std::size_t>(end_ - place) < bytes) {
+                next_block(bytes, alignment);
+                place = align(current_, alignment);
+            }
+            begin_ = place;
+            current_ = place + bytes;
+            return place;
+        }
+        
+        /********************************************************
+         * Освобождение участка памяти
+         ********************************************************
+         * Если участок выделен последним, указатель арены
+         * возвращается назад, иначе ничего не происходит
+         ********************************************************
+         * \param data Начало участка
+         * \param bytes Размер участка в байтах
+         */
+        
+        void deallocate(void* data, const std::size_t &bytes) noexcept {
+            if (data == begin_ && static_cast<char*>(data) + bytes == current_)
+                current_ = begin_;
+        }
+        
+        /********************************************************
+         * Изменение размера участка памяти
+         ********************************************************
+         * Последний выделенный участок расширяется на месте, если
+         * в блоке хватает места, иначе содержимое копируется в
+         * новый участок
+         ********************************************************
+         * \param data Начало участка
+         * \param bytes Текущий размер участка в байтах
+         * \param size Новый размер участка в байтах
+         * \param alignment Выравнивание участка
+         * \return Начало нового участка (может совпадать с data)
+         */
+        
+        void* reallocate(void* data, const std::size_t &bytes, const std::size_t &size,
+                         const std::size_t &alignment) {
+            char* place = static_cast<char*>(data);
+            if (place == begin_ && place + bytes == current_ &&
+                static_cast<std::size_t>(end_ - place) >= size) {
+                current_ = place + size;
+                return place;
+            }
+            void* result = allocate(size, alignment);
+            std::memcpy(result, data, bytes < size ? bytes : size);
+            return result;
+        }
+        
+        /********************************************************
+         * Освобождение всех блоков арены разом
+         ********************************************************
+         * Внешний буфер (если был) снова становится доступным
+         */
+        
+        void release() noexcept {
+            while (blocks_) {
+                block* next = blocks_->next;
+                ::operator delete(blocks_);
+                blocks_ = next;
+            }
+            begin_ = current_ = initial_;
+            end_ = initial_ ? initial_ + initial_size_ : nullptr;
+        }
+    
+    private:
+        /********************************************************
+         * \brief Заголовок блока памяти из кучи
+         */
+        
+        struct block {
+            block* next; /*< Предыдущий выделенный блок*/
+        };
+        
+        /********************************************************
+         * Выравнивание указателя вверх
+         ********************************************************
+         * \return Выровненный указатель или nullptr при его отсутствии
+         */
+        
+        static char* align(char* place, const std::size_t &alignment) noexcept {
+            if (!place)
+                return nullptr;
+            const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(place);
+            const std::uintptr_t aligned = (address + alignment - 1) & ~(std::uintptr_t(alignment) - 1);
+            return place + (aligned - address);
+        }
+        
+        /********************************************************
+         * Выделение нового блока, вмещающего bytes байт
+         ********************************************************
+         * Размеры блоков растут в 2 раза, чтобы число блоков
+         * было логарифмическим от общего объема
+         */
+        
+        void next_block(const std::size_t &bytes, const std::size_t &alignment) {
+            const std::size_t header = (sizeof(block) + alignof(std::max_align_t) - 1) &
+                                       ~(alignof(std::max_align_t) - 1);
+            std::size_t size = block_size_;
+            if (size < bytes + alignment)
+                size = bytes + alignment;
+            block* next = static_cast<block*>(::operator new(header + size));
+            next->next = blocks_;
+            blocks_ = next;
+            current_ = begin_ = reinterpret_cast<char*>(next) + header;
+            end_ = current_ + size;
+            block_size_ *= 2;
+        }
+        
+        std::size_t block_size_; /*< Размер следующего блока*/
+        block* blocks_; /*< Список блоков из кучи*/
+        char* begin_; /*< Начало последнего выделенного участка*/
+        char* current_; /*< Первый свободный байт текущего блока*/
+        char* end_; /*< Конец текущего блока*/
+        char* initial_; /*< Внешний буфер, переданный в конструктор*/
+        std::size_t initial_size_; /*< Размер внешнего буфера*/
+    };
+    
+    /********************************************************
+     * \brief Аллокатор, выделяющий память из monotonic_buffer
+     ********************************************************
+     * Контейнеры с этим аллокатором не освобождают память
+     * поэлементно: вся память возвращается вызовом release()
+     * арены. Аллокаторы равны, если используют одну арену,
+     * и не передаются при копировании, перемещении и обмене
+     * контейнеров
+     */
+    
+    template<class T>
+    class arena_allocator {
+    public:
+        typedef T value_type;
+        typedef std::false_type propagate_on_container_copy_assignment;
+        typedef std::false_type propagate_on_container_move_assignment;
+        typedef std::false_type propagate_on_container_swap;
+        typedef std::false_type is_always_equal;
+        
+        /********************************************************
+         * Конструктор аллокатора
+         ********************************************************
+         * \param arena Арена, из которой выделяется память
+         */
+        
+        arena_allocator(monotonic_buffer &arena) noexcept
+        :arena_(&arena) {}
+        
+        template<class U>
+        arena_allocator(const arena_allocator<U> &other) noexcept
+        :arena_(other.arena()) {}
+        
+        /********************************************************
+         * Выделение памяти под count элементов
+         */
+        
+        T* allocate(const std::size_t &count) {
+            if (count > std::size_t(-1) / sizeof(T))
+                throw std::bad_array_new_length();
+            return static_cast<T*>(arena_->allocate(count * sizeof(T), alignof(T)));
+        }
+        
+        /********************************************************
+         * Освобождение памяти (возвращает арене только последний участок)
+         */
+        
+        void deallocate(T* data, const std::size_t &count) noexcept {
+            arena_->deallocate(data, count * sizeof(T));
+        }
+        
+        /********************************************************
+         * Изменение размера буфера с побайтовым переносом содержимого
+         ********************************************************
+         * Последний выделенный буфер растет на месте
+         */
+        
+        T* reallocate(T* data, const std::size_t &count, const std::size_t &size) {
+            if (size > std::size_t(-1) / sizeof(T))
+                throw std::bad_array_new_length();
+            return static_cast<T*>(arena_->reallocate(data, count * sizeof(T), size * sizeof(T), alignof(T)));
+        }
+        
+        /********************************************************
+         * Получение арены аллокатора
+         */
+        
+        monotonic_buffer* arena() const noexcept {
+            return arena_;
+        }
+    
+    private:
+        monotonic_buffer* arena_; /*< Арена, из которой выделяется память*/
+    };
+    
+    /********************************************************
+     * Перегруженный оператор == (сравнение)
+     ********************************************************
+     * \return True - если аллокаторы используют одну арену
+     */
+    
+    template<class T, class U>
+    inline bool
+    operator ==(const arena_allocator<T> &lhs, const arena_allocator<U> &rhs) noexcept {
+        return lhs.arena() == rhs.arena();
+    }
+    
+    /********************************************************
+     * Перегруженный оператор != (не равно)
+     */
+    
+    template<class T, class U>
+    inline bool
+    operator !=(const arena_allocator<T> &lhs, const arena_allocator<U> &rhs) noexcept {
+        return !(lhs == rhs);
+    }
+    
+    /********************************************************
+     * \brief Аллокатор с внутренним буфером на N элементов
+     ********************************************************
+     * Запрос не больше N элементов получает буфер внутри самого
+     * аллокатора (если он свободен), остальные уходят в Base.
+     * Внутренний буфер нельзя передать другому контейнеру,
+     * поэтому аллокатор сообщает о нем через is_local, а при
+     * копировании и перемещении создается новый пустой буфер.
+     * Аллокаторы равны, если равны их Base
+     */
+    
+    template<class T, std::size_t N, class Base = malloc_allocator<T>>
+    class inline_allocator {
+        static_assert(N > 0, "Inline buffer must hold at least one element");
+        
+        typedef std::allocator_traits<Base> base_traits;
+        
+    public:
+        typedef T value_type;
+        typedef std::false_type propagate_on_container_copy_assignment;
+        typedef std::false_type propagate_on_container_move_assignment;
+        typedef std::false_type propagate_on_container_swap;
+        typedef typename base_traits::is_always_equal is_always_equal;
+        
+        template<class U>
+        struct rebind {
+            typedef inline_allocator<U, N, typename base_traits::template rebind_alloc<U>> other;
+        };
+        
+        /********************************************************
+         * Конструктор по умолчанию
+         */
+        
+        inline_allocator() noexcept(noexcept(Base()))
+        :base_(), used_(false) {}
+        
+        /********************************************************
+         * Конструктор с аллокатором для памяти вне буфера
+         */
+        
+        explicit inline_allocator(const Base &base) noexcept
+        :base_(base), used_(false) {}
+        
+        /********************************************************
+         * Конструктор копирования
+         ********************************************************
+         * Копируется только Base, буфер создается пустым
+         */
+        
+        inline_allocator(const inline_allocator &copy) noexcept
+        :base_(copy.base_), used_(false) {}
+        
+        /********************************************************
+         * Конструктор перемещения
+         ********************************************************
+         * Буфер copy остается занятым, новый буфер создается пустым
+         */
+        
+        inline_allocator(inline_allocator &&copy) noexcept
+        :base_(std::move(copy.base_)), used_(false) {}
+        
+        template<class U, class BaseU>
+        inline_allocator(const inline_allocator<U, N, BaseU> &copy) noexcept
+        :base_(copy.base()), used_(false) {}
+        
+        /********************************************************
+         * Перегруженный оператор присваивания
+         ********************************************************
+         * Присваивается только Base, состояние буфера не меняется
+         */
+        
+        inline_allocator& operator =(const inline_allocator &copy) {
+            base_ = copy.base_;
+            return *this;
+        }
+        
+        /********************************************************
+         * Аллокатор для копии контейнера (с новым пустым буфером)
+         */
+        
+        inline_allocator select_on_container_copy_construction() const {
+            return inline_allocator(base_traits::select_on_container_copy_construction(base_));
+        }
+        
+        /********************************************************
+         * Выделение памяти под count элементов
+         */
+        
+        T* allocate(const std::size_t &count) {
+            if (!used_ && count <= N) {
+                used_ = true;
+                return reinterpret_cast<T*>(buffer_);
+            }
+            return base_traits::allocate(base_, count);
+        }
+        
+        /********************************************************
+         * Выделение памяти не меньше чем под count элементов
+         ********************************************************
+         * \return Внутренний буфер на N элементов, если он свободен
+         * и его хватает, иначе память из Base ровно на count элементов
+         */
+        
+        allocation_result<T*> allocate_at_least(const std::size_t &count) {
+            if (!used_ && count <= N) {
+                used_ = true;
+                return allocation_result<T*>{reinterpret_cast<T*>(buffer_), N};
+            }
+            return allocation_result<T*>{base_traits::allocate(base_, count), count};
+        }
+        
+        /********************************************************
+         * Освобождение памяти
+         */
+        
+        void deallocate(T* data, const std::size_t &count) noexcept {
+            if (is_local(data))
+                used_ = false;
+            else
+                base_traits::deallocate(base_, data, count);
+        }
+        
+        /********************************************************
+         * Проверка, указывает ли data на внутренний буфер
+         */
+        
+        bool is_local(const T* data) const noexcept {
+            return data == reinterpret_cast<const T*>(buffer_);
+        }
+        
+        /********************************************************
+         * Получение аллокатора для памяти вне буфера
+         */
+        
+        const Base& base() const noexcept {
+            return base_;
+        }
+        
+    private:
+        alignas(T) unsigned char buffer_[N * sizeof(T)]; /*< Внутренний буфер*/
+        Base base_; /*< Аллокатор для памяти вне буфера*/
+        bool used_; /*< Занят ли внутренний буфер*/
+    };
+    
+    /********************************************************
+     * Перегруженный оператор == (сравнение)
+     ********************************************************
+     * \return True - если память вне буфера взаимозаменяема
+     */
+    
+    template<class T, class U, std::size_t N, class BaseT, class BaseU>
+    inline bool
+    operator ==(const inline_allocator<T, N, BaseT> &lhs, const inline_allocator<U, N, BaseU> &rhs) noexcept {
+        return lhs.base() == rhs.base();
+    }
+    
+    /********************************************************
+     * Перегруженный оператор != (не равно)
+     */
+    
+    template<class T, class U, std::size_t N, class BaseT, class BaseU>
+    inline bool
+    operator !=(const inline_allocator<T, N, BaseT> &lhs, const inline_allocator<U, N, BaseU> &rhs) noexcept {
+        return !(lhs == rhs);
+    }
+}
@@ -0,0 +1,95 @@
+/********************************************************
+ * \file
+ * \brief Счетчик выделенной памяти для бенчмарков
+ ********************************************************
+ * С glibc программа подменяет malloc, calloc, realloc и
+ * free (они вызывают __libc_* версии) и на 64-битном Linux
+ * mmap и mremap (они вызывают системные вызовы напрямую),
+ * чтобы одинаково считать память std::vector (operator new
+ * идет через malloc) и pva::vector (malloc_allocator идет
+ * через malloc/realloc и mmap/mremap)
+ */
+
+#include "harness.h"
+
+#include <atomic>
+#include <cstdarg>
+#include <cstddef>
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+#define PVA_BENCH_COUNT 1
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#define PVA_BENCH_COUNT 0
+#endif
+
+namespace {
+    std::atomic<std::uint64_t> allocated_bytes{0}; /*< Запрошено байт*/
+    std::atomic<std::uint64_t> allocation_count{0}; /*< Число выделений*/
+    
+    inline void count(std::size_t size) noexcept {
+        allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+namespace bench {
+    alloc_stats allocated() noexcept {
+        return alloc_stats{allocated_bytes.load(std::memory_order_relaxed),
+                           allocation_count.load(std::memory_order_relaxed)};
+    }
+    
+    bool counting_allocations() noexcept {
+        return PVA_BENCH_COUNT != 0;
+    }
+}
+
+#if PVA_BENCH_COUNT
+extern "C" {
+    void* __libc_malloc(std::size_t size);
+    void* __libc_calloc(std::size_t count, std::size_t size);
+    void* __libc_realloc(void* data, std::size_t size);
+    void __libc_free(void* data);
+    
+    void* malloc(std::size_t size) {
+        count(size);
+        return __libc_malloc(size);
+    }
+    
+    void* calloc(std::size_t number, std::size_t size) {
+        count(number * size);
+        return __libc_calloc(number, size);
+    }
+    
+    void* realloc(void* data, std::size_t size) {
+        count(size);
+        return __libc_realloc(data, size);
+    }
+    
+    void free(void* data) {
+        __libc_free(data);
+    }
+
+#if defined(__linux__) && defined(__LP64__)
+    void* mmap(void* address, std::size_t length, int protection, int flags, int fd, off_t offset) {
+        if (flags & MAP_ANONYMOUS)
+            count(length);
+        return reinterpret_cast<void*>(::syscall(SYS_mmap, address, length, protection, flags, fd, offset));
+    }
+    
+    void* mremap(void* old_address, std::size_t old_size, std::size_t new_size, int flags, ...) {
+        void* new_address = nullptr;
+        if (flags & MREMAP_FIXED) {
+            va_list arguments;
+            va_start(arguments, flags);
+            new_address = va_arg(arguments, void*);
+            va_end(arguments);
+        }
+        count(new_size);
+        return reinterpret_cast<void*>(::syscall(SYS_mremap, old_address, old_size, new_size, flags, new_address));
+    }
+#endif
+}
+#endif
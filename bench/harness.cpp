@@ -0,0 +1,30 @@
+/********************************************************
+ * \file
+ * \brief Замер и регистрация бенчмарков
+ */
+
+#include "harness.h"
+
+namespace bench {
+    result measure(function body, std::size_t size, double min_time) {
+        std::uint64_t iterations = 1;
+        for (;;) {
+            state current(size, iterations);
+            body(current);
+            const double seconds = current.seconds();
+            if (seconds >= min_time || iterations >= (std::uint64_t(1) << 40)) {
+                return result{seconds * 1e9 / double(iterations),
+                              double(current.bytes()) / double(iterations)};
+            }
+            if (seconds < min_time / 100)
+                iterations *= 10;
+            else
+                iterations = std::uint64_t(double(iterations) * min_time * 1.2 / seconds) + 1;
+        }
+    }
+    
+    std::vector<entry>& registry() {
+        static std::vector<entry> entries;
+        return entries;
+    }
+}
@@ -0,0 +1,198 @@
+/********************************************************
+ * \file
+ * \brief Заголовочный файл с каркасом бенчмарков
+ ********************************************************
+ * Файл содержит в себе замер времени и выделенной памяти
+ * на операцию 'bench::state', регистрацию парных
+ * бенчмарков std::vector / pva::vector и вывод таблицы
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bench {
+    
+    /********************************************************
+     * \brief Счетчик выделенной памяти
+     ********************************************************
+     * Считает байты, запрошенные у malloc/calloc/realloc и
+     * анонимным mmap/mremap во всей программе (см.
+     * alloc_counter.cpp). Доступен только с glibc
+     */
+    
+    struct alloc_stats {
+        std::uint64_t bytes; /*< Запрошено байт*/
+        std::uint64_t count; /*< Число выделений*/
+    };
+    
+    alloc_stats allocated() noexcept;
+    bool counting_allocations() noexcept;
+    
+    /********************************************************
+     * Запрет компилятору выбрасывать вычисление value
+     */
+    
+    template<class T>
+    inline void keep(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &value;
+#endif
+    }
+    
+    /********************************************************
+     * \brief Состояние замера
+     ********************************************************
+     * Тело бенчмарка крутит цикл while (state.keep_running())
+     * и выполняет в нем одну операцию. Время и память между
+     * pause() и resume() (подготовка данных) не учитываются
+     */
+    
+    class state {
+        typedef std::chrono::steady_clock clock;
+    
+    public:
+        state(std::size_t size, std::uint64_t iterations)
+        :size_(size), iterations_(iterations), left_(iterations), started_(false),
+         elapsed_(0), bytes_(0) {}
+        
+        /********************************************************
+         * Нужно ли выполнить еще одну итерацию
+         */
+        
+        bool keep_running() {
+            if (!started_) {
+                started_ = true;
+                resume();
+            }
+            if (left_ != 0) {
+                --left_;
+                return true;
+            }
+            pause();
+            return false;
+        }
+        
+        /********************************************************
+         * Остановка замера (подготовка данных)
+         */
+        
+        void pause() {
+            elapsed_ += clock::now() - start_;
+            bytes_ += allocated().bytes - start_bytes_;
+        }
+        
+        /********************************************************
+         * Продолжение замера
+         */
+        
+        void resume() {
+            start_bytes_ = allocated().bytes;
+            start_ = clock::now();
+        }
+        
+        std::size_t size() const noexcept {
+            return size_;
+        }
+        
+        std::uint64_t iterations() const noexcept {
+            return iterations_;
+        }
+        
+        double seconds() const noexcept {
+            return std::chrono::duration<double>(elapsed_).count();
+        }
+        
+        std::uint64_t bytes() const noexcept {
+            return bytes_;
+        }
+    
+    private:
+        std::size_t size_; /*< Размер данных бенчмарка*/
+        std::uint64_t iterations_; /*< Число итераций*/
+        std::uint64_t left_; /*< Осталось итераций*/
+        bool started_; /*< Цикл начат*/
+        clock::duration elapsed_; /*< Учтенное время*/
+        clock::time_point start_; /*< Начало текущего отрезка замера*/
+        std::uint64_t bytes_; /*< Учтенная выделенная память*/
+        std::uint64_t start_bytes_ = 0; /*< Счетчик памяти в начале отрезка*/
+    };
+    
+    typedef void (*function)(state &);
+    
+    /********************************************************
+     * \brief Результат замера
+     */
+    
+    struct result {
+        double ns; /*< Наносекунд на операцию*/
+        double bytes; /*< Выделено байт на операцию*/
+    };
+    
+    /********************************************************
+     * Замер бенчмарка
+     ********************************************************
+     * Число итераций растет, пока замер не займет
+     * min_time секунд
+     */
+    
+    result measure(function body, std::size_t size, double min_time);
+    
+    /********************************************************
+     * \brief Пара бенчмарков одной операции
+     */
+    
+    struct entry {
+        std::string name; /*< Операция*/
+        std::string type; /*< Тип элементов*/
+        std::size_t footprint; /*< Примерный объем памяти на элемент*/
+        function std_body; /*< Бенчмарк std::vector*/
+        function pva_body; /*< Бенчмарк pva::vector*/
+    };
+    
+    std::vector<entry>& registry();
+    
+    /********************************************************
+     * \brief Регистрация пары бенчмарков при старте программы
+     */
+    
+    struct registrar {
+        registrar(const char* name, const char* type, std::size_t footprint, function std_body, function pva_body) {
+            registry().push_back(entry{name, type, footprint, std_body, pva_body});
+        }
+    };
+    
+    /********************************************************
+     * \brief Параметры запуска
+     */
+    
+    struct options {
+        std::string filter; /*< Подстрока имени бенчмарка*/
+        std::size_t max_size = 1000000; /*< Максимальный размер вектора*/
+        std::size_t max_bytes = std::size_t(1) << 30; /*< Максимальный объем данных бенчмарка*/
+        double min_time = 0.1; /*< Минимальное время замера, секунд*/
+        std::size_t parallel_size = 10000000; /*< Размер вектора параллельных бенчмарков*/
+        std::size_t threads = 0; /*< Максимум потоков (0 - все)*/
+        std::size_t memory_size = std::size_t(1) << 28; /*< Объем буфера бенчмарков памяти, байт*/
+        std::size_t latency_size = 10000000; /*< Число добавлений бенчмарка задержки*/
+        std::size_t lookup_size = 1000000; /*< Максимальный размер контейнеров бенчмарков поиска*/
+        std::size_t packed_size = 10000000; /*< Число элементов бенчмарков упакованных векторов*/
+        std::size_t views_size = 1000000; /*< Число элементов бенчмарков представлений*/
+        bool csv = false; /*< Вывод в CSV*/
+    };
+    
+    void run_vector(const options &config);
+    void run_parallel(const options &config);
+    void run_memory(const options &config);
+    void run_latency(const options &config);
+    void run_lookup(const options &config);
+    void run_packed(const options &config);
+    void run_views(const options &config);
+}
@@ -0,0 +1,93 @@
+/********************************************************
+ * \file
+ * \brief Бенчмарк задержки отдельного push_back
+ ********************************************************
+ * Заполняет вектор по одному элементу, замеряя каждый
+ * push_back, и выводит среднее, 99.9-й перцентиль и
+ * максимум. Рост pva::vector переносит весь буфер за
+ * одно добавление, incremental_vector - по частям
+ */
+
+#include "harness.h"
+
+#include "incremental_vector.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+    
+    typedef std::chrono::steady_clock clock;
+    
+    /********************************************************
+     * \brief Задержки одного заполнения
+     */
+    
+    struct latency {
+        double mean; /*< Среднее, нс*/
+        double p999; /*< 99.9-й перцентиль, нс*/
+        double max; /*< Максимум, нс*/
+    };
+    
+    /********************************************************
+     * Замер count добавлений в пустой вектор
+     ********************************************************
+     * \param samples Буфер под задержки (емкость не меньше count)
+     */
+    
+    template<class Vector>
+    latency fill(Vector &data, std::size_t count, std::vector<std::uint64_t> &samples) {
+        samples.clear();
+        clock::time_point last = clock::now();
+        for (std::size_t i = 0; i < count; ++i) {
+            data.push_back(std::uint64_t(i));
+            const clock::time_point now = clock::now();
+            samples.push_back(std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count()));
+            last = now;
+        }
+        bench::keep(data[count - 1]);
+        double sum = 0;
+        for (std::uint64_t sample : samples)
+            sum += double(sample);
+        std::sort(samples.begin(), samples.end());
+        return latency{sum / double(count), double(samples[count - 1 - count / 1000]), double(samples[count - 1])};
+    }
+    
+    /********************************************************
+     * Замер вектора типа Vector и вывод строки таблицы
+     */
+    
+    template<class Vector>
+    void run(const char* name, const bench::options &config, std::vector<std::uint64_t> &samples) {
+        if ((std::string("latency/") + name).find(config.filter) == std::string::npos)
+            return;
+        Vector data;
+        const latency result = fill(data, config.latency_size, samples);
+        if (config.csv)
+            std::printf("%s,%zu,%.1f,%.0f,%.0f\n", name, config.latency_size, result.mean, result.p999, result.max);
+        else
+            std::printf("%-14s %10zu %12.1f %12.0f %14.0f\n", name, config.latency_size, result.mean, result.p999,
+                        result.max);
+        std::fflush(stdout);
+    }
+}
+
+namespace bench {
+    void run_latency(const options &config) {
+        if (config.latency_size == 0)
+            return;
+        std::vector<std::uint64_t> samples;
+        samples.reserve(config.latency_size);
+        if (config.csv)
+            std::printf("\nvector,size,mean_ns,p999_ns,max_ns\n");
+        else
+            std::printf("\n%-14s %10s %12s %12s %14s\n", "latency", "size", "mean ns", "p99.9 ns", "max ns");
+        run<pva::vector<std::uint64_t>>("vector", config, samples);
+        run<pva::incremental_vector<std::uint64_t>>("incremental", config, samples);
+    }
+}
@@ -0,0 +1,168 @@
+/********************************************************
+ * \file
+ * \brief Бенчмарки упорядоченных контейнеров
+ ********************************************************
+ * Замеряет поиск случайных ключей в std::map,
+ * std::lower_bound по std::vector, sorted_vector,
+ * eytzinger_set и flat_map, а также вставку пакета ключей
+ * в sorted_vector по одному и через insert_range
+ */
+
+#include "harness.h"
+
+#include "flat_map.h"
+#include "sorted_vector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    
+    typedef std::chrono::steady_clock clock;
+    
+    const std::size_t lookups = 1 << 20; /*< Число поисков в замере*/
+    const std::size_t batch_size = 1000; /*< Размер пакета вставки*/
+    
+    /********************************************************
+     * Случайные различные ключи
+     */
+    
+    std::vector<std::uint64_t> make_keys(std::size_t count, std::uint64_t seed) {
+        std::mt19937_64 generator(seed);
+        std::vector<std::uint64_t> keys(count);
+        for (std::uint64_t &key : keys)
+            key = generator() | 1;
+        return keys;
+    }
+    
+    /********************************************************
+     * Среднее время поиска, нс
+     ********************************************************
+     * Половина запросов - ключи контейнера, половина -
+     * отсутствующие (четные) ключи
+     ********************************************************
+     * \param find Поиск: возвращает число найденных ключей
+     */
+    
+    template<class Find>
+    double time_lookups(const std::vector<std::uint64_t> &keys, Find find) {
+        std::mt19937_64 generator(7);
+        std::vector<std::uint64_t> queries(lookups);
+        for (std::uint64_t &query : queries)
+            query = generator() & 1 ? keys[generator() % keys.size()] : generator() & ~std::uint64_t(1);
+        const clock::time_point start = clock::now();
+        std::size_t found = 0;
+        for (std::uint64_t query : queries)
+            found += find(query);
+        const double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+        bench::keep(found);
+        return ns / double(lookups);
+    }
+    
+    void print(const char* name, const bench::options &config, std::size_t size, double ns) {
+        if (config.csv)
+            std::printf("%s,%zu,%.2f\n", name, size, ns);
+        else
+            std::printf("%-22s %12zu %14.2f\n", name, size, ns);
+        std::fflush(stdout);
+    }
+    
+    bool selected(const char* name, const bench::options &config) {
+        return (std::string("lookup/") + name).find(config.filter) != std::string::npos;
+    }
+    
+    /********************************************************
+     * Замеры поиска в контейнерах из size ключей
+     */
+    
+    void run_lookups(const bench::options &config, std::size_t size) {
+        const std::vector<std::uint64_t> keys = make_keys(size, 42);
+        if (selected("std_map", config)) {
+            std::map<std::uint64_t, std::uint64_t> map;
+            for (std::uint64_t key : keys)
+                map.emplace(key, key);
+            print("std_map", config, size, time_lookups(keys, [&](std::uint64_t key) {
+                return std::size_t(map.find(key) != map.end());
+            }));
+        }
+        if (selected("std_lower_bound", config)) {
+            std::vector<std::uint64_t> sorted(keys);
+            std::sort(sorted.begin(), sorted.end());
+            print("std_lower_bound", config, size, time_lookups(keys, [&](std::uint64_t key) {
+                auto it = std::lower_bound(sorted.begin(), sorted.end(), key);
+                return std::size_t(it != sorted.end() && *it == key);
+            }));
+        }
+        const pva::sorted_vector<std::uint64_t> set(keys.begin(), keys.end());
+        if (selected("sorted_vector", config))
+            print("sorted_vector", config, size, time_lookups(keys, [&](std::uint64_t key) {
+                return std::size_t(set.contains(key));
+            }));
+        if (selected("eytzinger_set", config)) {
+            const pva::eytzinger_set<std::uint64_t> tree(set);
+            print("eytzinger_set", config, size, time_lookups(keys, [&](std::uint64_t key) {
+                return std::size_t(tree.contains(key));
+            }));
+        }
+        if (selected("flat_map", config)) {
+            pva::flat_map<std::uint64_t, std::uint64_t> map;
+            std::vector<std::pair<std::uint64_t, std::uint64_t>> pairs;
+            for (std::uint64_t key : keys)
+                pairs.emplace_back(key, key);
+            map.insert_range(pairs.begin(), pairs.end());
+            print("flat_map", config, size, time_lookups(keys, [&](std::uint64_t key) {
+                return std::size_t(map.contains(key));
+            }));
+        }
+    }
+    
+    /********************************************************
+     * Вставка пакета из batch_size ключей в sorted_vector из
+     * size ключей по одному и через insert_range
+     */
+    
+    void run_batches(const bench::options &config, std::size_t size) {
+        const std::vector<std::uint64_t> keys = make_keys(size, 42);
+        const std::vector<std::uint64_t> batch = make_keys(batch_size, 43);
+        if (selected("insert_one", config)) {
+            pva::sorted_vector<std::uint64_t> set(keys.begin(), keys.end());
+            const clock::time_point start = clock::now();
+            for (std::uint64_t key : batch)
+                set.insert(key);
+            print("insert_one", config, size,
+                  std::chrono::duration<double, std::nano>(clock::now() - start).count() / double(batch.size()));
+        }
+        if (selected("insert_range", config)) {
+            pva::sorted_vector<std::uint64_t> set(keys.begin(), keys.end());
+            const clock::time_point start = clock::now();
+            set.insert_range(batch.begin(), batch.end());
+            print("insert_range", config, size,
+                  std::chrono::duration<double, std::nano>(clock::now() - start).count() / double(batch.size()));
+        }
+    }
+}
+
+namespace bench {
+    void run_lookup(const options &config) {
+        if (config.lookup_size == 0)
+            return;
+        if (config.csv)
+            std::printf("\ncontainer,size,ns_per_lookup\n");
+        else
+            std::printf("\n%-22s %12s %14s\n", "lookup", "size", "ns/lookup");
+        for (std::size_t size = 1000; size <= config.lookup_size; size *= 10)
+            run_lookups(config, size);
+        if (config.csv)
+            std::printf("\ninsert,size,ns_per_key\n");
+        else
+            std::printf("\n%-22s %12s %14s\n", "batch insert", "size", "ns/key");
+        for (std::size_t size = 1000; size <= config.lookup_size; size *= 10)
+            run_batches(config, size);
+    }
+}
@@ -0,0 +1,81 @@
+/********************************************************
+ * \file
+ * \brief Точка входа бенчмарков pva
+ ********************************************************
+ * Параметры:
+ * --filter=STR         только бенчмарки, в имени которых есть STR
+ *                      (имена вида push_back/int, parallel/sort)
+ * --max-size=N         максимальный размер вектора (1000000)
+ * --max-bytes=N        максимальный объем данных бенчмарка (2^30)
+ * --min-time=SEC       минимальное время замера (0.1)
+ * --parallel-size=N    размер вектора параллельных бенчмарков (10^7)
+ * --threads=N          максимум потоков параллельных бенчмарков
+ * --memory-size=N      объем буфера бенчмарков памяти в байтах (2^28)
+ * --latency-size=N     число push_back бенчмарка задержки (10^7)
+ * --lookup-size=N      максимальный размер контейнеров бенчмарков
+ *                      поиска (10^6)
+ * --packed-size=N      число элементов бенчмарков упакованных
+ *                      векторов (10^7)
+ * --views-size=N       число элементов бенчмарков представлений (10^6)
+ * --csv                вывод в CSV
+ */
+
+#include "harness.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace {
+    bool option(const char* argument, const char* name, std::string &value) {
+        const std::size_t length = std::strlen(name);
+        if (std::strncmp(argument, name, length) != 0 || argument[length] != '=')
+            return false;
+        value = argument + length + 1;
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    bench::options config;
+    for (int i = 1; i < argc; ++i) {
+        std::string value;
+        if (option(argv[i], "--filter", value))
+            config.filter = value;
+        else if (option(argv[i], "--max-size", value))
+            config.max_size = std::strtoull(value.c_str(), nullptr, 10);
+        else if (option(argv[i], "--max-bytes", value))
+            config.max_bytes = std::strtoull(value.c_str(), nullptr, 10);
+        else if (option(argv[i], "--min-time", value))
+            config.min_time = std::strtod(value.c_str(), nullptr);
+        else if (option(argv[i], "--parallel-size", value))
+            config.parallel_size = std::strtoull(value.c_str(), nullptr, 10);
+        else if (option(argv[i], "--threads", value))
+            config.threads = std::strtoull(value.c_str(), nullptr, 10);
+        else if (option(argv[i], "--memory-size", value))
+            config.memory_size = std::strtoull(value.c_str(), nullptr, 10);
+        else if (option(argv[i], "--latency-size", value))
+            config.latency_size = std::strtoull(value.c_str(), nullptr, 10);
+        else if (option(argv[i], "--lookup-size", value))
+            config.lookup_size = std::strtoull(value.c_str(), nullptr, 10);
+        else if (option(argv[i], "--packed-size", value))
+            config.packed_size = std::strtoull(value.c_str(), nullptr, 10);
+        else if (option(argv[i], "--views-size", value))
+            config.views_size = std::strtoull(value.c_str(), nullptr, 10);
+        else if (std::strcmp(argv[i], "--csv") == 0)
+            config.csv = true;
+        else {
+            std::fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    bench::run_vector(config);
+    bench::run_parallel(config);
+    bench::run_memory(config);
+    bench::run_latency(config);
+    bench::run_lookup(config);
+    bench::run_packed(config);
+    bench::run_views(config);
+    return 0;
+}
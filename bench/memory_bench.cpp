@@ -0,0 +1,184 @@
+/********************************************************
+ * \file
+ * \brief Бенчмарки размещения буфера в памяти
+ ********************************************************
+ * Обходит большой вектор в случайном порядке (каждый
+ * элемент хранит индекс следующего) и сравнивает буферы
+ * std::vector, pva::vector, aligned_allocator и
+ * aligned_allocator на больших страницах. На Linux, если
+ * доступен perf_event_open, выводит и промахи dTLB на
+ * одно обращение
+ */
+
+#include "harness.h"
+
+#include "vector.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    
+    /********************************************************
+     * \brief Счетчик промахов dTLB при чтении
+     ********************************************************
+     * Считает только пользовательский код этого потока.
+     * Если счетчик недоступен (нет прав, виртуальная машина),
+     * available() возвращает false
+     */
+    
+    class tlb_counter {
+    public:
+        tlb_counter() noexcept
+        :fd_(-1) {
+#if defined(__linux__)
+            perf_event_attr attributes;
+            std::memset(&attributes, 0, sizeof(attributes));
+            attributes.type = PERF_TYPE_HW_CACHE;
+            attributes.size = sizeof(attributes);
+            attributes.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            attributes.disabled = 1;
+            attributes.exclude_kernel = 1;
+            attributes.exclude_hv = 1;
+            fd_ = int(::syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+#endif
+        }
+        
+        ~tlb_counter() {
+#if defined(__linux__)
+            if (fd_ >= 0)
+                ::close(fd_);
+#endif
+        }
+        
+        tlb_counter(const tlb_counter &copy) = delete;
+        tlb_counter& operator =(const tlb_counter &copy) = delete;
+        
+        bool available() const noexcept {
+            return fd_ >= 0;
+        }
+        
+        void start() noexcept {
+#if defined(__linux__)
+            if (fd_ >= 0) {
+                ::ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+                ::ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+        }
+        
+        /********************************************************
+         * Остановка счета
+         ********************************************************
+         * \return Число промахов с последнего start()
+         */
+        
+        std::uint64_t stop() noexcept {
+            std::uint64_t value = 0;
+#if defined(__linux__)
+            if (fd_ >= 0) {
+                ::ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+                if (::read(fd_, &value, sizeof(value)) != ssize_t(sizeof(value)))
+                    value = 0;
+            }
+#endif
+            return value;
+        }
+    
+    private:
+        int fd_; /*< Дескриптор perf_event (-1 - недоступен)*/
+    };
+    
+    const std::uint64_t* chain = nullptr; /*< Элементы текущего замера*/
+    std::uint64_t accesses = 0; /*< Обращений за все замеры текущего буфера*/
+    
+    /********************************************************
+     * state.size() переходов по цепочке индексов
+     */
+    
+    void walk(bench::state &state) {
+        std::uint64_t index = 0;
+        while (state.keep_running()) {
+            for (std::size_t i = 0; i < state.size(); ++i)
+                index = chain[index];
+            accesses += state.size();
+        }
+        bench::keep(index);
+    }
+    
+    /********************************************************
+     * Заполнение вектора случайным циклом (алгоритм Саттоло):
+     * обход из любого элемента проходит все элементы
+     */
+    
+    template<class Vector>
+    void make_chain(Vector &data, std::size_t count) {
+        data.resize(count);
+        for (std::size_t i = 0; i < count; ++i)
+            data[i] = i;
+        std::mt19937_64 generator(42);
+        for (std::size_t i = count - 1; i > 0; --i)
+            std::swap(data[i], data[generator() % i]);
+    }
+    
+    /********************************************************
+     * Замер обхода вектора типа Vector и вывод строки таблицы
+     */
+    
+    template<class Vector>
+    void run(const char* name, const bench::options &config, tlb_counter &counter) {
+        if ((std::string("memory/") + name).find(config.filter) == std::string::npos)
+            return;
+        const std::size_t count = config.memory_size / sizeof(std::uint64_t);
+        if (count < 2)
+            return;
+        Vector data;
+        make_chain(data, count);
+        chain = data.data();
+        accesses = 0;
+        counter.start();
+        const bench::result measured = bench::measure(&walk, std::size_t(1) << 20, config.min_time);
+        const std::uint64_t misses = counter.stop();
+        const double per_access = measured.ns / double(std::size_t(1) << 20);
+        if (config.csv) {
+            if (counter.available())
+                std::printf("%s,%zu,%.2f,%.3f\n", name, config.memory_size, per_access,
+                            double(misses) / double(accesses));
+            else
+                std::printf("%s,%zu,%.2f,\n", name, config.memory_size, per_access);
+        }
+        else if (counter.available())
+            std::printf("%-14s %12zu %14.2f %14.3f\n", name, config.memory_size, per_access,
+                        double(misses) / double(accesses));
+        else
+            std::printf("%-14s %12zu %14.2f %14s\n", name, config.memory_size, per_access, "-");
+        std::fflush(stdout);
+        chain = nullptr;
+    }
+}
+
+namespace bench {
+    void run_memory(const options &config) {
+        tlb_counter counter;
+        if (config.csv)
+            std::printf("\nbuffer,bytes,ns_per_access,dtlb_misses_per_access\n");
+        else
+            std::printf("\n%-14s %12s %14s %14s\n", "memory", "bytes", "ns/access", "dTLB miss/acc");
+        run<std::vector<std::uint64_t>>("std", config, counter);
+        run<pva::vector<std::uint64_t>>("pva", config, counter);
+        run<pva::aligned_vector<std::uint64_t, 64>>("aligned64", config, counter);
+        run<pva::aligned_vector<std::uint64_t, 64, (std::size_t(2) << 20)>>("hugepage", config, counter);
+    }
+}
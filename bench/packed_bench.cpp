@@ -0,0 +1,168 @@
+/********************************************************
+ * \file
+ * \brief Бенчмарки упакованных векторов
+ ********************************************************
+ * Для счетчиков до 2^20 (packed_vector) и упорядоченных
+ * 64-битных идентификаторов (block_packed_vector) выводит
+ * байт на элемент, время случайного доступа и
+ * распаковки всего вектора в pva::vector на элемент
+ * (для packed_vector - векторным и скалярным ядром)
+ */
+
+#include "harness.h"
+
+#include "packed_vector.h"
+#include "vector.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+
+namespace {
+    
+    typedef std::chrono::steady_clock clock;
+    
+    const std::size_t lookups = 1 << 20; /*< Число случайных обращений в замере*/
+    
+    double elapsed_ns(clock::time_point start) {
+        return std::chrono::duration<double, std::nano>(clock::now() - start).count();
+    }
+    
+    /********************************************************
+     * Среднее время случайного обращения к data, нс
+     */
+    
+    template<class Vector>
+    double time_access(const Vector &data) {
+        std::mt19937_64 generator(7);
+        pva::vector<std::size_t> indices;
+        indices.reserve(lookups);
+        for (std::size_t i = 0; i < lookups; ++i)
+            indices.push_back(std::size_t(generator() % data.size()));
+        const clock::time_point start = clock::now();
+        std::uint64_t sum = 0;
+        for (std::size_t index : indices)
+            sum += data[index];
+        const double ns = elapsed_ns(start);
+        bench::keep(sum);
+        return ns / double(lookups);
+    }
+    
+    /********************************************************
+     * Время распаковки на элемент, нс (лучшее из трех)
+     */
+    
+    template<class Decode>
+    double time_decode(std::size_t count, Decode decode) {
+        double best = 0;
+        for (int i = 0; i < 3; ++i) {
+            const clock::time_point start = clock::now();
+            decode();
+            const double ns = elapsed_ns(start) / double(count);
+            best = i == 0 || ns < best ? ns : best;
+        }
+        return best;
+    }
+    
+    void print(const char* name, const bench::options &config, double bytes, double access, double decode) {
+        if (config.csv)
+            std::printf("%s,%zu,%.2f,%.2f,%.3f\n", name, config.packed_size, bytes, access, decode);
+        else
+            std::printf("%-18s %12zu %12.2f %12.2f %12.3f\n", name, config.packed_size, bytes, access, decode);
+        std::fflush(stdout);
+    }
+    
+    bool selected(const char* name, const bench::options &config) {
+        return (std::string("packed/") + name).find(config.filter) != std::string::npos;
+    }
+    
+    /********************************************************
+     * Счетчики до 2^20: pva::vector против packed_vector
+     */
+    
+    void run_counters(const bench::options &config) {
+        const std::size_t count = config.packed_size;
+        std::mt19937_64 generator(42);
+        pva::vector<std::uint64_t> plain;
+        plain.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+            plain.push_back(generator() % (std::uint64_t(1) << 20));
+        pva::vector<std::uint64_t> out;
+        out.reserve(count);
+        if (selected("counters_plain", config))
+            print("counters_plain", config, double(sizeof(std::uint64_t)), time_access(plain),
+                  time_decode(count, [&] {
+                      out.assign(plain.begin(), plain.end());
+                      bench::keep(out.data());
+                  }));
+        const pva::packed_vector<> packed(plain.begin(), plain.end());
+        if (selected("counters_packed", config))
+            print("counters_packed", config, double(packed.bytes()) / double(count), time_access(packed),
+                  time_decode(count, [&] {
+                      packed.decode(out);
+                      bench::keep(out.data());
+                  }));
+        if (selected("counters_scalar", config)) {
+            pva::vector<std::uint64_t> words;
+            const unsigned width = packed.width();
+            for (std::size_t i = 0; i < count * width / 64 + 2; ++i)
+                words.push_back(0);
+            for (std::size_t i = 0; i < count; ++i)
+                pva::detail::write_bits(words.data(), i * width, width, plain[i]);
+            out.resize(count);
+            print("counters_scalar", config, double(packed.bytes()) / double(count), time_access(packed),
+                  time_decode(count, [&] {
+                      pva::detail::unpack_bits_scalar(words.data(), 0, width, count, out.data());
+                      bench::keep(out.data());
+                  }));
+        }
+    }
+    
+    /********************************************************
+     * Упорядоченные идентификаторы: pva::vector против
+     * block_packed_vector
+     */
+    
+    void run_ids(const bench::options &config) {
+        const std::size_t count = config.packed_size;
+        std::mt19937_64 generator(42);
+        pva::vector<std::uint64_t> plain;
+        plain.reserve(count);
+        std::uint64_t id = std::uint64_t(1) << 40;
+        for (std::size_t i = 0; i < count; ++i) {
+            id += 1 + generator() % 64;
+            plain.push_back(id);
+        }
+        pva::vector<std::uint64_t> out;
+        out.reserve(count);
+        if (selected("ids_plain", config))
+            print("ids_plain", config, double(sizeof(std::uint64_t)), time_access(plain), time_decode(count, [&] {
+                out.assign(plain.begin(), plain.end());
+                bench::keep(out.data());
+            }));
+        if (selected("ids_block", config)) {
+            pva::block_packed_vector<> packed(plain.begin(), plain.end());
+            packed.shrink_to_fit();
+            print("ids_block", config, double(packed.bytes()) / double(count), time_access(packed),
+                  time_decode(count, [&] {
+                      packed.decode(out);
+                      bench::keep(out.data());
+                  }));
+        }
+    }
+}
+
+namespace bench {
+    void run_packed(const options &config) {
+        if (config.packed_size == 0)
+            return;
+        if (config.csv)
+            std::printf("\ncontainer,size,bytes_per_element,ns_per_access,ns_per_decoded\n");
+        else
+            std::printf("\n%-18s %12s %12s %12s %12s\n", "packed", "size", "B/elem", "ns/access", "ns/decoded");
+        run_counters(config);
+        run_ids(config);
+    }
+}
@@ -0,0 +1,114 @@
+/********************************************************
+ * \file
+ * \brief Бенчмарки параллельных алгоритмов
+ ********************************************************
+ * Замеряет pva::parallel::for_each, reduce, sort, fill и
+ * создание вектора с политикой parallel::par (construct -
+ * из копий значения, copy - копированием) на пулах из
+ * 1, 2, 4, ... потоков и выводит ускорение относительно
+ * одного потока
+ */
+
+#include "harness.h"
+
+#include "parallel.h"
+
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+
+namespace {
+    std::unique_ptr<pva::parallel::thread_pool> pool; /*< Пул текущего замера*/
+    pva::vector<double> data; /*< Данные текущего замера*/
+    pva::vector<double> shuffled; /*< Исходные данные сортировки*/
+    
+    void for_each(bench::state &state) {
+        while (state.keep_running())
+            pva::parallel::for_each(*pool, data, [](double &value) { value = std::sqrt(value * value + 1.0); });
+    }
+    
+    void reduce(bench::state &state) {
+        while (state.keep_running())
+            bench::keep(pva::parallel::reduce(*pool, data, 0.0, std::plus<>()));
+    }
+    
+    void sort(bench::state &state) {
+        while (state.keep_running()) {
+            state.pause();
+            data = shuffled;
+            state.resume();
+            pva::parallel::sort(*pool, data);
+        }
+    }
+    
+    void fill(bench::state &state) {
+        while (state.keep_running())
+            pva::parallel::fill(*pool, data, 1.5);
+    }
+    
+    void construct(bench::state &state) {
+        while (state.keep_running()) {
+            const pva::vector<double> created(data.size(), 1.5, pva::parallel::par.on(*pool));
+            bench::keep(created.data());
+        }
+    }
+    
+    void copy(bench::state &state) {
+        while (state.keep_running()) {
+            const pva::vector<double> created(data, pva::parallel::par.on(*pool));
+            bench::keep(created.data());
+        }
+    }
+    
+    struct algorithm {
+        const char* name; /*< Название*/
+        bench::function body; /*< Бенчмарк*/
+    };
+}
+
+namespace bench {
+    void run_parallel(const options &config) {
+        static const algorithm algorithms[] = {
+            {"for_each", &::for_each}, {"reduce", &::reduce}, {"sort", &::sort}, {"fill", &::fill},
+            {"construct", &::construct}, {"copy", &::copy}};
+        const std::size_t size = config.parallel_size;
+        std::size_t hardware = pva::parallel::thread_pool::default_threads();
+        if (config.threads != 0)
+            hardware = config.threads;
+        shuffled.resize(size);
+        std::mt19937_64 generator(42);
+        for (std::size_t i = 0; i < size; ++i)
+            shuffled[i] = double(generator() % 1000000);
+        if (config.csv)
+            std::printf("\nalgorithm,size,threads,ns_per_op,speedup\n");
+        else
+            std::printf("\n%-14s %10s %8s %14s %8s\n", "parallel", "size", "threads", "ns/op", "speedup");
+        for (const algorithm &current : algorithms) {
+            const std::string name = std::string("parallel/") + current.name;
+            if (name.find(config.filter) == std::string::npos)
+                continue;
+            double single = 0;
+            for (std::size_t threads = 1;; threads = threads * 2 < hardware ? threads * 2 : hardware) {
+                pool.reset(new pva::parallel::thread_pool(threads));
+                data = shuffled;
+                const result measured = measure(current.body, size, config.min_time);
+                if (threads == 1)
+                    single = measured.ns;
+                if (config.csv)
+                    std::printf("%s,%zu,%zu,%.0f,%.2f\n", current.name, size, threads, measured.ns, single / measured.ns);
+                else
+                    std::printf("%-14s %10zu %8zu %14.0f %8.2f\n", current.name, size, threads, measured.ns,
+                                single / measured.ns);
+                std::fflush(stdout);
+                if (threads == hardware)
+                    break;
+            }
+        }
+        pool.reset();
+        data = pva::vector<double>();
+        shuffled = pva::vector<double>();
+    }
+}
@@ -0,0 +1,372 @@
+/********************************************************
+ * \file
+ * \brief Бенчмарки pva::vector против std::vector
+ ********************************************************
+ * Каждая операция замеряется для int, double, std::string
+ * (32 символа, вне SSO-буфера) и 64-байтной POD-структуры.
+ * Подсчет и побитовое И флагов замеряются для vector<bool>
+ */
+
+#include "harness.h"
+
+#include "vector.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+    
+    /********************************************************
+     * \brief 64-байтная POD-структура
+     */
+    
+    struct pod64 {
+        std::uint64_t values[8]; /*< Данные*/
+    };
+    
+    inline bool operator ==(const pod64 &lhs, const pod64 &rhs) {
+        return std::equal(lhs.values, lhs.values + 8, rhs.values);
+    }
+    
+    inline bool operator !=(const pod64 &lhs, const pod64 &rhs) {
+        return !(lhs == rhs);
+    }
+    
+    inline bool operator <(const pod64 &lhs, const pod64 &rhs) {
+        return std::lexicographical_compare(lhs.values, lhs.values + 8, rhs.values, rhs.values + 8);
+    }
+    
+    typedef std::string string;
+    
+    /********************************************************
+     * Значение элемента с номером index
+     */
+    
+    template<class T>
+    T make_value(std::size_t index) {
+        if constexpr (std::is_same<T, string>::value)
+            return string(32, char('a' + index % 26));
+        else if constexpr (std::is_same<T, pod64>::value)
+            return pod64{{index, index + 1, index + 2, index + 3, index + 4, index + 5, index + 6, index + 7}};
+        else
+            return T(index);
+    }
+    
+    /********************************************************
+     * Число, зависящее от элемента (для обхода без
+     * выбрасывания компилятором)
+     */
+    
+    inline std::size_t weight(int value) {
+        return std::size_t(value);
+    }
+    
+    inline std::size_t weight(double value) {
+        return std::size_t(value);
+    }
+    
+    inline std::size_t weight(const string &value) {
+        return value.size();
+    }
+    
+    inline std::size_t weight(const pod64 &value) {
+        return std::size_t(value.values[0]);
+    }
+    
+    /********************************************************
+     * Вектор из count элементов
+     */
+    
+    template<class Vector>
+    Vector make_vector(std::size_t count) {
+        typedef typename Vector::value_type T;
+        Vector result;
+        result.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+            result.push_back(make_value<T>(i));
+        return result;
+    }
+    
+    /********************************************************
+     * push_back в пустой вектор (с ростом емкости)
+     */
+    
+    template<class Vector>
+    void push_back(bench::state &state) {
+        typedef typename Vector::value_type T;
+        const T value = make_value<T>(1);
+        while (state.keep_running()) {
+            Vector v;
+            for (std::size_t i = 0; i < state.size(); ++i)
+                v.push_back(value);
+            bench::keep(v.data());
+        }
+    }
+    
+    /********************************************************
+     * reserve и push_back без роста емкости
+     */
+    
+    template<class Vector>
+    void reserve_fill(bench::state &state) {
+        typedef typename Vector::value_type T;
+        const T value = make_value<T>(1);
+        while (state.keep_running()) {
+            Vector v;
+            v.reserve(state.size());
+            for (std::size_t i = 0; i < state.size(); ++i)
+                v.push_back(value);
+            bench::keep(v.data());
+        }
+    }
+    
+    /********************************************************
+     * Конструктор копирования
+     */
+    
+    template<class Vector>
+    void copy(bench::state &state) {
+        const Vector source = make_vector<Vector>(state.size());
+        while (state.keep_running()) {
+            Vector v(source);
+            bench::keep(v.data());
+        }
+    }
+    
+    /********************************************************
+     * Перемещение туда и обратно (конструктор и присваивание)
+     */
+    
+    template<class Vector>
+    void move(bench::state &state) {
+        Vector a = make_vector<Vector>(state.size());
+        while (state.keep_running()) {
+            Vector b(std::move(a));
+            a = std::move(b);
+            bench::keep(a.data());
+        }
+    }
+    
+    /********************************************************
+     * swap двух векторов
+     */
+    
+    template<class Vector>
+    void swap(bench::state &state) {
+        Vector a = make_vector<Vector>(state.size());
+        Vector b = make_vector<Vector>(state.size() / 2);
+        while (state.keep_running()) {
+            a.swap(b);
+            bench::keep(a.data());
+        }
+    }
+    
+    /********************************************************
+     * Обход итераторами (range-for)
+     */
+    
+    template<class Vector>
+    void iterate(bench::state &state) {
+        const Vector v = make_vector<Vector>(state.size());
+        while (state.keep_running()) {
+            std::size_t sum = 0;
+            for (const auto &value : v)
+                sum += weight(value);
+            bench::keep(sum);
+        }
+    }
+    
+    /********************************************************
+     * Обход через operator []
+     */
+    
+    template<class Vector>
+    void index(bench::state &state) {
+        const Vector v = make_vector<Vector>(state.size());
+        while (state.keep_running()) {
+            std::size_t sum = 0;
+            for (std::size_t i = 0; i < v.size(); ++i)
+                sum += weight(v[i]);
+            bench::keep(sum);
+        }
+    }
+    
+    /********************************************************
+     * operator == равных векторов (худший случай)
+     */
+    
+    template<class Vector>
+    void equal(bench::state &state) {
+        const Vector a = make_vector<Vector>(state.size());
+        const Vector b = make_vector<Vector>(state.size());
+        while (state.keep_running()) {
+            const bool result = a == b;
+            bench::keep(result);
+        }
+    }
+    
+    /********************************************************
+     * operator < равных векторов (худший случай)
+     */
+    
+    template<class Vector>
+    void less(bench::state &state) {
+        const Vector a = make_vector<Vector>(state.size());
+        const Vector b = make_vector<Vector>(state.size());
+        while (state.keep_running()) {
+            const bool result = a < b;
+            bench::keep(result);
+        }
+    }
+    
+    /********************************************************
+     * shrink_to_fit вектора, заполненного наполовину
+     */
+    
+    template<class Vector>
+    void shrink_to_fit(bench::state &state) {
+        typedef typename Vector::value_type T;
+        const T value = make_value<T>(1);
+        Vector v;
+        while (state.keep_running()) {
+            state.pause();
+            v = Vector();
+            v.reserve(state.size() * 2);
+            for (std::size_t i = 0; i < state.size(); ++i)
+                v.push_back(value);
+            state.resume();
+            v.shrink_to_fit();
+            bench::keep(v.data());
+        }
+    }
+    
+    /********************************************************
+     * Число установленных флагов
+     */
+    
+    inline std::size_t count_true(const std::vector<bool> &v) {
+        return std::size_t(std::count(v.begin(), v.end(), true));
+    }
+    
+    inline std::size_t count_true(const pva::vector<bool> &v) {
+        return v.count();
+    }
+    
+    /********************************************************
+     * Побитовое И флагов lhs и rhs в lhs
+     */
+    
+    inline void and_flags(std::vector<bool> &lhs, const std::vector<bool> &rhs) {
+        for (std::size_t i = 0; i < lhs.size(); ++i)
+            lhs[i] = lhs[i] && rhs[i];
+    }
+    
+    inline void and_flags(pva::vector<bool> &lhs, const pva::vector<bool> &rhs) {
+        lhs &= rhs;
+    }
+    
+    /********************************************************
+     * Вектор флагов, в котором установлен каждый step-й
+     */
+    
+    template<class Vector>
+    Vector make_flags(std::size_t count, std::size_t step) {
+        Vector result;
+        for (std::size_t i = 0; i < count; ++i)
+            result.push_back(i % step == 0);
+        return result;
+    }
+    
+    /********************************************************
+     * Подсчет установленных флагов
+     */
+    
+    template<class Vector>
+    void count_bits(bench::state &state) {
+        const Vector v = make_flags<Vector>(state.size(), 3);
+        while (state.keep_running())
+            bench::keep(count_true(v));
+    }
+    
+    /********************************************************
+     * Побитовое И двух векторов флагов
+     */
+    
+    template<class Vector>
+    void and_bits(bench::state &state) {
+        Vector lhs = make_flags<Vector>(state.size(), 2);
+        const Vector rhs = make_flags<Vector>(state.size(), 3);
+        while (state.keep_running()) {
+            and_flags(lhs, rhs);
+            bench::keep(lhs.size());
+        }
+    }
+    
+    /********************************************************
+     * Регистрация операции для всех типов элементов
+     */
+
+#define PVA_BENCH_TYPE(name, T, footprint) \
+    bench::registrar name##_##T(#name, #T, footprint, &name<std::vector<T>>, &name<pva::vector<T>>);
+
+#define PVA_BENCH(name) \
+    PVA_BENCH_TYPE(name, int, sizeof(int)) \
+    PVA_BENCH_TYPE(name, double, sizeof(double)) \
+    PVA_BENCH_TYPE(name, string, sizeof(string) + 33) \
+    PVA_BENCH_TYPE(name, pod64, sizeof(pod64))
+    
+    PVA_BENCH(push_back)
+    PVA_BENCH(reserve_fill)
+    PVA_BENCH(copy)
+    PVA_BENCH(move)
+    PVA_BENCH(swap)
+    PVA_BENCH(iterate)
+    PVA_BENCH(index)
+    PVA_BENCH(equal)
+    PVA_BENCH(less)
+    PVA_BENCH(shrink_to_fit)
+    PVA_BENCH_TYPE(count_bits, bool, 1)
+    PVA_BENCH_TYPE(and_bits, bool, 1)
+
+#undef PVA_BENCH
+#undef PVA_BENCH_TYPE
+}
+
+namespace bench {
+    void run_vector(const options &config) {
+        static const std::size_t sizes[] = {8, 64, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+        const bool bytes = counting_allocations();
+        if (config.csv)
+            std::printf("benchmark,type,size,std_ns_per_op,pva_ns_per_op,std_bytes_per_op,pva_bytes_per_op\n");
+        else
+            std::printf("%-14s %-7s %10s %14s %14s %8s %14s %14s\n", "benchmark", "type", "size",
+                        "std ns/op", "pva ns/op", "pva/std", "std B/op", "pva B/op");
+        for (const entry &current : registry()) {
+            const std::string name = current.name + "/" + current.type;
+            if (name.find(config.filter) == std::string::npos)
+                continue;
+            for (std::size_t size : sizes) {
+                if (size > config.max_size || size * current.footprint > config.max_bytes)
+                    continue;
+                const result std_result = measure(current.std_body, size, config.min_time);
+                const result pva_result = measure(current.pva_body, size, config.min_time);
+                if (config.csv)
+                    std::printf("%s,%s,%zu,%.2f,%.2f,%.0f,%.0f\n", current.name.c_str(), current.type.c_str(), size,
+                                std_result.ns, pva_result.ns, std_result.bytes, pva_result.bytes);
+                else if (bytes)
+                    std::printf("%-14s %-7s %10zu %14.1f %14.1f %8.2f %14.0f %14.0f\n", current.name.c_str(),
+                                current.type.c_str(), size, std_result.ns, pva_result.ns,
+                                pva_result.ns / std_result.ns, std_result.bytes, pva_result.bytes);
+                else
+                    std::printf("%-14s %-7s %10zu %14.1f %14.1f %8.2f %14s %14s\n", current.name.c_str(),
+                                current.type.c_str(), size, std_result.ns, pva_result.ns,
+                                pva_result.ns / std_result.ns, "-", "-");
+                std::fflush(stdout);
+            }
+        }
+    }
+}
@@ -0,0 +1,176 @@
+/********************************************************
+ * \file
+ * \brief Бенчмарки ленивых представлений
+ ********************************************************
+ * Сравнивает цепочки преобразований, которые строят
+ * новый pva::vector на каждом шаге (eager), с тем же
+ * конвейером views, собранным через to_vector() за один
+ * проход (lazy). Выводит время и выделенные байты на
+ * элемент входа
+ */
+
+#include "harness.h"
+
+#include "vector.h"
+#include "views.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace {
+    
+    const pva::vector<std::uint64_t>* input = nullptr; /*< Вход текущего замера*/
+    
+    bool odd_third(std::uint64_t value) {
+        return value % 3 != 0;
+    }
+    
+    std::uint64_t scale(std::uint64_t value) {
+        return value * 3 + 1;
+    }
+    
+    /********************************************************
+     * Копия, фильтр и преобразование: три вектора
+     */
+    
+    void filter_map_eager(bench::state &state) {
+        while (state.keep_running()) {
+            const pva::vector<std::uint64_t> copy(*input);
+            pva::vector<std::uint64_t> filtered;
+            for (std::uint64_t value : copy)
+                if (odd_third(value))
+                    filtered.push_back(value);
+            pva::vector<std::uint64_t> mapped;
+            mapped.reserve(filtered.size());
+            for (std::uint64_t value : filtered)
+                mapped.push_back(scale(value));
+            bench::keep(mapped.data());
+        }
+    }
+    
+    void filter_map_lazy(bench::state &state) {
+        while (state.keep_running()) {
+            const pva::vector<std::uint64_t> mapped = (*input | pva::views::filter(odd_third) |
+                                                       pva::views::transform(scale)).to_vector();
+            bench::keep(mapped.data());
+        }
+    }
+    
+    /********************************************************
+     * Преобразование, каждый 4-й элемент и первая половина:
+     * длина известна заранее
+     */
+    
+    void map_stride_eager(bench::state &state) {
+        while (state.keep_running()) {
+            pva::vector<std::uint64_t> mapped;
+            mapped.reserve(input->size());
+            for (std::uint64_t value : *input)
+                mapped.push_back(scale(value));
+            pva::vector<std::uint64_t> strided;
+            strided.reserve(mapped.size() / 4 + 1);
+            for (std::size_t i = 0; i < mapped.size(); i += 4)
+                strided.push_back(mapped[i]);
+            const pva::vector<std::uint64_t> taken(strided.begin(), strided.begin() + strided.size() / 2);
+            bench::keep(taken.data());
+        }
+    }
+    
+    void map_stride_lazy(bench::state &state) {
+        while (state.keep_running()) {
+            const pva::vector<std::uint64_t> taken = (*input | pva::views::transform(scale) | pva::views::stride(4) |
+                                                      pva::views::take((input->size() + 3) / 4 / 2)).to_vector();
+            bench::keep(taken.data());
+        }
+    }
+    
+    /********************************************************
+     * Попарные суммы двух половин входа
+     */
+    
+    void zip_sum_eager(bench::state &state) {
+        while (state.keep_running()) {
+            const std::size_t half = input->size() / 2;
+            const pva::vector<std::uint64_t> first(input->begin(), input->begin() + half);
+            const pva::vector<std::uint64_t> second(input->begin() + half, input->begin() + 2 * half);
+            pva::vector<std::uint64_t> sums;
+            sums.reserve(half);
+            for (std::size_t i = 0; i < half; ++i)
+                sums.push_back(first[i] + second[i]);
+            bench::keep(sums.data());
+        }
+    }
+    
+    void zip_sum_lazy(bench::state &state) {
+        typedef pva::vector<std::uint64_t>::const_iterator iterator;
+        while (state.keep_running()) {
+            const std::size_t half = input->size() / 2;
+            const pva::views::subrange<iterator> second(input->begin() + half, input->begin() + 2 * half);
+            const pva::vector<std::uint64_t> sums = (pva::views::zip(*input | pva::views::take(half), second) |
+                                                     pva::views::transform([](auto pair) {
+                                                         return pair.first + pair.second;
+                                                     })).to_vector();
+            bench::keep(sums.data());
+        }
+    }
+    
+    /********************************************************
+     * zip собирается в пары значений: вектор не должен
+     * ссылаться на элементы входов
+     */
+    
+    typedef pva::views::subrange<pva::vector<std::uint64_t>::const_iterator> input_range;
+    static_assert(std::is_same<decltype(pva::views::zip(std::declval<const pva::vector<std::uint64_t>&>(),
+                                                        std::declval<input_range>()).to_vector()),
+                               pva::vector<std::pair<std::uint64_t, std::uint64_t>>>::value,
+                  "zip must collect pairs of values");
+    
+    struct pipeline {
+        const char* name; /*< Конвейер*/
+        bench::function eager; /*< Цепочка векторов*/
+        bench::function lazy; /*< Конвейер views*/
+    };
+}
+
+namespace bench {
+    void run_views(const options &config) {
+        if (config.views_size == 0)
+            return;
+        pva::vector<std::uint64_t> data;
+        data.reserve(config.views_size);
+        std::mt19937_64 generator(42);
+        for (std::size_t i = 0; i < config.views_size; ++i)
+            data.push_back(generator() % 1000000);
+        input = &data;
+        if (config.csv)
+            std::printf("\npipeline,size,eager_ns_per_element,lazy_ns_per_element,eager_bytes_per_element,"
+                        "lazy_bytes_per_element\n");
+        else
+            std::printf("\n%-12s %10s %12s %12s %12s %12s\n", "views", "size", "eager ns/el", "lazy ns/el",
+                        "eager B/el", "lazy B/el");
+        const pipeline pipelines[] = {
+            {"filter_map", &filter_map_eager, &filter_map_lazy},
+            {"map_stride", &map_stride_eager, &map_stride_lazy},
+            {"zip_sum", &zip_sum_eager, &zip_sum_lazy},
+        };
+        const double count = double(config.views_size);
+        for (const pipeline &current : pipelines) {
+            if ((std::string("views/") + current.name).find(config.filter) == std::string::npos)
+                continue;
+            const result eager = measure(current.eager, config.views_size, config.min_time);
+            const result lazy = measure(current.lazy, config.views_size, config.min_time);
+            if (config.csv)
+                std::printf("%s,%zu,%.3f,%.3f,%.2f,%.2f\n", current.name, config.views_size, eager.ns / count,
+                            lazy.ns / count, eager.bytes / count, lazy.bytes / count);
+            else
+                std::printf("%-12s %10zu %12.3f %12.3f %12.2f %12.2f\n", current.name, config.views_size,
+                            eager.ns / count, lazy.ns / count, eager.bytes / count, lazy.bytes / count);
+            std::fflush(stdout);
+        }
+        input = nullptr;
+    }
+}
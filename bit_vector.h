@@ -0,0 +1,1322 @@
+/********************************************************
+ * \file
+ * \brief Заголовочный файл со специализацией
+ * 'vector<bool>'
+ ********************************************************
+ * Файл содержит в себе упакованный вектор флагов
+ * 'vector<bool>' (64 флага в слове), его прокси-ссылку
+ * 'bit_reference', итератор 'bit_iterator' и ядра
+ * подсчета бит и побитовых операций над словами (на x86
+ * через POPCNT/SSE2/AVX2 с выбором реализации по
+ * процессору во время выполнения). Подключается из
+ * vector.h
+ */
+
+#pragma once
+
+#include "vector.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+namespace pva {
+    
+    namespace detail {
+        
+        /********************************************************
+         * Число установленных бит слова
+         */
+        
+        inline std::size_t popcount(std::uint64_t word) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<std::size_t>(__builtin_popcountll(word));
+#else
+            word = word - ((word >> 1) & 0x5555555555555555ull);
+            word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+            word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+            return static_cast<std::size_t>((word * 0x0101010101010101ull) >> 56);
+#endif
+        }
+        
+        /********************************************************
+         * Индекс младшего установленного бита ненулевого слова
+         */
+        
+        inline std::size_t lowest_bit(std::uint64_t word) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<std::size_t>(__builtin_ctzll(word));
+#else
+            std::size_t index = 0;
+            for (; (word & 1) == 0; word >>= 1)
+                ++index;
+            return index;
+#endif
+        }
+        
+        /********************************************************
+         * Подсчет установленных бит в массиве слов скалярным
+         * циклом
+         */
+        
+        inline std::size_t count_bits_scalar(const std::uint64_t* words, std::size_t count) noexcept {
+            std::size_t result = 0;
+            for (std::size_t i = 0; i < count; ++i)
+                result += popcount(words[i]);
+            return result;
+        }
+        
+        /********************************************************
+         * \brief Побитовые операции над словами
+         ********************************************************
+         * apply перегружен для слова, SSE2 и AVX2 регистров,
+         * чтобы одно ядро обслуживало &=, |= и ^=
+         */
+        
+        struct bit_and {
+            static std::uint64_t apply(std::uint64_t lhs, std::uint64_t rhs) noexcept {
+                return lhs & rhs;
+            }
+#if PVA_SIMD_X86
+            static __m128i apply(__m128i lhs, __m128i rhs) noexcept {
+                return _mm_and_si128(lhs, rhs);
+            }
+            
+            __attribute__((target("avx2")))
+            static __m256i apply(__m256i lhs, __m256i rhs) noexcept {
+                return _mm256_and_si256(lhs, rhs);
+            }
+#endif
+        };
+        
+        struct bit_or {
+            static std::uint64_t apply(std::uint64_t lhs, std::uint64_t rhs) noexcept {
+                return lhs | rhs;
+            }
+#if PVA_SIMD_X86
+            static __m128i apply(__m128i lhs, __m128i rhs) noexcept {
+                return _mm_or_si128(lhs, rhs);
+            }
+            
+            __attribute__((target("avx2")))
+            static __m256i apply(__m256i lhs, __m256i rhs) noexcept {
+                return _mm256_or_si256(lhs, rhs);
+            }
+#endif
+        };
+        
+        struct bit_xor {
+            static std::uint64_t apply(std::uint64_t lhs, std::uint64_t rhs) noexcept {
+                return lhs ^ rhs;
+            }
+#if PVA_SIMD_X86
+            static __m128i apply(__m128i lhs, __m128i rhs) noexcept {
+                return _mm_xor_si128(lhs, rhs);
+            }
+            
+            __attribute__((target("avx2")))
+            static __m256i apply(__m256i lhs, __m256i rhs) noexcept {
+                return _mm256_xor_si256(lhs, rhs);
+            }
+#endif
+        };
+        
+        /********************************************************
+         * dest[i] = Op(dest[i], source[i]) скалярным циклом
+         */
+        
+        template<class Op>
+        inline void combine_words_scalar(std::uint64_t* dest, const std::uint64_t* source, std::size_t count) noexcept {
+            for (std::size_t i = 0; i < count; ++i)
+                dest[i] = Op::apply(dest[i], source[i]);
+        }
+
+#if PVA_SIMD_X86
+        /********************************************************
+         * Поддерживает ли процессор POPCNT
+         ********************************************************
+         * Проверяется один раз за время работы программы
+         */
+        
+        inline bool cpu_has_popcnt() noexcept {
+            static const bool popcnt = [] {
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("popcnt") != 0;
+            }();
+            return popcnt;
+        }
+        
+        /********************************************************
+         * Подсчет бит инструкцией POPCNT
+         ********************************************************
+         * Вызывается только если cpu_has_popcnt()
+         */
+        
+        __attribute__((target("popcnt")))
+        inline std::size_t count_bits_popcnt(const std::uint64_t* words, std::size_t count) noexcept {
+            std::size_t result = 0;
+            for (std::size_t i = 0; i < count; ++i)
+                result += static_cast<std::size_t>(__builtin_popcountll(words[i]));
+            return result;
+        }
+        
+        /********************************************************
+         * Подсчет бит (AVX2)
+         ********************************************************
+         * Число бит каждой тетрады берется из таблицы на 16
+         * значений перестановкой байт (vpshufb), суммы байт
+         * накапливаются vpsadbw в четырех 64-битных счетчиках.
+         * Вызывается только если cpu_has_avx2()
+         */
+        
+        __attribute__((target("avx2,popcnt")))
+        inline std::size_t count_bits_avx2(const std::uint64_t* words, std::size_t count) noexcept {
+            const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                   0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+            const __m256i low = _mm256_set1_epi8(0x0F);
+            __m256i total = _mm256_setzero_si256();
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+                const __m256i bits = _mm256_add_epi8(
+                    _mm256_shuffle_epi8(table, _mm256_and_si256(value, low)),
+                    _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(value, 4), low)));
+                total = _mm256_add_epi64(total, _mm256_sad_epu8(bits, _mm256_setzero_si256()));
+            }
+            alignas(32) std::uint64_t lanes[4];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), total);
+            std::size_t result = static_cast<std::size_t>(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+            for (; i < count; ++i)
+                result += static_cast<std::size_t>(__builtin_popcountll(words[i]));
+            return result;
+        }
+        
+        /********************************************************
+         * dest[i] = Op(dest[i], source[i]) (SSE2)
+         */
+        
+        template<class Op>
+        inline void combine_words_sse2(std::uint64_t* dest, const std::uint64_t* source, std::size_t count) noexcept {
+            std::size_t i = 0;
+            for (; i + 2 <= count; i += 2) {
+                __m128i* target = reinterpret_cast<__m128i*>(dest + i);
+                _mm_storeu_si128(target, Op::apply(_mm_loadu_si128(target),
+                                                   _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i))));
+            }
+            combine_words_scalar<Op>(dest + i, source + i, count - i);
+        }
+        
+        /********************************************************
+         * dest[i] = Op(dest[i], source[i]) (AVX2)
+         ********************************************************
+         * Вызывается только если cpu_has_avx2()
+         */
+        
+        template<class Op>
+        __attribute__((target("avx2")))
+        inline void combine_words_avx2(std::uint64_t* dest, const std::uint64_t* source, std::size_t count) noexcept {
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                __m256i* target = reinterpret_cast<__m256i*>(dest + i);
+                _mm256_storeu_si256(target, Op::apply(_mm256_loadu_si256(target),
+                                                      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i))));
+            }
+            combine_words_scalar<Op>(dest + i, source + i, count - i);
+        }
+#endif
+        
+        /********************************************************
+         * Подсчет установленных бит в массиве слов
+         ********************************************************
+         * \param words Слова
+         * \param count Число слов
+         * \return Число установленных бит
+         */
+        
+        inline std::size_t count_bits(const std::uint64_t* words, std::size_t count) noexcept {
+#if PVA_SIMD_X86
+            if (count >= 8 && cpu_has_avx2())
+                return count_bits_avx2(words, count);
+            if (cpu_has_popcnt())
+                return count_bits_popcnt(words, count);
+#endif
+            return count_bits_scalar(words, count);
+        }
+        
+        /********************************************************
+         * Побитовая операция над массивами слов
+         ********************************************************
+         * \param dest Слова левого операнда и результата
+         * \param source Слова правого операнда
+         * \param count Число слов
+         */
+        
+        template<class Op>
+        inline void combine_words(std::uint64_t* dest, const std::uint64_t* source, std::size_t count) noexcept {
+#if PVA_SIMD_X86
+            if (cpu_has_avx2())
+                combine_words_avx2<Op>(dest, source, count);
+            else
+                combine_words_sse2<Op>(dest, source, count);
+#else
+            combine_words_scalar<Op>(dest, source, count);
+#endif
+        }
+        
+        /********************************************************
+         * Индекс первого установленного бита, начиная с бита
+         * first
+         ********************************************************
+         * \param words Слова
+         * \param count Число слов
+         * \param first Первый проверяемый бит
+         * \return Индекс бита или count * 64, если бит не найден
+         */
+        
+        inline std::size_t find_bit(const std::uint64_t* words, std::size_t count, std::size_t first) noexcept {
+            std::size_t index = first / 64;
+            if (index >= count)
+                return count * 64;
+            std::uint64_t word = words[index] & (~std::uint64_t(0) << (first % 64));
+            while (word == 0) {
+                if (++index == count)
+                    return count * 64;
+                word = words[index];
+            }
+            return index * 64 + lowest_bit(word);
+        }
+    }
+    
+    /********************************************************
+     * \brief Прокси-ссылка на флаг vector<bool>
+     ********************************************************
+     * Хранит слово и маску бита. Читается как bool,
+     * присваивание меняет только свой бит
+     */
+    
+    class bit_reference {
+    public:
+        bit_reference(std::uint64_t* word, std::uint64_t mask) noexcept
+        :word_(word), mask_(mask) {}
+        
+        bit_reference(const bit_reference &copy) = default;
+        
+        operator bool() const noexcept {
+            return (*word_ & mask_) != 0;
+        }
+        
+        bool operator ~() const noexcept {
+            return (*word_ & mask_) == 0;
+        }
+        
+        bit_reference& operator =(bool value) noexcept {
+            if (value)
+                *word_ |= mask_;
+            else
+                *word_ &= ~mask_;
+            return *this;
+        }
+        
+        bit_reference& operator =(const bit_reference &copy) noexcept {
+            return *this = bool(copy);
+        }
+        
+        /********************************************************
+         * Инверсия флага
+         */
+        
+        void flip() noexcept {
+            *word_ ^= mask_;
+        }
+    
+    private:
+        std::uint64_t* word_; /*< Слово с флагом*/
+        std::uint64_t mask_; /*< Маска бита флага*/
+    };
+    
+    /********************************************************
+     * Обмен значений двух флагов
+     */
+    
+    inline void swap(bit_reference lhs, bit_reference rhs) noexcept {
+        const bool value = lhs;
+        lhs = bool(rhs);
+        rhs = value;
+    }
+    
+    /********************************************************
+     * \brief Итератор vector<bool>
+     ********************************************************
+     * Хранит начало массива слов и индекс бита.
+     * Разыменование дает bit_reference (Word изменяемый)
+     * или bool (Word константный)
+     */
+    
+    template<class Word>
+    class bit_iterator {
+        template<class>
+        friend class bit_iterator;
+    
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef bool value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef void pointer;
+        typedef typename std::conditional<std::is_const<Word>::value, bool, bit_reference>::type reference;
+        
+        /**********************************************
+         * Конструктор по умолчанию
+         */
+        
+        bit_iterator() noexcept
+        :words_(nullptr), index_(0) {}
+        
+        /**********************************************
+         * Конструктор итератора на бит
+         **********************************************
+         * \param words Массив слов
+         * \param index Индекс бита
+         */
+        
+        bit_iterator(Word* words, std::size_t index) noexcept
+        :words_(words), index_(index) {}
+        
+        /**********************************************
+         * Преобразование итератора в константный
+         */
+        
+        template<class OtherWord, class = typename std::enable_if<std::is_same<const OtherWord, Word>::value>::type>
+        bit_iterator(const bit_iterator<OtherWord> &copy) noexcept
+        :words_(copy.words_), index_(copy.index_) {}
+        
+        reference operator *() const noexcept {
+            return at(index_);
+        }
+        
+        reference operator [](const difference_type &size) const noexcept {
+            return at(index_ + size);
+        }
+        
+        bit_iterator& operator ++() noexcept {
+            ++index_;
+            return *this;
+        }
+        
+        bit_iterator operator ++(int) noexcept {
+            bit_iterator old(*this);
+            ++index_;
+            return old;
+        }
+        
+        bit_iterator& operator --() noexcept {
+            --index_;
+            return *this;
+        }
+        
+        bit_iterator operator --(int) noexcept {
+            bit_iterator old(*this);
+            --index_;
+            return old;
+        }
+        
+        bit_iterator& operator +=(const difference_type &size) noexcept {
+            index_ += size;
+            return *this;
+        }
+        
+        bit_iterator operator +(const difference_type &size) const noexcept {
+            return bit_iterator(words_, index_ + size);
+        }
+        
+        bit_iterator& operator -=(const difference_type &size) noexcept {
+            index_ -= size;
+            return *this;
+        }
+        
+        bit_iterator operator -(const difference_type &size) const noexcept {
+            return bit_iterator(words_, index_ - size);
+        }
+        
+        std::size_t index() const noexcept {
+            return index_;
+        }
+    
+    private:
+        reference at(const std::size_t &index) const noexcept {
+            if constexpr (std::is_const<Word>::value)
+                return (words_[index / 64] >> (index % 64)) & 1;
+            else
+                return bit_reference(words_ + index / 64, std::uint64_t(1) << (index % 64));
+        }
+        
+        Word* words_; /*< Массив слов*/
+        std::size_t index_; /*< Индекс бита*/
+    };
+    
+    template<class Word>
+    inline bit_iterator<Word> operator +(const std::ptrdiff_t &size, const bit_iterator<Word> &it) noexcept {
+        return it + size;
+    }
+    
+    /********************************************************
+     * Операторы сравнения и разность итераторов vector<bool>
+     ********************************************************
+     * Сравниваются индексы бит, константный итератор можно
+     * сравнивать с изменяемым
+     */
+    
+    template<class W1, class W2>
+    inline std::ptrdiff_t operator -(const bit_iterator<W1> &lhs, const bit_iterator<W2> &rhs) noexcept {
+        return std::ptrdiff_t(lhs.index()) - std::ptrdiff_t(rhs.index());
+    }
+    
+    template<class W1, class W2>
+    inline bool operator ==(const bit_iterator<W1> &lhs, const bit_iterator<W2> &rhs) noexcept {
+        return lhs.index() == rhs.index();
+    }
+    
+    template<class W1, class W2>
+    inline bool operator !=(const bit_iterator<W1> &lhs, const bit_iterator<W2> &rhs) noexcept {
+        return lhs.index() != rhs.index();
+    }
+    
+    template<class W1, class W2>
+    inline bool operator <(const bit_iterator<W1> &lhs, const bit_iterator<W2> &rhs) noexcept {
+        return lhs.index() < rhs.index();
+    }
+    
+    template<class W1, class W2>
+    inline bool operator >(const bit_iterator<W1> &lhs, const bit_iterator<W2> &rhs) noexcept {
+        return lhs.index() > rhs.index();
+    }
+    
+    template<class W1, class W2>
+    inline bool operator <=(const bit_iterator<W1> &lhs, const bit_iterator<W2> &rhs) noexcept {
+        return lhs.index() <= rhs.index();
+    }
+    
+    template<class W1, class W2>
+    inline bool operator >=(const bit_iterator<W1> &lhs, const bit_iterator<W2> &rhs) noexcept {
+        return lhs.index() >= rhs.index();
+    }
+    
+    /********************************************************
+     * \brief Упакованный вектор флагов
+     ********************************************************
+     * Хранит 64 флага в слове std::uint64_t (в 8 раз меньше
+     * памяти, чем байт на флаг). Слова лежат в
+     * pva::vector<std::uint64_t> с тем же аллокатором
+     * (rebind) и GrowthPolicy. Биты за size() в последнем
+     * слове всегда нулевые, поэтому count(), поиск и
+     * сравнение работают по целым словам. Элемент доступен
+     * через прокси-ссылку bit_reference, поэтому bool* и
+     * data() нет (см. words())
+     */
+    
+    template<class Allocator, class GrowthPolicy>
+    class vector<bool, Allocator, GrowthPolicy> {
+    public:
+        typedef std::uint64_t word_type;
+    
+    private:
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<word_type> word_allocator;
+        typedef vector<word_type, word_allocator, GrowthPolicy> storage;
+        
+        static constexpr std::size_t word_bits = 64; /*< Бит в слове*/
+    
+    public:
+        typedef bool value_type;
+        typedef Allocator allocator_type;
+        typedef std::size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef bit_reference reference;
+        typedef bool const_reference;
+        typedef bit_iterator<word_type> iterator;
+        typedef bit_iterator<const word_type> const_iterator;
+        typedef std::reverse_iterator<iterator> reverse_iterator;
+        typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+        
+        static constexpr std::size_t npos = std::size_t(-1); /*< Бит не найден*/
+        
+        /**********************************************
+         * Конструктор по умолчанию
+         */
+        
+        vector() noexcept(noexcept(Allocator()))
+        :words_(word_allocator(Allocator())), count_(0) {}
+        
+        /**********************************************
+         * Конструктор пустого вектора с заданным аллокатором
+         */
+        
+        explicit vector(const Allocator &allocator) noexcept
+        :words_(word_allocator(allocator)), count_(0) {}
+        
+        /********************************************************
+         * Конструктор, который выделяет память под size флагов,
+         * не создавая их (как у основного шаблона)
+         */
+        
+        explicit vector(const std::size_t &size, const Allocator &allocator = Allocator())
+        :words_(words_for(size), word_allocator(allocator)), count_(0) {}
+        
+        /********************************************************
+         * Конструктор из массива флагов data размером size
+         */
+        
+        vector(const std::size_t &size, const bool* data, const Allocator &allocator = Allocator())
+        :vector(data, data + size, allocator) {}
+        
+        /********************************************************
+         * Конструктор из диапазона [first, last)
+         */
+        
+        template<class InputIt, class = typename std::enable_if<detail::is_iterator<InputIt>::value>::type>
+        vector(InputIt first, InputIt last, const Allocator &allocator = Allocator())
+        :words_(word_allocator(allocator)), count_(0) {
+            append(first, last);
+        }
+        
+        /********************************************************
+         * Конструктор из списка флагов
+         */
+        
+        vector(std::initializer_list<bool> values, const Allocator &allocator = Allocator())
+        :vector(values.begin(), values.end(), allocator) {}
+        
+        vector(const vector &copy) = default;
+        
+        vector(vector &&copy) noexcept(std::is_nothrow_move_constructible<storage>::value)
+        :words_(pva::move(copy.words_)), count_(copy.count_) {
+            copy.count_ = 0;
+        }
+        
+        vector& operator =(const vector &copy) {
+            if (this != &copy) {
+                words_ = copy.words_;
+                count_ = copy.count_;
+            }
+            return *this;
+        }
+        
+        vector& operator =(vector &&copy) {
+            if (this != &copy) {
+                words_ = pva::move(copy.words_);
+                count_ = copy.count_;
+                copy.count_ = 0;
+            }
+            return *this;
+        }
+        
+        std::size_t size() const noexcept {
+            return count_;
+        }
+        
+        bool empty() const noexcept {
+            return count_ == 0;
+        }
+        
+        std::size_t capacity() const noexcept {
+            return words_.capacity() * word_bits;
+        }
+        
+        /********************************************************
+         * Выделение памяти под size флагов
+         */
+        
+        bool reserve(const std::size_t &size) {
+            return words_.reserve(words_for(size));
+        }
+        
+        void shrink_to_fit() {
+            words_.shrink_to_fit();
+        }
+        
+        /********************************************************
+         * Удаление всех флагов (емкость не меняется)
+         */
+        
+        void clear() noexcept {
+            words_.clear();
+            count_ = 0;
+        }
+        
+        void push_back(bool value) {
+            if (count_ % word_bits == 0)
+                words_.push_back(word_type(value));
+            else if (value)
+                words_.back() |= word_type(1) << (count_ % word_bits);
+            ++count_;
+        }
+        
+        void pop_back() {
+            PVA_ASSERT(count_ != 0, "pop_back() on empty vector");
+            --count_;
+            if (count_ % word_bits == 0)
+                words_.pop_back();
+            else
+                words_.back() &= ~(word_type(1) << (count_ % word_bits));
+        }
+        
+        /********************************************************
+         * Добавление флагов [first, last) в конец
+         */
+        
+        template<class InputIt, class = typename std::enable_if<detail::is_iterator<InputIt>::value>::type>
+        void append(InputIt first, InputIt last) {
+            if constexpr (detail::is_forward_iterator<InputIt>::value)
+                reserve(count_ + std::size_t(std::distance(first, last)));
+            for (; first != last; ++first)
+                push_back(bool(*first));
+        }
+        
+        /********************************************************
+         * Создание флага в конце вектора из args
+         ********************************************************
+         * \return Ссылка на созданный флаг
+         */
+        
+        template<class... Args>
+        reference emplace_back(Args&&... args) {
+            push_back(bool(pva::forward<Args>(args)...));
+            return back();
+        }
+        
+        /********************************************************
+         * Создание флага перед позицией pos из args
+         */
+        
+        template<class... Args>
+        iterator emplace(const_iterator pos, Args&&... args) {
+            return insert(pos, bool(pva::forward<Args>(args)...));
+        }
+        
+        /********************************************************
+         * Вставка флага перед позицией pos
+         ********************************************************
+         * Флаги после pos сдвигаются по словам
+         ********************************************************
+         * \param pos Итератор на позицию вставки
+         * \param value Значение флага
+         * \return Итератор на вставленный флаг
+         */
+        
+        iterator insert(const_iterator pos, bool value) {
+            const std::size_t index = pos.index();
+            PVA_ASSERT(index <= count_, "Iterator is out of range!");
+            if (index == count_) {
+                push_back(value);
+                return iterator(words_.data(), index);
+            }
+            open_gap(index, 1);
+            (*this)[index] = value;
+            return iterator(words_.data(), index);
+        }
+        
+        /********************************************************
+         * Вставка флагов [first, last) перед позицией pos
+         ********************************************************
+         * Хвост сдвигается один раз. Диапазон не должен
+         * указывать в этот же вектор
+         ********************************************************
+         * \return Итератор на первый вставленный флаг
+         */
+        
+        template<class InputIt, class = typename std::enable_if<detail::is_iterator<InputIt>::value>::type>
+        iterator insert(const_iterator pos, InputIt first, InputIt last) {
+            const std::size_t index = pos.index();
+            PVA_ASSERT(index <= count_, "Iterator is out of range!");
+            if constexpr (!detail::is_forward_iterator<InputIt>::value) {
+                const vector temp(first, last, get_allocator());
+                return insert(pos, temp.begin(), temp.end());
+            }
+            else {
+                const std::size_t count = std::size_t(std::distance(first, last));
+                open_gap(index, count);
+                word_type* words = words_.data();
+                for (std::size_t i = index; first != last; ++first, ++i)
+                    if (bool(*first))
+                        words[i / word_bits] |= word_type(1) << (i % word_bits);
+                return iterator(words_.data(), index);
+            }
+        }
+        
+        /********************************************************
+         * Удаление флага в позиции pos
+         ********************************************************
+         * \return Итератор на флаг, следующий за удаленным
+         */
+        
+        iterator erase(const_iterator pos) {
+            return erase(pos, pos + 1);
+        }
+        
+        /********************************************************
+         * Удаление флагов [first, last)
+         ********************************************************
+         * Хвост сдвигается по словам один раз
+         ********************************************************
+         * \return Итератор на флаг, следующий за удаленными
+         */
+        
+        iterator erase(const_iterator first, const_iterator last) {
+            PVA_ASSERT(first <= last && last.index() <= count_, "Iterator is out of range!");
+            const std::size_t from = first.index();
+            const std::size_t to = last.index();
+            if (from != to) {
+                move_bits(to, from, count_ - to);
+                truncate(count_ - (to - from));
+            }
+            return iterator(words_.data(), from);
+        }
+        
+        /********************************************************
+         * Удаление флага в позиции pos за O(1)
+         ********************************************************
+         * На место удаленного флага переносится последний
+         ********************************************************
+         * \return Итератор на флаг, занявший место удаленного
+         */
+        
+        iterator unordered_erase(const_iterator pos) {
+            const std::size_t index = pos.index();
+            PVA_ASSERT(index < count_, "Iterator is out of range!");
+            if (index + 1 != count_)
+                (*this)[index] = test(count_ - 1);
+            pop_back();
+            return iterator(words_.data(), index);
+        }
+        
+        /********************************************************
+         * Удаление всех флагов, для которых pred истинен
+         ********************************************************
+         * Один проход: оставшиеся флаги собираются в слово и
+         * записываются целыми словами. Если pred бросит
+         * исключение, вектор остается корректным, но часть
+         * флагов может быть уже удалена
+         ********************************************************
+         * \param pred Условие удаления pred(bool)
+         * \return Число удаленных флагов
+         */
+        
+        template<class Predicate>
+        std::size_t erase_if(Predicate pred) {
+            word_type* words = words_.data();
+            std::size_t index = 0;
+            std::size_t result = 0;
+            word_type kept = 0;
+            try {
+                for (; index < count_; ++index) {
+                    const bool value = test(index);
+                    if (pred(value))
+                        continue;
+                    kept |= word_type(value) << (result % word_bits);
+                    if (++result % word_bits == 0) {
+                        words[result / word_bits - 1] = kept;
+                        kept = 0;
+                    }
+                }
+            }
+            catch (...) {
+                if (result % word_bits != 0)
+                    store_bits(result / word_bits * word_bits, kept, result % word_bits);
+                move_bits(index, result, count_ - index);
+                truncate(result + (count_ - index));
+                throw;
+            }
+            if (result % word_bits != 0)
+                words[result / word_bits] = kept;
+            const std::size_t erased = count_ - result;
+            truncate(result);
+            return erased;
+        }
+        
+        /********************************************************
+         * Удаление флагов с индексами из [first, last)
+         ********************************************************
+         * Индексы должны быть упорядочены по возрастанию и
+         * меньше size() (повторы пропускаются). Отрезки между
+         * удаляемыми флагами сдвигаются по словам
+         ********************************************************
+         * \return Число удаленных флагов
+         */
+        
+        template<class InputIt, class = typename std::enable_if<detail::is_iterator<InputIt>::value>::type>
+        std::size_t erase_indices(InputIt first, InputIt last) {
+            if (first == last)
+                return 0;
+            std::size_t result = std::size_t(*first);
+            std::size_t current = result;
+            for (; first != last; ++first) {
+                const std::size_t index = *first;
+                PVA_ASSERT(index < count_, "Index more than size of vector!");
+                if (index < current) {
+                    PVA_ASSERT(index + 1 == current, "Indices are not sorted!");
+                    continue;
+                }
+                move_bits(current, result, index - current);
+                result += index - current;
+                current = index + 1;
+            }
+            move_bits(current, result, count_ - current);
+            result += count_ - current;
+            const std::size_t erased = count_ - result;
+            truncate(result);
+            return erased;
+        }
+        
+        template<class Indices, class = decltype(std::begin(std::declval<const Indices&>()))>
+        std::size_t erase_indices(const Indices &indices) {
+            return erase_indices(std::begin(indices), std::end(indices));
+        }
+        
+        /********************************************************
+         * Изменение количества флагов
+         ********************************************************
+         * \param size Новое количество флагов
+         * \param value Значение новых флагов
+         */
+        
+        void resize(const std::size_t &size, bool value = false) {
+            if (size > count_) {
+                words_.resize(words_for(size), word_type(0));
+                if (value)
+                    fill(count_, size, value);
+                count_ = size;
+                clear_tail();
+            }
+            else
+                truncate(size);
+        }
+        
+        /********************************************************
+         * Замена содержимого size флагами value
+         */
+        
+        void assign(const std::size_t &size, bool value) {
+            words_.assign(words_for(size), value ? ~word_type(0) : word_type(0));
+            count_ = size;
+            clear_tail();
+        }
+        
+        /********************************************************
+         * Замена содержимого флагами [first, last)
+         */
+        
+        template<class InputIt, class = typename std::enable_if<detail::is_iterator<InputIt>::value>::type>
+        void assign(InputIt first, InputIt last) {
+            clear();
+            append(first, last);
+        }
+        
+        reference operator [](const std::size_t &index) noexcept {
+            PVA_ASSERT(index < count_, "vector<bool> index out of range");
+            return reference(words_.data() + index / word_bits, word_type(1) << (index % word_bits));
+        }
+        
+        bool operator [](const std::size_t &index) const noexcept {
+            PVA_ASSERT(index < count_, "vector<bool> index out of range");
+            return test(index);
+        }
+        
+        reference at(const std::size_t &index) {
+            if (index >= count_)
+                throw std::out_of_range("Index more than size of vector!");
+            return (*this)[index];
+        }
+        
+        bool at(const std::size_t &index) const {
+            if (index >= count_)
+                throw std::out_of_range("Index more than size of vector!");
+            return test(index);
+        }
+        
+        reference front() noexcept {
+            return (*this)[0];
+        }
+        
+        bool front() const noexcept {
+            return (*this)[0];
+        }
+        
+        reference back() noexcept {
+            return (*this)[count_ - 1];
+        }
+        
+        bool back() const noexcept {
+            return (*this)[count_ - 1];
+        }
+        
+        /********************************************************
+         * Значение флага index (без проверки индекса)
+         */
+        
+        bool test(const std::size_t &index) const noexcept {
+            return (words_.data()[index / word_bits] >> (index % word_bits)) & 1;
+        }
+        
+        /********************************************************
+         * Установка флага index в value
+         */
+        
+        void set(const std::size_t &index, bool value = true) noexcept {
+            (*this)[index] = value;
+        }
+        
+        void reset(const std::size_t &index) noexcept {
+            (*this)[index] = false;
+        }
+        
+        void flip(const std::size_t &index) noexcept {
+            (*this)[index].flip();
+        }
+        
+        /********************************************************
+         * Установка всех флагов
+         */
+        
+        void set() noexcept {
+            if (!words_.empty())
+                std::memset(words_.data(), 0xFF, words_.size() * sizeof(word_type));
+            clear_tail();
+        }
+        
+        /********************************************************
+         * Сброс всех флагов
+         */
+        
+        void reset() noexcept {
+            if (!words_.empty())
+                std::memset(words_.data(), 0, words_.size() * sizeof(word_type));
+        }
+        
+        /********************************************************
+         * Инверсия всех флагов
+         */
+        
+        void flip() noexcept {
+            word_type* words = words_.data();
+            for (std::size_t i = 0; i < words_.size(); ++i)
+                words[i] = ~words[i];
+            clear_tail();
+        }
+        
+        /********************************************************
+         * Число установленных флагов
+         ********************************************************
+         * Считается по словам: POPCNT или AVX2, если их
+         * поддерживает процессор
+         */
+        
+        std::size_t count() const noexcept {
+            return detail::count_bits(words_.data(), words_.size());
+        }
+        
+        bool any() const noexcept {
+            return find_first() != npos;
+        }
+        
+        bool none() const noexcept {
+            return find_first() == npos;
+        }
+        
+        bool all() const noexcept {
+            return count() == count_;
+        }
+        
+        /********************************************************
+         * Индекс первого установленного флага
+         ********************************************************
+         * \return Индекс или npos, если флагов нет
+         */
+        
+        std::size_t find_first() const noexcept {
+            return found(detail::find_bit(words_.data(), words_.size(), 0));
+        }
+        
+        /********************************************************
+         * Индекс первого установленного флага после pos
+         ********************************************************
+         * \param pos Предыдущий найденный индекс
+         * \return Индекс или npos, если флагов больше нет
+         */
+        
+        std::size_t find_next(const std::size_t &pos) const noexcept {
+            if (pos >= count_ || pos + 1 == count_)
+                return npos;
+            return found(detail::find_bit(words_.data(), words_.size(), pos + 1));
+        }
+        
+        /********************************************************
+         * Побитовые операции с вектором other того же размера
+         ********************************************************
+         * Выполняются по словам (SSE2/AVX2 на x86). Бросают
+         * std::invalid_argument, если размеры различаются
+         */
+        
+        vector& operator &=(const vector &other) {
+            combine<detail::bit_and>(other);
+            return *this;
+        }
+        
+        vector& operator |=(const vector &other) {
+            combine<detail::bit_or>(other);
+            return *this;
+        }
+        
+        vector& operator ^=(const vector &other) {
+            combine<detail::bit_xor>(other);
+            return *this;
+        }
+        
+        /********************************************************
+         * Слова с флагами: флаг i - бит i % 64 слова i / 64
+         */
+        
+        const word_type* words() const noexcept {
+            return words_.data();
+        }
+        
+        std::size_t word_count() const noexcept {
+            return words_.size();
+        }
+        
+        iterator begin() noexcept {
+            return iterator(words_.data(), 0);
+        }
+        
+        const_iterator begin() const noexcept {
+            return const_iterator(words_.data(), 0);
+        }
+        
+        const_iterator cbegin() const noexcept {
+            return begin();
+        }
+        
+        iterator end() noexcept {
+            return iterator(words_.data(), count_);
+        }
+        
+        const_iterator end() const noexcept {
+            return const_iterator(words_.data(), count_);
+        }
+        
+        const_iterator cend() const noexcept {
+            return end();
+        }
+        
+        reverse_iterator rbegin() noexcept {
+            return reverse_iterator(end());
+        }
+        
+        const_reverse_iterator rbegin() const noexcept {
+            return const_reverse_iterator(end());
+        }
+        
+        reverse_iterator rend() noexcept {
+            return reverse_iterator(begin());
+        }
+        
+        const_reverse_iterator rend() const noexcept {
+            return const_reverse_iterator(begin());
+        }
+        
+        allocator_type get_allocator() const {
+            return allocator_type(words_.get_allocator());
+        }
+        
+        void swap(vector &other) noexcept(noexcept(std::declval<storage&>().swap(std::declval<storage&>()))) {
+            words_.swap(other.words_);
+            const std::size_t count = count_;
+            count_ = other.count_;
+            other.count_ = count;
+        }
+    
+    private:
+        static std::size_t words_for(const std::size_t &bits) noexcept {
+            return bits / word_bits + (bits % word_bits != 0);
+        }
+        
+        std::size_t found(const std::size_t &index) const noexcept {
+            return index < count_ ? index : npos;
+        }
+        
+        /********************************************************
+         * Обнуление бит последнего слова за size()
+         */
+        
+        void clear_tail() noexcept {
+            if (count_ % word_bits != 0)
+                words_.back() &= (word_type(1) << (count_ % word_bits)) - 1;
+        }
+        
+        /********************************************************
+         * Уменьшение числа флагов до size (size <= size())
+         */
+        
+        void truncate(const std::size_t &size) noexcept {
+            words_.resize(words_for(size));
+            count_ = size;
+            clear_tail();
+        }
+        
+        /********************************************************
+         * Заполнение флагов [first, last) значением value
+         */
+        
+        void fill(const std::size_t &first, const std::size_t &last, bool value) noexcept {
+            const word_type bits = value ? ~word_type(0) : word_type(0);
+            for (std::size_t index = first; index < last; index += word_bits)
+                store_bits(index, bits, last - index < word_bits ? last - index : word_bits);
+        }
+        
+        /********************************************************
+         * Слово из 64 флагов, начиная с флага position
+         ********************************************************
+         * Флаги за последним словом читаются как нулевые
+         */
+        
+        word_type load_bits(const std::size_t &position) const noexcept {
+            const word_type* words = words_.data();
+            const std::size_t word = position / word_bits;
+            const std::size_t offset = position % word_bits;
+            word_type value = words[word] >> offset;
+            if (offset != 0 && word + 1 < words_.size())
+                value |= words[word + 1] << (word_bits - offset);
+            return value;
+        }
+        
+        /********************************************************
+         * Запись length (1..64) младших бит value во флаги,
+         * начиная с флага position
+         */
+        
+        void store_bits(const std::size_t &position, word_type value, const std::size_t &length) noexcept {
+            word_type* words = words_.data();
+            const std::size_t word = position / word_bits;
+            const std::size_t offset = position % word_bits;
+            const word_type mask = length == word_bits ? ~word_type(0) : (word_type(1) << length) - 1;
+            value &= mask;
+            words[word] = (words[word] & ~(mask << offset)) | (value << offset);
+            if (offset + length > word_bits) {
+                const word_type high = mask >> (word_bits - offset);
+                words[word + 1] = (words[word + 1] & ~high) | (value >> (word_bits - offset));
+            }
+        }
+        
+        /********************************************************
+         * Перенос length флагов с позиции from на позицию to
+         ********************************************************
+         * Как memmove: диапазоны могут перекрываться. Флаги
+         * переносятся по 64 за шаг
+         */
+        
+        void move_bits(const std::size_t &from, const std::size_t &to, const std::size_t &length) noexcept {
+            if (from == to || length == 0)
+                return;
+            if (to < from) {
+                for (std::size_t done = 0; done < length; done += word_bits)
+                    store_bits(to + done, load_bits(from + done),
+                               length - done < word_bits ? length - done : word_bits);
+            }
+            else {
+                for (std::size_t left = length; left != 0;) {
+                    const std::size_t step = left < word_bits ? left : word_bits;
+                    left -= step;
+                    store_bits(to + left, load_bits(from + left), step);
+                }
+            }
+        }
+        
+        /********************************************************
+         * Вставка count нулевых флагов перед флагом index
+         */
+        
+        void open_gap(const std::size_t &index, const std::size_t &count) {
+            if (count == 0)
+                return;
+            const std::size_t old = count_;
+            resize(count_ + count);
+            move_bits(index, index + count, old - index);
+            fill(index, index + count, false);
+        }
+        
+        template<class Op>
+        void combine(const vector &other) {
+            if (other.count_ != count_)
+                throw std::invalid_argument("Vectors of flags have different sizes!");
+            detail::combine_words<Op>(words_.data(), other.words_.data(), words_.size());
+        }
+        
+        storage words_; /*< Слова с флагами*/
+        std::size_t count_; /*< Число флагов*/
+    };
+    
+    /********************************************************
+     * Перегруженный оператор == для векторов флагов
+     ********************************************************
+     * Сравнивает слова memcmp (биты за size() нулевые)
+     */
+    
+    template<class Allocator, class GrowthPolicy>
+    inline bool
+    operator ==(const vector<bool, Allocator, GrowthPolicy> &lhs, const vector<bool, Allocator, GrowthPolicy> &rhs) {
+        return lhs.size() == rhs.size() &&
+               (lhs.word_count() == 0 ||
+                std::memcmp(lhs.words(), rhs.words(), lhs.word_count() * sizeof(std::uint64_t)) == 0);
+    }
+    
+    template<class Allocator, class GrowthPolicy>
+    inline bool
+    operator !=(const vector<bool, Allocator, GrowthPolicy> &lhs, const vector<bool, Allocator, GrowthPolicy> &rhs) {
+        return !(lhs == rhs);
+    }
+    
+    /********************************************************
+     * Перегруженный оператор < для векторов флагов
+     ********************************************************
+     * Лексикографическое сравнение (false < true): первое
+     * различающееся слово находится mismatch, в нем -
+     * младший различающийся бит
+     */
+    
+    template<class Allocator, class GrowthPolicy>
+    inline bool
+    operator <(const vector<bool, Allocator, GrowthPolicy> &lhs, const vector<bool, Allocator, GrowthPolicy> &rhs) {
+        const std::size_t common = lhs.size() < rhs.size() ? lhs.size() : rhs.size();
+        const std::size_t full = common / 64;
+        const std::size_t index = detail::mismatch(lhs.words(), rhs.words(), full);
+        std::uint64_t diff = 0;
+        if (index < full)
+            diff = lhs.words()[index] ^ rhs.words()[index];
+        else if (common % 64 != 0)
+            diff = (lhs.words()[full] ^ rhs.words()[full]) & ((std::uint64_t(1) << (common % 64)) - 1);
+        if (diff == 0)
+            return lhs.size() < rhs.size();
+        const std::size_t word = index < full ? index : full;
+        return (rhs.words()[word] >> detail::lowest_bit(diff)) & 1;
+    }
+    
+    template<class Allocator, class GrowthPolicy>
+    inline bool
+    operator >(const vector<bool, Allocator, GrowthPolicy> &lhs, const vector<bool, Allocator, GrowthPolicy> &rhs) {
+        return rhs < lhs;
+    }
+    
+    template<class Allocator, class GrowthPolicy>
+    inline bool
+    operator <=(const vector<bool, Allocator, GrowthPolicy> &lhs, const vector<bool, Allocator, GrowthPolicy> &rhs) {
+        return !(rhs < lhs);
+    }
+    
+    template<class Allocator, class GrowthPolicy>
+    inline bool
+    operator >=(const vector<bool, Allocator, GrowthPolicy> &lhs, const vector<bool, Allocator, GrowthPolicy> &rhs) {
+        return !(lhs < rhs);
+    }
+}
@@ -0,0 +1,315 @@
+/********************************************************
+ * \file
+ * \brief Заголовочный файл с ядрами сравнения массивов
+ ********************************************************
+ * Файл содержит в себе поиск первого различия двух
+ * массивов 'detail::mismatch' для операторов сравнения
+ * контейнеров pva. Для целых, перечислений и указателей
+ * массивы сравниваются побайтово, для float и double -
+ * поэлементно, на x86 через SSE2/AVX2 с выбором
+ * реализации по процессору во время выполнения
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+/********************************************************
+ * Векторизация сравнений
+ ********************************************************
+ * PVA_SIMD = 0 отключает ядра SSE2/AVX2 (остается
+ * скалярная реализация). По умолчанию 1; ядра собираются
+ * только на x86 компиляторами GCC и Clang
+ */
+
+#ifndef PVA_SIMD
+#define PVA_SIMD 1
+#endif
+
+#if PVA_SIMD && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define PVA_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define PVA_SIMD_X86 0
+#endif
+
+namespace pva {
+    
+    namespace detail {
+        
+        /********************************************************
+         * \brief Элементы равны тогда и только тогда, когда
+         * равны их байты
+         ********************************************************
+         * Такие массивы можно сравнивать на равенство memcmp
+         * и искать различие побайтово. Для float и double это
+         * неверно: NaN != NaN, а -0.0 == 0.0
+         */
+        
+        template<class T>
+        struct bitwise_comparable : std::integral_constant<bool,
+            std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value> {};
+        
+        /********************************************************
+         * Поиск первого различия скалярным циклом
+         ********************************************************
+         * \param lhs 1-й массив
+         * \param rhs 2-й массив
+         * \param count Число элементов в каждом массиве
+         * \return Индекс первого различающегося элемента или count
+         */
+        
+        template<class T>
+        inline std::size_t mismatch_scalar(const T* lhs, const T* rhs, std::size_t count) {
+            std::size_t i = 0;
+            while (i < count && lhs[i] == rhs[i])
+                ++i;
+            return i;
+        }
+
+#if PVA_SIMD_X86
+        /********************************************************
+         * Поддерживает ли процессор AVX2
+         ********************************************************
+         * Проверяется один раз за время работы программы
+         */
+        
+        inline bool cpu_has_avx2() noexcept {
+            static const bool avx2 = [] {
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("avx2") != 0;
+            }();
+            return avx2;
+        }
+        
+        /********************************************************
+         * Индекс младшего установленного бита маски
+         */
+        
+        inline std::size_t first_bit(unsigned mask) noexcept {
+            return static_cast<std::size_t>(__builtin_ctz(mask));
+        }
+        
+        /********************************************************
+         * Поиск первого различающегося байта (SSE2)
+         ********************************************************
+         * \param lhs 1-й массив
+         * \param rhs 2-й массив
+         * \param count Число байт в каждом массиве
+         * \return Индекс первого различающегося байта или count
+         */
+        
+        inline std::size_t mismatch_sse2(const unsigned char* lhs, const unsigned char* rhs, std::size_t count) {
+            std::size_t i = 0;
+            for (; i + 16 <= count; i += 16) {
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i));
+                const unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b))) & 0xFFFFu;
+                if (mask)
+                    return i + first_bit(mask);
+            }
+            return i + mismatch_scalar(lhs + i, rhs + i, count - i);
+        }
+        
+        /********************************************************
+         * Поиск первого различающегося float (SSE2)
+         ********************************************************
+         * Сравнение "не равно или неупорядочено": NaN отличается
+         * от всего, -0.0 равен 0.0, как у operator !=
+         */
+        
+        inline std::size_t mismatch_sse2(const float* lhs, const float* rhs, std::size_t count) {
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                const unsigned mask = static_cast<unsigned>(
+                    _mm_movemask_ps(_mm_cmpneq_ps(_mm_loadu_ps(lhs + i), _mm_loadu_ps(rhs + i))));
+                if (mask)
+                    return i + first_bit(mask);
+            }
+            return i + mismatch_scalar(lhs + i, rhs + i, count - i);
+        }
+        
+        /********************************************************
+         * Поиск первого различающегося double (SSE2)
+         */
+        
+        inline std::size_t mismatch_sse2(const double* lhs, const double* rhs, std::size_t count) {
+            std::size_t i = 0;
+            for (; i + 2 <= count; i += 2) {
+                const unsigned mask = static_cast<unsigned>(
+                    _mm_movemask_pd(_mm_cmpneq_pd(_mm_loadu_pd(lhs + i), _mm_loadu_pd(rhs + i))));
+                if (mask)
+                    return i + first_bit(mask);
+            }
+            return i + mismatch_scalar(lhs + i, rhs + i, count - i);
+        }
+        
+        /********************************************************
+         * Поиск первого различающегося байта (AVX2)
+         ********************************************************
+         * Вызывается только если cpu_has_avx2()
+         */
+        
+        __attribute__((target("avx2")))
+        inline std::size_t mismatch_avx2(const unsigned char* lhs, const unsigned char* rhs, std::size_t count) {
+            std::size_t i = 0;
+            for (; i + 32 <= count; i += 32) {
+                const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+                const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+                const unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+                if (mask)
+                    return i + first_bit(mask);
+            }
+            return i + mismatch_sse2(lhs + i, rhs + i, count - i);
+        }
+        
+        /********************************************************
+         * Поиск первого различающегося float (AVX2)
+         */
+        
+        __attribute__((target("avx2")))
+        inline std::size_t mismatch_avx2(const float* lhs, const float* rhs, std::size_t count) {
+            std::size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                const unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(
+                    _mm256_cmp_ps(_mm256_loadu_ps(lhs + i), _mm256_loadu_ps(rhs + i), _CMP_NEQ_UQ)));
+                if (mask)
+                    return i + first_bit(mask);
+            }
+            return i + mismatch_sse2(lhs + i, rhs + i, count - i);
+        }
+        
+        /********************************************************
+         * Поиск первого различающегося double (AVX2)
+         */
+        
+        __attribute__((target("avx2")))
+        inline std::size_t mismatch_avx2(const double* lhs, const double* rhs, std::size_t count) {
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                const unsigned mask = static_cast<unsigned>(_mm256_movemask_pd(
+                    _mm256_cmp_pd(_mm256_loadu_pd(lhs + i), _mm256_loadu_pd(rhs + i), _CMP_NEQ_UQ)));
+                if (mask)
+                    return i + first_bit(mask);
+            }
+            return i + mismatch_sse2(lhs + i, rhs + i, count - i);
+        }
+#endif
+        
+        /********************************************************
+         * Поиск первого различающегося байта
+         ********************************************************
+         * Выбирает AVX2, SSE2 или скалярный цикл
+         */
+        
+        inline std::size_t mismatch_bytes(const unsigned char* lhs, const unsigned char* rhs, std::size_t count) {
+#if PVA_SIMD_X86
+            if (cpu_has_avx2())
+                return mismatch_avx2(lhs, rhs, count);
+            return mismatch_sse2(lhs, rhs, count);
+#else
+            return mismatch_scalar(lhs, rhs, count);
+#endif
+        }
+        
+        /********************************************************
+         * Поиск первого различия двух массивов
+         ********************************************************
+         * Для побайтово сравнимых элементов ищется первый
+         * различающийся байт, для float и double работают
+         * векторные ядра, для остальных типов - operator ==
+         ********************************************************
+         * \param lhs 1-й массив
+         * \param rhs 2-й массив
+         * \param count Число элементов в каждом массиве
+         * \return Индекс первого различающегося элемента или count
+         */
+        
+        template<class T>
+        inline std::size_t mismatch(const T* lhs, const T* rhs, std::size_t count) {
+            if constexpr (bitwise_comparable<T>::value) {
+                return mismatch_bytes(reinterpret_cast<const unsigned char*>(lhs),
+                                      reinterpret_cast<const unsigned char*>(rhs), count * sizeof(T)) / sizeof(T);
+            }
+#if PVA_SIMD_X86
+            else if constexpr (std::is_same<T, float>::value || std::is_same<T, double>::value) {
+                if (cpu_has_avx2())
+                    return mismatch_avx2(lhs, rhs, count);
+                return mismatch_sse2(lhs, rhs, count);
+            }
+#endif
+            else
+                return mismatch_scalar(lhs, rhs, count);
+        }
+        
+        /********************************************************
+         * Проверка равенства двух массивов
+         ********************************************************
+         * \param lhs 1-й массив
+         * \param rhs 2-й массив
+         * \param count Число элементов в каждом массиве
+         * \return True - если все элементы равны
+         */
+        
+        template<class T>
+        inline bool equal(const T* lhs, const T* rhs, std::size_t count) {
+            if constexpr (bitwise_comparable<T>::value)
+                return count == 0 || std::memcmp(lhs, rhs, count * sizeof(T)) == 0;
+            else
+                return mismatch(lhs, rhs, count) == count;
+        }
+        
+        /********************************************************
+         * Лексикографическое сравнение двух массивов
+         ********************************************************
+         * Для арифметических и побайтово сравнимых элементов
+         * пропускает совпадающие участки через mismatch и
+         * сравнивает первый различающийся элемент. Несравнимые
+         * элементы (NaN) пропускаются, как в
+         * std::lexicographical_compare. Остальные типы
+         * сравниваются только через operator <
+         ********************************************************
+         * \param lhs 1-й массив
+         * \param lhs_count Число элементов в lhs
+         * \param rhs 2-й массив
+         * \param rhs_count Число элементов в rhs
+         * \return True - если lhs меньше rhs
+         */
+        
+        template<class T>
+        inline bool less(const T* lhs, std::size_t lhs_count, const T* rhs, std::size_t rhs_count) {
+            const std::size_t count = lhs_count < rhs_count ? lhs_count : rhs_count;
+            if constexpr (std::is_same<T, unsigned char>::value || std::is_same<T, std::byte>::value ||
+                          (std::is_same<T, char>::value && std::is_unsigned<char>::value)) {
+                const int result = count == 0 ? 0 : std::memcmp(lhs, rhs, count);
+                if (result != 0)
+                    return result < 0;
+                return lhs_count < rhs_count;
+            }
+            else if constexpr (bitwise_comparable<T>::value || std::is_arithmetic<T>::value) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    i += mismatch(lhs + i, rhs + i, count - i);
+                    if (i == count)
+                        break;
+                    if (lhs[i] < rhs[i])
+                        return true;
+                    if (rhs[i] < lhs[i])
+                        return false;
+                }
+                return lhs_count < rhs_count;
+            }
+            else {
+                for (std::size_t i = 0; i < count; ++i) {
+                    if (lhs[i] < rhs[i])
+                        return true;
+                    if (rhs[i] < lhs[i])
+                        return false;
+                }
+                return lhs_count < rhs_count;
+            }
+        }
+    }
+}
@@ -0,0 +1,597 @@
+/********************************************************
+ * \file
+ * \brief Заголовочный файл с описанием контейнера 'concurrent_vector'
+ ********************************************************
+ * Файл содержит в себе реализацию вектора с параллельным
+ * добавлением элементов 'concurrent_vector'
+ */
+
+#pragma once
+
+#include "segmented_iterator.h"
+#include "vector.h"
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+
+namespace pva {
+    
+    /********************************************************
+     * \brief Класс - вектор с параллельным добавлением
+     ********************************************************
+     * Элементы хранятся в сегментах, сегмент k вмещает
+     * first_segment * 2^k элементов. Сегменты не
+     * перевыделяются, поэтому элементы никогда не переносятся
+     * и ссылки на них действительны до clear() или
+     * уничтожения вектора. push_back, emplace_back и grow_by
+     * можно вызывать из нескольких потоков одновременно:
+     * место под элементы резервируется атомарным счетчиком,
+     * а сегмент выделяет первый дошедший до него поток.
+     * Одновременно с добавлением безопасно читать элементы,
+     * о создании которых поток знает (по итератору,
+     * возвращенному из push_back, или после синхронизации с
+     * добавившим потоком): size() учитывает и элементы,
+     * которые еще создаются. clear(), swap() и присваивания
+     * потокобезопасными не являются
+     */
+    
+    template<class T, class Allocator = malloc_allocator<T>>
+    class concurrent_vector : private detail::allocator_holder<Allocator> {
+        typedef detail::allocator_holder<Allocator> holder;
+        typedef std::allocator_traits<Allocator> alloc_traits;
+    
+    public:
+        typedef T value_type;
+        typedef Allocator allocator_type;
+        typedef std::size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef segmented_iterator<concurrent_vector, T> iterator;
+        typedef segmented_iterator<const concurrent_vector, const T> const_iterator;
+        
+        static constexpr std::size_t first_segment = 16; /*< Размер первого сегмента (степень двойки)*/
+        
+        /**********************************************
+         * Конструктор по умолчанию
+         */
+        
+        concurrent_vector()
+        :concurrent_vector(Allocator()) {}
+        
+        /**********************************************
+         * Конструктор с аллокатором
+         **********************************************
+         * \param allocator Аллокатор вектора
+         */
+        
+        explicit concurrent_vector(const Allocator &allocator)
+        :holder(allocator), size_(0) {
+            for (std::size_t k = 0; k < segments; ++k)
+                segments_[k].store(nullptr, std::memory_order_relaxed);
+        }
+        
+        /**********************************************
+         * Конструктор копирования
+         **********************************************
+         * Копируемый вектор не должен меняться во время
+         * копирования
+         */
+        
+        concurrent_vector(const concurrent_vector &copy)
+        :concurrent_vector(alloc_traits::select_on_container_copy_construction(copy.alloc())) {
+            try {
+                append_elements(copy);
+            }
+            catch (...) {
+                clear();
+                throw;
+            }
+        }
+        
+        /**********************************************
+         * Конструктор перемещения
+         **********************************************
+         * Забирает сегменты copy
+         */
+        
+        concurrent_vector(concurrent_vector &&copy) noexcept
+        :holder(pva::move(copy.alloc())), size_(copy.size_.load(std::memory_order_relaxed)),
+         broken_(pva::move(copy.broken_)) {
+            for (std::size_t k = 0; k < segments; ++k)
+                segments_[k].store(copy.segments_[k].exchange(nullptr, std::memory_order_relaxed),
+                                   std::memory_order_relaxed);
+            copy.size_.store(0, std::memory_order_relaxed);
+        }
+        
+        /**********************************************
+         * Деструктор
+         */
+        
+        ~concurrent_vector() {
+            clear();
+        }
+        
+        /********************************************************
+         * Перегруженный оператор присваивания
+         ********************************************************
+         * Элементы копируются в сегменты своего аллокатора
+         * (аллокатор copy передается, только если это требует
+         * propagate_on_container_copy_assignment)
+         */
+        
+        concurrent_vector& operator =(const concurrent_vector &copy) {
+            if (&copy != this) {
+                clear();
+                if constexpr (alloc_traits::propagate_on_container_copy_assignment::value)
+                    this->alloc() = copy.alloc();
+                append_elements(copy);
+            }
+            return *this;
+        }
+        
+        /********************************************************
+         * Перегруженный оператор присваивания через rvalue - ссылки
+         ********************************************************
+         * Забирает сегменты copy. Если аллокаторы не равны и
+         * не передаются при перемещении, сегменты copy
+         * выделены чужим аллокатором: элементы перемещаются по
+         * одному в сегменты своего
+         */
+        
+        concurrent_vector& operator =(concurrent_vector &&copy)
+        noexcept(alloc_traits::propagate_on_container_move_assignment::value ||
+                 alloc_traits::is_always_equal::value) {
+            if (&copy == this)
+                return *this;
+            clear();
+            if constexpr (!alloc_traits::propagate_on_container_move_assignment::value) {
+                if (this->alloc() != copy.alloc()) {
+                    append_elements(copy);
+                    copy.clear();
+                    return *this;
+                }
+            }
+            else
+                this->alloc() = pva::move(copy.alloc());
+            for (std::size_t k = 0; k < segments; ++k)
+                segments_[k].store(copy.segments_[k].exchange(nullptr, std::memory_order_relaxed),
+                                   std::memory_order_relaxed);
+            size_.store(copy.size_.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+            broken_ = pva::move(copy.broken_);
+            copy.broken_.clear();
+            return *this;
+        }
+        
+        /********************************************************
+         * Добавление элемента в конец вектора
+         ********************************************************
+         * Потокобезопасно
+         ********************************************************
+         * \param value Значение элемента
+         * \return Итератор на добавленный элемент
+         */
+        
+        iterator push_back(const T &value) {
+            return emplace_back(value);
+        }
+        
+        /********************************************************
+         * Добавление элемента в конец вектора через rvalue - ссылки
+         ********************************************************
+         * Потокобезопасно
+         */
+        
+        iterator push_back(T &&value) {
+            return emplace_back(pva::move(value));
+        }
+        
+        /********************************************************
+         * Создание элемента в конце вектора
+         ********************************************************
+         * Потокобезопасно. Если конструктор бросит исключение,
+         * зарезервированная позиция останется пустой: обращаться
+         * к ней нельзя
+         ********************************************************
+         * \param args Аргументы конструктора элемента
+         * \return Итератор на созданный элемент
+         */
+        
+        template<class... Args>
+        iterator emplace_back(Args&&... args) {
+            const std::size_t index = size_.fetch_add(1, std::memory_order_relaxed);
+            try {
+                alloc_traits::construct(this->alloc(), slot(index), pva::forward<Args>(args)...);
+            }
+            catch (...) {
+                mark_broken(index, index + 1);
+                throw;
+            }
+            return iterator(this, index);
+        }
+        
+        /********************************************************
+         * Добавление count элементов, созданных по умолчанию
+         ********************************************************
+         * Потокобезопасно: элементы добавляются одним блоком
+         ********************************************************
+         * \param count Число элементов
+         * \return Итератор на первый добавленный элемент
+         */
+        
+        iterator grow_by(const std::size_t &count) {
+            return grow(count, [](T* place, Allocator &allocator) {
+                alloc_traits::construct(allocator, place);
+            });
+        }
+        
+        /********************************************************
+         * Добавление count копий value
+         ********************************************************
+         * Потокобезопасно: элементы добавляются одним блоком
+         ********************************************************
+         * \param count Число элементов
+         * \param value Значение элементов
+         * \return Итератор на первый добавленный элемент
+         */
+        
+        iterator grow_by(const std::size_t &count, const T &value) {
+            return grow(count, [&value](T* place, Allocator &allocator) {
+                alloc_traits::construct(allocator, place, value);
+            });
+        }
+        
+        /********************************************************
+         * Выделение сегментов под capacity элементов
+         ********************************************************
+         * \param capacity Требуемая емкость
+         */
+        
+        void reserve(const std::size_t &capacity) {
+            if (capacity == 0)
+                return;
+            const std::size_t last = segment_of(capacity - 1);
+            for (std::size_t k = 0; k <= last; ++k)
+                segment(k);
+        }
+        
+        /********************************************************
+         * Число элементов в векторе
+         ********************************************************
+         * Включает элементы, которые еще создаются другими
+         * потоками
+         */
+        
+        std::size_t size() const noexcept {
+            return size_.load(std::memory_order_acquire);
+        }
+        
+        /********************************************************
+         * Проверка на пустоту
+         */
+        
+        bool empty() const noexcept {
+            return size() == 0;
+        }
+        
+        /********************************************************
+         * Число элементов в выделенных сегментах
+         */
+        
+        std::size_t capacity() const noexcept {
+            std::size_t k = 0;
+            while (k < segments && segments_[k].load(std::memory_order_acquire))
+                ++k;
+            return segment_start(k);
+        }
+        
+        /********************************************************
+         * Удаление всех элементов и освобождение сегментов
+         ********************************************************
+         * Не потокобезопасно
+         */
+        
+        void clear() {
+            const std::size_t count = size_.load(std::memory_order_relaxed);
+            std::size_t next_broken = 0;
+            for (std::size_t i = 0; i < count; ++i) {
+                if (next_broken < broken_.size() && broken_[next_broken] == i) {
+                    ++next_broken;
+                    continue;
+                }
+                alloc_traits::destroy(this->alloc(), slot_pointer(i));
+            }
+            for (std::size_t k = 0; k < segments; ++k) {
+                if (T* data = segments_[k].exchange(nullptr, std::memory_order_relaxed))
+                    alloc_traits::deallocate(this->alloc(), data, segment_size(k));
+            }
+            size_.store(0, std::memory_order_relaxed);
+            broken_.clear();
+        }
+        
+        /********************************************************
+         * Перегруженный оператор [] (обращение к элементу вектора)
+         ********************************************************
+         * \param index Индекс элемента
+         * \return Ссылку на элемент вектора по индексу
+         */
+        
+        T& operator [](const std::size_t &index) {
+            PVA_ASSERT(index < size(), "Index more than size of vector!");
+            return *slot_pointer(index);
+        }
+        
+        const T& operator [](const std::size_t &index) const {
+            PVA_ASSERT(index < size(), "Index more than size of vector!");
+            return *slot_pointer(index);
+        }
+        
+        /********************************************************
+         * Обращение к элементу вектора с проверкой индекса
+         ********************************************************
+         * \param index Индекс элемента
+         * \return Ссылку на элемент вектора по индексу
+         */
+        
+        T& at(const std::size_t &index) {
+            if (index >= size())
+                throw std::out_of_range("Index more than size of vector!");
+            return *slot_pointer(index);
+        }
+        
+        const T& at(const std::size_t &index) const {
+            if (index >= size())
+                throw std::out_of_range("Index more than size of vector!");
+            return *slot_pointer(index);
+        }
+        
+        T& front() {
+            return (*this)[0];
+        }
+        
+        const T& front() const {
+            return (*this)[0];
+        }
+        
+        T& back() {
+            return (*this)[size() - 1];
+        }
+        
+        const T& back() const {
+            return (*this)[size() - 1];
+        }
+        
+        iterator begin() {
+            return iterator(this, 0);
+        }
+        
+        iterator end() {
+            return iterator(this, size());
+        }
+        
+        const_iterator begin() const {
+            return const_iterator(this, 0);
+        }
+        
+        const_iterator end() const {
+            return const_iterator(this, size());
+        }
+        
+        const_iterator cbegin() const {
+            return begin();
+        }
+        
+        const_iterator cend() const {
+            return end();
+        }
+        
+        /********************************************************
+         * Обмен содержимого с другим вектором
+         ********************************************************
+         * Не потокобезопасно
+         */
+        
+        void swap(concurrent_vector &other) noexcept {
+            if constexpr (alloc_traits::propagate_on_container_swap::value) {
+                using std::swap;
+                swap(this->alloc(), other.alloc());
+            }
+            for (std::size_t k = 0; k < segments; ++k) {
+                T* mine = segments_[k].load(std::memory_order_relaxed);
+                segments_[k].store(other.segments_[k].load(std::memory_order_relaxed), std::memory_order_relaxed);
+                other.segments_[k].store(mine, std::memory_order_relaxed);
+            }
+            const std::size_t size = size_.load(std::memory_order_relaxed);
+            size_.store(other.size_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            other.size_.store(size, std::memory_order_relaxed);
+            broken_.swap(other.broken_);
+        }
+        
+        /********************************************************
+         * Получение копии аллокатора вектора
+         */
+        
+        allocator_type get_allocator() const {
+            return this->alloc();
+        }
+    
+    private:
+        static constexpr std::size_t first_bits = 4; /*< log2(first_segment)*/
+        static constexpr std::size_t segments = std::numeric_limits<std::size_t>::digits - first_bits; /*< Максимальное число сегментов*/
+        
+        static_assert(first_segment == (std::size_t(1) << first_bits), "first_segment must be 2^first_bits");
+        
+        /********************************************************
+         * Номер старшего установленного бита
+         */
+        
+        static std::size_t highest_bit(std::size_t value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+            return std::numeric_limits<unsigned long long>::digits - 1 -
+                   static_cast<std::size_t>(__builtin_clzll(value));
+#else
+            std::size_t bit = 0;
+            while (value >>= 1)
+                ++bit;
+            return bit;
+#endif
+        }
+        
+        /********************************************************
+         * Номер сегмента, в котором лежит элемент index
+         */
+        
+        static std::size_t segment_of(std::size_t index) noexcept {
+            return highest_bit(index + first_segment) - first_bits;
+        }
+        
+        /********************************************************
+         * Индекс первого элемента сегмента k
+         */
+        
+        static std::size_t segment_start(std::size_t k) noexcept {
+            return (first_segment << k) - first_segment;
+        }
+        
+        /********************************************************
+         * Число элементов в сегменте k
+         */
+        
+        static std::size_t segment_size(std::size_t k) noexcept {
+            return first_segment << k;
+        }
+        
+        /********************************************************
+         * Сегмент k (выделяется, если его еще нет)
+         ********************************************************
+         * Если сегмент выделяют несколько потоков сразу,
+         * остается сегмент первого, остальные освобождаются
+         */
+        
+        T* segment(std::size_t k) {
+            if (k >= segments)
+                throw std::length_error("Length of concurrent_vector is too large!");
+            T* data = segments_[k].load(std::memory_order_acquire);
+            if (data)
+                return data;
+            T* fresh = alloc_traits::allocate(this->alloc(), segment_size(k));
+            if (segments_[k].compare_exchange_strong(data, fresh, std::memory_order_acq_rel,
+                                                     std::memory_order_acquire))
+                return fresh;
+            alloc_traits::deallocate(this->alloc(), fresh, segment_size(k));
+            return data;
+        }
+        
+        /********************************************************
+         * Место под элемент index (сегмент выделяется)
+         */
+        
+        T* slot(std::size_t index) {
+            const std::size_t k = segment_of(index);
+            return segment(k) + (index - segment_start(k));
+        }
+        
+        /********************************************************
+         * Указатель на элемент index в уже выделенном сегменте
+         */
+        
+        T* slot_pointer(std::size_t index) const noexcept {
+            const std::size_t k = segment_of(index);
+            return segments_[k].load(std::memory_order_acquire) + (index - segment_start(k));
+        }
+        
+        /********************************************************
+         * Резервирование и создание count элементов
+         ********************************************************
+         * \param count Число элементов
+         * \param create Создание элемента на месте
+         * \return Итератор на первый элемент
+         */
+        
+        template<class Create>
+        iterator grow(std::size_t count, Create create) {
+            const std::size_t first = size_.fetch_add(count, std::memory_order_relaxed);
+            std::size_t index = first;
+            try {
+                for (; index < first + count; ++index)
+                    create(slot(index), this->alloc());
+            }
+            catch (...) {
+                for (std::size_t i = first; i < index; ++i)
+                    alloc_traits::destroy(this->alloc(), slot_pointer(i));
+                mark_broken(first, first + count);
+                throw;
+            }
+            return iterator(this, first);
+        }
+        
+        /********************************************************
+         * Добавление элементов source в конец вектора
+         ********************************************************
+         * Индексы сохраняются: позиции source без элементов
+         * остаются пустыми и здесь. Элементы неконстантного
+         * source перемещаются
+         */
+        
+        template<class Source>
+        void append_elements(Source &source) {
+            const std::size_t count = source.size_.load(std::memory_order_relaxed);
+            std::size_t next_broken = 0;
+            for (std::size_t i = 0; i < count; ++i) {
+                if (next_broken < source.broken_.size() && source.broken_[next_broken] == i) {
+                    ++next_broken;
+                    const std::size_t index = size_.fetch_add(1, std::memory_order_relaxed);
+                    mark_broken(index, index + 1);
+                    continue;
+                }
+                if constexpr (std::is_const<Source>::value)
+                    emplace_back(source[i]);
+                else
+                    emplace_back(pva::move(source[i]));
+            }
+        }
+        
+        /********************************************************
+         * Запоминание позиций [first, last), в которых не
+         * удалось создать элементы
+         ********************************************************
+         * clear() не разрушает их
+         */
+        
+        void mark_broken(std::size_t first, std::size_t last) noexcept {
+            std::lock_guard<std::mutex> lock(broken_mutex_);
+            try {
+                for (std::size_t i = first; i < last; ++i) {
+                    std::size_t position = broken_.size();
+                    while (position > 0 && broken_[position - 1] > i)
+                        --position;
+                    broken_.insert(broken_.cbegin() + position, i);
+                }
+            }
+            catch (...) {
+                std::terminate();
+            }
+        }
+        
+        std::atomic<T*> segments_[segments]; /*< Сегменты с элементами*/
+        std::atomic<std::size_t> size_; /*< Число зарезервированных позиций*/
+        std::mutex broken_mutex_; /*< Защищает broken_*/
+        vector<std::size_t> broken_; /*< Отсортированные позиции без элементов*/
+    };
+    
+    /********************************************************
+     * Функция замены двух векторов
+     */
+    
+    template<class T, class Allocator>
+    inline void swap(concurrent_vector<T, Allocator> &lhs, concurrent_vector<T, Allocator> &rhs) noexcept {
+        lhs.swap(rhs);
+    }
+}
@@ -0,0 +1,629 @@
+/********************************************************
+ * \file
+ * \brief Заголовочный файл с описанием контейнера 'flat_map'
+ ********************************************************
+ * Файл содержит в себе ассоциативный массив с ключами и
+ * значениями в двух упорядоченных непрерывных столбцах
+ * 'flat_map' и его итератор 'flat_map_iterator'
+ */
+
+#pragma once
+
+#include "sorted_vector.h"
+#include "span.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace pva {
+    
+    /********************************************************
+     * \brief Итератор flat_map
+     ********************************************************
+     * Хранит указатели на ключ и значение одной пары,
+     * которые сдвигаются вместе. Разыменование дает
+     * прокси-ссылку std::pair<const Key&, Value&>
+     */
+    
+    template<class Key, class Value>
+    class flat_map_iterator {
+        template<class, class>
+        friend class flat_map_iterator;
+    
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef std::pair<Key, typename std::remove_const<Value>::type> value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef std::pair<const Key&, Value&> reference;
+        
+        /********************************************************
+         * \brief Указатель для operator ->: хранит прокси-ссылку
+         */
+        
+        struct pointer {
+            reference ref; /*< Пара ссылок*/
+            
+            const reference* operator ->() const noexcept {
+                return &ref;
+            }
+        };
+        
+        /**********************************************
+         * Конструктор по умолчанию
+         */
+        
+        flat_map_iterator() noexcept
+        :key_(nullptr), value_(nullptr) {}
+        
+        /**********************************************
+         * Конструктор итератора на пару
+         **********************************************
+         * \param key Ключ
+         * \param value Значение
+         */
+        
+        flat_map_iterator(const Key* key, Value* value) noexcept
+        :key_(key), value_(value) {}
+        
+        /**********************************************
+         * Преобразование итератора в константный
+         */
+        
+        template<class OtherValue, class = typename std::enable_if<std::is_same<const OtherValue, Value>::value>::type>
+        flat_map_iterator(const flat_map_iterator<Key, OtherValue> &copy) noexcept
+        :key_(copy.key_), value_(copy.value_) {}
+        
+        reference operator *() const noexcept {
+            return reference(*key_, *value_);
+        }
+        
+        pointer operator ->() const noexcept {
+            return pointer{reference(*key_, *value_)};
+        }
+        
+        reference operator [](const difference_type &size) const noexcept {
+            return reference(key_[size], value_[size]);
+        }
+        
+        const Key& key() const noexcept {
+            return *key_;
+        }
+        
+        Value& value() const noexcept {
+            return *value_;
+        }
+        
+        flat_map_iterator& operator ++() noexcept {
+            ++key_;
+            ++value_;
+            return *this;
+        }
+        
+        flat_map_iterator operator ++(int) noexcept {
+            flat_map_iterator old(*this);
+            ++*this;
+            return old;
+        }
+        
+        flat_map_iterator& operator --() noexcept {
+            --key_;
+            --value_;
+            return *this;
+        }
+        
+        flat_map_iterator operator --(int) noexcept {
+            flat_map_iterator old(*this);
+            --*this;
+            return old;
+        }
+        
+        flat_map_iterator& operator +=(const difference_type &size) noexcept {
+            key_ += size;
+            value_ += size;
+            return *this;
+        }
+        
+        flat_map_iterator operator +(const difference_type &size) const noexcept {
+            return flat_map_iterator(key_ + size, value_ + size);
+        }
+        
+        flat_map_iterator& operator -=(const difference_type &size) noexcept {
+            key_ -= size;
+            value_ -= size;
+            return *this;
+        }
+        
+        flat_map_iterator operator -(const difference_type &size) const noexcept {
+            return flat_map_iterator(key_ - size, value_ - size);
+        }
+        
+        const Key* key_base() const noexcept {
+            return key_;
+        }
+    
+    private:
+        const Key* key_; /*< Ключ пары*/
+        Value* value_; /*< Значение пары*/
+    };
+    
+    template<class Key, class Value>
+    inline flat_map_iterator<Key, Value> operator +(const std::ptrdiff_t &size, const flat_map_iterator<Key, Value> &it)
+    noexcept {
+        return it + size;
+    }
+    
+    /********************************************************
+     * Операторы сравнения и разность итераторов flat_map
+     ********************************************************
+     * Сравниваются указатели на ключи, константный итератор
+     * можно сравнивать с изменяемым
+     */
+    
+    template<class Key, class V1, class V2>
+    inline std::ptrdiff_t operator -(const flat_map_iterator<Key, V1> &lhs, const flat_map_iterator<Key, V2> &rhs)
+    noexcept {
+        return lhs.key_base() - rhs.key_base();
+    }
+    
+    template<class Key, class V1, class V2>
+    inline bool operator ==(const flat_map_iterator<Key, V1> &lhs, const flat_map_iterator<Key, V2> &rhs) noexcept {
+        return lhs.key_base() == rhs.key_base();
+    }
+    
+    template<class Key, class V1, class V2>
+    inline bool operator !=(const flat_map_iterator<Key, V1> &lhs, const flat_map_iterator<Key, V2> &rhs) noexcept {
+        return lhs.key_base() != rhs.key_base();
+    }
+    
+    template<class Key, class V1, class V2>
+    inline bool operator <(const flat_map_iterator<Key, V1> &lhs, const flat_map_iterator<Key, V2> &rhs) noexcept {
+        return lhs.key_base() < rhs.key_base();
+    }
+    
+    template<class Key, class V1, class V2>
+    inline bool operator >(const flat_map_iterator<Key, V1> &lhs, const flat_map_iterator<Key, V2> &rhs) noexcept {
+        return lhs.key_base() > rhs.key_base();
+    }
+    
+    template<class Key, class V1, class V2>
+    inline bool operator <=(const flat_map_iterator<Key, V1> &lhs, const flat_map_iterator<Key, V2> &rhs) noexcept {
+        return lhs.key_base() <= rhs.key_base();
+    }
+    
+    template<class Key, class V1, class V2>
+    inline bool operator >=(const flat_map_iterator<Key, V1> &lhs, const flat_map_iterator<Key, V2> &rhs) noexcept {
+        return lhs.key_base() >= rhs.key_base();
+    }
+    
+    /********************************************************
+     * \brief Ассоциативный массив в непрерывных столбцах
+     ********************************************************
+     * Ключи лежат по возрастанию в KeyContainer, значения -
+     * в ValueContainer под теми же индексами. Поиск -
+     * бинарный без ветвлений только по столбцу ключей, так
+     * что в кэш не попадают значения. Вставка и удаление
+     * одной пары - O(n) сдвигом, insert_range вставляет
+     * пакет за один линейный проход. Итераторы и ссылки
+     * становятся недействительными после вставки и удаления
+     */
+    
+    template<class Key, class Value, class Compare = std::less<Key>, class KeyContainer = vector<Key>,
+             class ValueContainer = vector<Value>>
+    class flat_map {
+    public:
+        typedef Key key_type;
+        typedef Value mapped_type;
+        typedef std::pair<Key, Value> value_type;
+        typedef Compare key_compare;
+        typedef KeyContainer key_container_type;
+        typedef ValueContainer mapped_container_type;
+        typedef std::size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef std::pair<const Key&, Value&> reference;
+        typedef std::pair<const Key&, const Value&> const_reference;
+        typedef flat_map_iterator<Key, Value> iterator;
+        typedef flat_map_iterator<Key, const Value> const_iterator;
+        
+        /**********************************************
+         * Конструктор пустого массива
+         */
+        
+        flat_map() {}
+        
+        explicit flat_map(const Compare &comp)
+        :compare_(comp) {}
+        
+        /**********************************************
+         * Конструктор массива из пар [first, last)
+         **********************************************
+         * Для повторяющихся ключей остается первая пара
+         */
+        
+        template<class InputIt, class = typename std::enable_if<detail::is_iterator<InputIt>::value>::type>
+        flat_map(InputIt first, InputIt last, const Compare &comp = Compare())
+        :compare_(comp) {
+            insert_range(first, last);
+        }
+        
+        flat_map(std::initializer_list<value_type> values, const Compare &comp = Compare())
+        :flat_map(values.begin(), values.end(), comp) {}
+        
+        std::size_t size() const noexcept {
+            return keys_.size();
+        }
+        
+        bool empty() const noexcept {
+            return keys_.empty();
+        }
+        
+        void reserve(const std::size_t &size) {
+            keys_.reserve(size);
+            values_.reserve(size);
+        }
+        
+        void shrink_to_fit() {
+            keys_.shrink_to_fit();
+            values_.shrink_to_fit();
+        }
+        
+        /********************************************************
+         * Удаление всех пар (память остается за массивом)
+         */
+        
+        void clear() noexcept {
+            keys_.clear();
+            values_.clear();
+        }
+        
+        /********************************************************
+         * Доступ к значению по ключу, при отсутствии ключа
+         * вставляется значение по умолчанию
+         */
+        
+        Value& operator [](const Key &key) {
+            return try_emplace(key).first.value();
+        }
+        
+        Value& operator [](Key &&key) {
+            return try_emplace(pva::move(key)).first.value();
+        }
+        
+        /********************************************************
+         * Доступ к значению по ключу с проверкой
+         ********************************************************
+         * \param key Ключ
+         * \return Ссылку на значение
+         */
+        
+        Value& at(const Key &key) {
+            const std::size_t index = index_of(key);
+            if (index == keys_.size())
+                throw std::out_of_range("Key is not in flat_map!");
+            return values_[index];
+        }
+        
+        const Value& at(const Key &key) const {
+            const std::size_t index = index_of(key);
+            if (index == keys_.size())
+                throw std::out_of_range("Key is not in flat_map!");
+            return values_[index];
+        }
+        
+        /********************************************************
+         * Вставка пары, если ключа еще нет
+         ********************************************************
+         * \param key Ключ
+         * \param args Аргументы конструктора значения
+         * \return Итератор на пару с ключом key и признак
+         * того, что она вставлена (false - ключ уже был)
+         */
+        
+        template<class... Args>
+        std::pair<iterator, bool> try_emplace(const Key &key, Args&&... args) {
+            return emplace_key(key, pva::forward<Args>(args)...);
+        }
+        
+        template<class... Args>
+        std::pair<iterator, bool> try_emplace(Key &&key, Args&&... args) {
+            return emplace_key(pva::move(key), pva::forward<Args>(args)...);
+        }
+        
+        std::pair<iterator, bool> insert(const value_type &value) {
+            return emplace_key(value.first, value.second);
+        }
+        
+        std::pair<iterator, bool> insert(value_type &&value) {
+            return emplace_key(pva::move(value.first), pva::move(value.second));
+        }
+        
+        /********************************************************
+         * Вставка пары или замена значения существующего ключа
+         ********************************************************
+         * \return Итератор на пару и признак вставки
+         */
+        
+        template<class V>
+        std::pair<iterator, bool> insert_or_assign(const Key &key, V &&value) {
+            const std::size_t index = lower_index(key);
+            if (index != keys_.size() && !compare_(key, keys_[index])) {
+                values_[index] = pva::forward<V>(value);
+                return std::pair<iterator, bool>(make_iterator(index), false);
+            }
+            return std::pair<iterator, bool>(insert_at(index, key, pva::forward<V>(value)), true);
+        }
+        
+        /********************************************************
+         * Вставка пакета пар [first, last)
+         ********************************************************
+         * Пакет копируется и сортируется по ключам, повторы в
+         * пакете и ключи, уже бывшие в массиве, отбрасываются,
+         * после чего оба упорядоченных набора сливаются в
+         * новые столбцы за один линейный проход. Итого
+         * O(n + k log k) вместо O(n * k) для k вставок по
+         * одной. Для повторяющихся ключей остается первая
+         * пара. Если исключение брошено до слияния, массив
+         * остается прежним
+         ********************************************************
+         * \param first Начало пакета
+         * \param last Конец пакета
+         */
+        
+        template<class InputIt, class = typename std::enable_if<detail::is_iterator<InputIt>::value>::type>
+        void insert_range(InputIt first, InputIt last) {
+            vector<value_type> batch(first, last);
+            if (batch.empty())
+                return;
+            auto by_key = [this](const value_type &lhs, const value_type &rhs) {
+                return compare_(lhs.first, rhs.first);
+            };
+            if (!std::is_sorted(batch.begin(), batch.end(), by_key))
+                std::stable_sort(batch.begin(), batch.end(), by_key);
+            const Key* const keys = keys_.data();
+            const std::size_t count = keys_.size();
+            const Key* old = keys;
+            value_type* const begin = batch.data();
+            value_type* out = begin;
+            for (value_type* it = begin; it != begin + batch.size(); ++it) {
+                if (out != begin && !compare_(out[-1].first, it->first))
+                    continue;
+                old = detail::branchless_lower_bound(old, std::size_t(keys + count - old), it->first, compare_);
+                if (old != keys + count && !compare_(it->first, *old))
+                    continue;
+                if (out != it)
+                    *out = pva::move(*it);
+                ++out;
+            }
+            const std::size_t fresh = std::size_t(out - begin);
+            if (fresh == 0)
+                return;
+            KeyContainer keys_merged;
+            ValueContainer values_merged;
+            keys_merged.reserve(count + fresh);
+            values_merged.reserve(count + fresh);
+            std::size_t i = 0;
+            for (value_type* it = begin; it != out; ++it) {
+                for (; i < count && compare_(keys_[i], it->first); ++i) {
+                    keys_merged.push_back(pva::move(keys_[i]));
+                    values_merged.push_back(pva::move(values_[i]));
+                }
+                keys_merged.push_back(pva::move(it->first));
+                values_merged.push_back(pva::move(it->second));
+            }
+            for (; i < count; ++i) {
+                keys_merged.push_back(pva::move(keys_[i]));
+                values_merged.push_back(pva::move(values_[i]));
+            }
+            keys_.swap(keys_merged);
+            values_.swap(values_merged);
+        }
+        
+        template<class Range, class = decltype(std::begin(std::declval<const Range&>()))>
+        void insert_range(const Range &values) {
+            insert_range(std::begin(values), std::end(values));
+        }
+        
+        /********************************************************
+         * Удаление пары по итератору
+         ********************************************************
+         * \return Итератор на следующую пару
+         */
+        
+        iterator erase(const_iterator pos) {
+            const std::size_t index = std::size_t(pos.key_base() - keys_.data());
+            keys_.erase(keys_.cbegin() + index);
+            values_.erase(values_.cbegin() + index);
+            return make_iterator(index);
+        }
+        
+        /********************************************************
+         * Удаление пары с ключом key
+         ********************************************************
+         * \return Число удаленных пар (0 или 1)
+         */
+        
+        std::size_t erase(const Key &key) {
+            const std::size_t index = index_of(key);
+            if (index == keys_.size())
+                return 0;
+            keys_.erase(keys_.cbegin() + index);
+            values_.erase(values_.cbegin() + index);
+            return 1;
+        }
+        
+        /********************************************************
+         * Поиск пары с ключом key
+         ********************************************************
+         * \return Итератор на пару или end()
+         */
+        
+        iterator find(const Key &key) {
+            return make_iterator(index_of(key));
+        }
+        
+        const_iterator find(const Key &key) const {
+            return make_iterator(index_of(key));
+        }
+        
+        bool contains(const Key &key) const {
+            return index_of(key) != keys_.size();
+        }
+        
+        std::size_t count(const Key &key) const {
+            return contains(key) ? 1 : 0;
+        }
+        
+        iterator lower_bound(const Key &key) {
+            return make_iterator(lower_index(key));
+        }
+        
+        const_iterator lower_bound(const Key &key) const {
+            return make_iterator(lower_index(key));
+        }
+        
+        iterator upper_bound(const Key &key) {
+            return make_iterator(upper_index(key));
+        }
+        
+        const_iterator upper_bound(const Key &key) const {
+            return make_iterator(upper_index(key));
+        }
+        
+        /********************************************************
+         * Столбец ключей по возрастанию
+         */
+        
+        span<const Key> keys() const noexcept {
+            return span<const Key>(keys_.data(), keys_.size());
+        }
+        
+        /********************************************************
+         * Столбец значений (в порядке ключей)
+         */
+        
+        span<Value> values() noexcept {
+            return span<Value>(values_.data(), values_.size());
+        }
+        
+        span<const Value> values() const noexcept {
+            return span<const Value>(values_.data(), values_.size());
+        }
+        
+        iterator begin() noexcept {
+            return make_iterator(0);
+        }
+        
+        const_iterator begin() const noexcept {
+            return make_iterator(0);
+        }
+        
+        const_iterator cbegin() const noexcept {
+            return make_iterator(0);
+        }
+        
+        iterator end() noexcept {
+            return make_iterator(keys_.size());
+        }
+        
+        const_iterator end() const noexcept {
+            return make_iterator(keys_.size());
+        }
+        
+        const_iterator cend() const noexcept {
+            return make_iterator(keys_.size());
+        }
+        
+        key_compare key_comp() const {
+            return compare_;
+        }
+        
+        void swap(flat_map &other) noexcept {
+            keys_.swap(other.keys_);
+            values_.swap(other.values_);
+            std::swap(compare_, other.compare_);
+        }
+        
+        bool operator ==(const flat_map &other) const {
+            return keys_ == other.keys_ && values_ == other.values_;
+        }
+        
+        bool operator !=(const flat_map &other) const {
+            return !(*this == other);
+        }
+    
+    private:
+        iterator make_iterator(const std::size_t &index) noexcept {
+            return iterator(keys_.data() + index, values_.data() + index);
+        }
+        
+        const_iterator make_iterator(const std::size_t &index) const noexcept {
+            return const_iterator(keys_.data() + index, values_.data() + index);
+        }
+        
+        std::size_t lower_index(const Key &key) const {
+            return std::size_t(detail::branchless_lower_bound(keys_.data(), keys_.size(), key, compare_) -
+                               keys_.data());
+        }
+        
+        std::size_t upper_index(const Key &key) const {
+            return std::size_t(detail::branchless_upper_bound(keys_.data(), keys_.size(), key, compare_) -
+                               keys_.data());
+        }
+        
+        /********************************************************
+         * Индекс ключа key или size(), если ключа нет
+         */
+        
+        std::size_t index_of(const Key &key) const {
+            const std::size_t index = lower_index(key);
+            if (index == keys_.size() || compare_(key, keys_[index]))
+                return keys_.size();
+            return index;
+        }
+        
+        /********************************************************
+         * Вставка пары перед индексом index
+         ********************************************************
+         * Если конструктор значения бросит исключение,
+         * вставленный ключ удаляется
+         */
+        
+        template<class K, class... Args>
+        iterator insert_at(const std::size_t &index, K &&key, Args&&... args) {
+            keys_.emplace(keys_.cbegin() + index, pva::forward<K>(key));
+            try {
+                values_.emplace(values_.cbegin() + index, pva::forward<Args>(args)...);
+            }
+            catch (...) {
+                keys_.erase(keys_.cbegin() + index);
+                throw;
+            }
+            return make_iterator(index);
+        }
+        
+        template<class K, class... Args>
+        std::pair<iterator, bool> emplace_key(K &&key, Args&&... args) {
+            const std::size_t index = lower_index(key);
+            if (index != keys_.size() && !compare_(key, keys_[index]))
+                return std::pair<iterator, bool>(make_iterator(index), false);
+            return std::pair<iterator, bool>(insert_at(index, pva::forward<K>(key), pva::forward<Args>(args)...),
+                                             true);
+        }
+        
+        KeyContainer keys_; /*< Ключи по возрастанию*/
+        ValueContainer values_; /*< Значения под индексами ключей*/
+        mutable Compare compare_; /*< Сравнение ключей*/
+    };
+    
+    template<class Key, class Value, class Compare, class KeyContainer, class ValueContainer>
+    inline void swap(flat_map<Key, Value, Compare, KeyContainer, ValueContainer> &lhs,
+                     flat_map<Key, Value, Compare, KeyContainer, ValueContainer> &rhs) noexcept {
+        lhs.swap(rhs);
+    }
+}
@@ -0,0 +1,712 @@
+/********************************************************
+ * \file
+ * \brief Заголовочный файл с описанием контейнера 'incremental_vector'
+ ********************************************************
+ * Файл содержит в себе реализацию вектора с постепенным
+ * переносом элементов при росте 'incremental_vector'
+ */
+
+#pragma once
+
+#include "segmented_iterator.h"
+#include "vector.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace pva {
+    
+    /********************************************************
+     * \brief Класс - вектор с постепенным переносом элементов
+     ********************************************************
+     * Когда емкость кончается, выделяется новый буфер, но
+     * элементы из старого не переносятся сразу: старый и
+     * новый буферы живут вместе, а каждое следующее
+     * добавление или удаление переносит не больше budget()
+     * элементов (и не меньше, чем нужно, чтобы перенос
+     * закончился до следующего роста). Поэтому ни одно
+     * добавление не копирует весь вектор, и задержка
+     * push_back ограничена, а не только амортизирована.
+     * Пока идет перенос, operator[] выбирает буфер по
+     * индексу, а элементы не лежат одним массивом (data()
+     * нет, итераторы - по индексу). Ссылки на элементы
+     * меняются при их переносе. budget = 0 - обычный
+     * перенос всех элементов сразу
+     */
+    
+    template<class T, class Allocator = malloc_allocator<T>, class GrowthPolicy = growth_double>
+    class incremental_vector : private detail::allocator_holder<Allocator> {
+        typedef detail::allocator_holder<Allocator> holder;
+        typedef std::allocator_traits<Allocator> alloc_traits;
+    
+    public:
+        typedef T value_type;
+        typedef Allocator allocator_type;
+        typedef std::size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef segmented_iterator<incremental_vector, T> iterator;
+        typedef segmented_iterator<const incremental_vector, const T> const_iterator;
+        
+        static constexpr std::size_t default_budget = 1024; /*< Элементов, переносимых за одну операцию*/
+        
+        /**********************************************
+         * Конструктор по умолчанию
+         */
+        
+        incremental_vector()
+        :incremental_vector(default_budget) {}
+        
+        /**********************************************
+         * Конструктор с бюджетом переноса
+         **********************************************
+         * \param budget Сколько элементов переносится за
+         * одну операцию (0 - все сразу)
+         * \param allocator Аллокатор вектора
+         */
+        
+        explicit incremental_vector(const std::size_t &budget, const Allocator &allocator = Allocator())
+        :holder(allocator), data_(nullptr), size_(0), count_(0), old_(nullptr), old_size_(0),
+         old_count_(0), migrated_(0), budget_(budget), rate_(0), released_(0) {}
+        
+        /**********************************************
+         * Конструктор копирования
+         **********************************************
+         * Копия получает один буфер без переноса
+         */
+        
+        incremental_vector(const incremental_vector &copy)
+        :incremental_vector(copy, alloc_traits::select_on_container_copy_construction(copy.alloc())) {}
+        
+        /**********************************************
+         * Конструктор копирования с аллокатором
+         **********************************************
+         * \param copy Копируемый вектор
+         * \param allocator Аллокатор копии
+         */
+        
+        incremental_vector(const incremental_vector &copy, const Allocator &allocator)
+        :incremental_vector(copy.budget_, allocator) {
+            std::size_t capacity = copy.count_;
+            data_ = allocate(capacity);
+            size_ = capacity;
+            try {
+                for (; count_ < copy.count_; ++count_)
+                    alloc_traits::construct(this->alloc(), data_ + count_, copy[count_]);
+            }
+            catch (...) {
+                release();
+                throw;
+            }
+        }
+        
+        /**********************************************
+         * Конструктор перемещения
+         **********************************************
+         * Забирает оба буфера copy вместе с незаконченным
+         * переносом
+         */
+        
+        incremental_vector(incremental_vector &&copy) noexcept
+        :holder(pva::move(copy.alloc())), data_(copy.data_), size_(copy.size_), count_(copy.count_),
+         old_(copy.old_), old_size_(copy.old_size_), old_count_(copy.old_count_), migrated_(copy.migrated_),
+         budget_(copy.budget_), rate_(copy.rate_), released_(copy.released_) {
+            copy.reset();
+        }
+        
+        /**********************************************
+         * Деструктор
+         */
+        
+        ~incremental_vector() {
+            release();
+        }
+        
+        /********************************************************
+         * Перегруженный оператор присваивания
+         ********************************************************
+         * Собирает копию с аллокатором, который получит вектор
+         * (аллокатор copy, если он передается при копировании),
+         * и забирает ее буферы. При исключении вектор не
+         * меняется
+         ********************************************************
+         * \param copy Копируемый вектор
+         * \return Ссылку на вектор
+         */
+        
+        incremental_vector& operator =(const incremental_vector &copy) {
+            if (&copy == this)
+                return *this;
+            incremental_vector temp(copy, alloc_traits::propagate_on_container_copy_assignment::value ?
+                                          copy.alloc() : this->alloc());
+            release();
+            if constexpr (alloc_traits::propagate_on_container_copy_assignment::value)
+                this->alloc() = copy.alloc();
+            take(temp);
+            budget_ = copy.budget_;
+            return *this;
+        }
+        
+        /********************************************************
+         * Перегруженный оператор присваивания через rvalue - ссылки
+         ********************************************************
+         * Освобождает свои буферы и забирает буферы copy. Если
+         * аллокаторы не равны и не передаются при перемещении,
+         * элементы перемещаются по одному в буфер своего
+         * аллокатора, а copy остается пустым
+         ********************************************************
+         * \param copy rvalue - ссылка на перемещаемый вектор
+         * \return Ссылку на вектор
+         */
+        
+        incremental_vector& operator =(incremental_vector &&copy)
+        noexcept(alloc_traits::propagate_on_container_move_assignment::value ||
+                 alloc_traits::is_always_equal::value) {
+            if (&copy == this)
+                return *this;
+            if constexpr (!alloc_traits::propagate_on_container_move_assignment::value &&
+                          !alloc_traits::is_always_equal::value) {
+                if (this->alloc() != copy.alloc()) {
+                    incremental_vector temp(copy.budget_, this->alloc());
+                    temp.reserve(copy.count_);
+                    for (std::size_t i = 0; i < copy.count_; ++i)
+                        temp.emplace_back(move_if_noexcept(copy[i]));
+                    release();
+                    take(temp);
+                    budget_ = copy.budget_;
+                    copy.clear();
+                    return *this;
+                }
+            }
+            release();
+            if constexpr (alloc_traits::propagate_on_container_move_assignment::value)
+                this->alloc() = pva::move(copy.alloc());
+            take(copy);
+            budget_ = copy.budget_;
+            return *this;
+        }
+        
+        /********************************************************
+         * Добавление элемента в конец вектора
+         */
+        
+        void push_back(const T &value) {
+            emplace_back(value);
+        }
+        
+        void push_back(T &&value) {
+            emplace_back(pva::move(value));
+        }
+        
+        /********************************************************
+         * Создание элемента в конце вектора
+         ********************************************************
+         * Выполняет очередную часть переноса. При исключении
+         * вектор не меняется (кроме уже перенесенных элементов)
+         ********************************************************
+         * \param args Аргументы конструктора элемента
+         * \return Ссылку на созданный элемент
+         */
+        
+        template<class... Args>
+        T& emplace_back(Args&&... args) {
+            if (count_ == size_ || (old_ && !nothrow_migrate)) {
+                // args могут ссылаться на элемент, который перенос разрушит
+                T value(pva::forward<Args>(args)...);
+                if (count_ == size_)
+                    grow(count_ + 1);
+                migrate(rate_);
+                alloc_traits::construct(this->alloc(), data_ + count_, pva::move(value));
+            }
+            else {
+                alloc_traits::construct(this->alloc(), data_ + count_, pva::forward<Args>(args)...);
+                if (old_)
+                    migrate(rate_);
+            }
+            return data_[count_++];
+        }
+        
+        /********************************************************
+         * Удаление последнего элемента вектора
+         ********************************************************
+         * Выполняет очередную часть переноса
+         */
+        
+        void pop_back() {
+            PVA_ASSERT(count_ != 0, "Vector is empty!");
+            if (old_)
+                migrate(rate_);
+            alloc_traits::destroy(this->alloc(), &(*this)[count_ - 1]);
+            --count_;
+            if (old_count_ > count_) {
+                old_count_ = count_;
+                if (migrated_ == old_count_)
+                    release_old();
+            }
+        }
+        
+        /********************************************************
+         * Перенос не больше count элементов из старого буфера
+         ********************************************************
+         * Позволяет закончить перенос заранее, например, когда
+         * программа простаивает
+         ********************************************************
+         * \param count Сколько элементов перенести
+         * \return True - перенос закончен
+         */
+        
+        bool migrate(const std::size_t &count) {
+            if (!old_)
+                return true;
+            const std::size_t end = old_count_ - migrated_ > count ? migrated_ + count : old_count_;
+            if constexpr (relocate_bitwise) {
+                std::memcpy(static_cast<void*>(data_ + migrated_), old_ + migrated_, (end - migrated_) * sizeof(T));
+                migrated_ = end;
+            }
+            else {
+                for (; migrated_ != end; ++migrated_) {
+                    alloc_traits::construct(this->alloc(), data_ + migrated_, move_if_noexcept(old_[migrated_]));
+                    alloc_traits::destroy(this->alloc(), old_ + migrated_);
+                }
+            }
+            if (migrated_ != old_count_) {
+                discard();
+                return false;
+            }
+            release_old();
+            return true;
+        }
+        
+        /********************************************************
+         * Перенос всех оставшихся элементов
+         */
+        
+        void finish_migration() {
+            migrate(old_count_ - migrated_);
+        }
+        
+        /********************************************************
+         * Идет ли перенос (живут ли два буфера)
+         */
+        
+        bool migrating() const noexcept {
+            return old_ != nullptr;
+        }
+        
+        /********************************************************
+         * Число элементов, переносимых за одну операцию
+         */
+        
+        std::size_t budget() const noexcept {
+            return budget_;
+        }
+        
+        /********************************************************
+         * Изменение числа элементов, переносимых за одну операцию
+         ********************************************************
+         * \param budget Новый бюджет (0 - переносить все сразу)
+         */
+        
+        void set_budget(const std::size_t &budget) {
+            budget_ = budget;
+            if (old_)
+                rate_ = migration_rate(old_count_ - migrated_);
+        }
+        
+        /********************************************************
+         * Резервирование памяти
+         ********************************************************
+         * Явный запрос: элементы переносятся сразу
+         ********************************************************
+         * \param size Требуемая емкость
+         * \return True - память выделилась, false - обратное
+         */
+        
+        bool reserve(const std::size_t &size) {
+            if (size <= size_)
+                return false;
+            finish_migration();
+            reallocate(size);
+            return true;
+        }
+        
+        /********************************************************
+         * Освобождение неиспользуемой памяти
+         ********************************************************
+         * Заканчивает перенос и переносит элементы в буфер
+         * ровно под них
+         */
+        
+        void shrink_to_fit() {
+            finish_migration();
+            if (count_ == 0)
+                release();
+            else if (count_ < size_)
+                reallocate(count_);
+        }
+        
+        /********************************************************
+         * Удаление всех элементов
+         ********************************************************
+         * Емкость сохраняется, как у vector::clear; старый буфер
+         * незаконченного переноса освобождается. Память
+         * возвращает shrink_to_fit
+         */
+        
+        void clear() noexcept {
+            for (std::size_t i = 0; i < count_; ++i)
+                alloc_traits::destroy(this->alloc(), &(*this)[i]);
+            count_ = 0;
+            release_old();
+        }
+        
+        /********************************************************
+         * Обмен содержимым с другим вектором
+         ********************************************************
+         * Аллокаторы обмениваются, только если они передаются
+         * при обмене; иначе они должны быть равны
+         */
+        
+        void swap(incremental_vector &other) noexcept {
+            if constexpr (alloc_traits::propagate_on_container_swap::value)
+                detail::swap_allocators(this->alloc(), other.alloc());
+            std::swap(data_, other.data_);
+            std::swap(size_, other.size_);
+            std::swap(count_, other.count_);
+            std::swap(old_, other.old_);
+            std::swap(old_size_, other.old_size_);
+            std::swap(old_count_, other.old_count_);
+            std::swap(migrated_, other.migrated_);
+            std::swap(budget_, other.budget_);
+            std::swap(rate_, other.rate_);
+            std::swap(released_, other.released_);
+        }
+        
+        std::size_t size() const noexcept {
+            return count_;
+        }
+        
+        bool empty() const noexcept {
+            return count_ == 0;
+        }
+        
+        /********************************************************
+         * Емкость нового (текущего) буфера
+         */
+        
+        std::size_t capacity() const noexcept {
+            return size_;
+        }
+        
+        /********************************************************
+         * Перегруженный оператор [] (обращение к элементу вектора)
+         ********************************************************
+         * Элементы [migrated_, old_count_) еще лежат в старом
+         * буфере, остальные - в новом
+         ********************************************************
+         * \param index Индекс элемента
+         * \return Ссылку на элемент вектора по индексу
+         */
+        
+        T& operator [](const std::size_t &index) {
+            PVA_ASSERT(index < count_, "Index more than size of vector!");
+            return index - migrated_ < old_count_ - migrated_ ? old_[index] : data_[index];
+        }
+        
+        const T& operator [](const std::size_t &index) const {
+            PVA_ASSERT(index < count_, "Index more than size of vector!");
+            return index - migrated_ < old_count_ - migrated_ ? old_[index] : data_[index];
+        }
+        
+        /********************************************************
+         * Обращение к элементу вектора с проверкой индекса
+         */
+        
+        T& at(const std::size_t &index) {
+            if (index >= count_)
+                throw std::out_of_range("Index more than size of vector!");
+            return (*this)[index];
+        }
+        
+        const T& at(const std::size_t &index) const {
+            if (index >= count_)
+                throw std::out_of_range("Index more than size of vector!");
+            return (*this)[index];
+        }
+        
+        T& front() {
+            PVA_ASSERT(count_ != 0, "Vector is empty!");
+            return (*this)[0];
+        }
+        
+        const T& front() const {
+            PVA_ASSERT(count_ != 0, "Vector is empty!");
+            return (*this)[0];
+        }
+        
+        T& back() {
+            PVA_ASSERT(count_ != 0, "Vector is empty!");
+            return (*this)[count_ - 1];
+        }
+        
+        const T& back() const {
+            PVA_ASSERT(count_ != 0, "Vector is empty!");
+            return (*this)[count_ - 1];
+        }
+        
+        iterator begin() noexcept {
+            return iterator(this, 0);
+        }
+        
+        const_iterator begin() const noexcept {
+            return const_iterator(this, 0);
+        }
+        
+        const_iterator cbegin() const noexcept {
+            return begin();
+        }
+        
+        iterator end() noexcept {
+            return iterator(this, count_);
+        }
+        
+        const_iterator end() const noexcept {
+            return const_iterator(this, count_);
+        }
+        
+        const_iterator cend() const noexcept {
+            return end();
+        }
+        
+        allocator_type get_allocator() const {
+            return this->alloc();
+        }
+    
+    private:
+        
+        /********************************************************
+         * Выделение памяти с учетом allocate_at_least
+         */
+        
+        T* allocate(std::size_t &capacity) {
+            if (capacity == 0)
+                return nullptr;
+            if (capacity > alloc_traits::max_size(this->alloc()))
+                throw std::length_error("Vector is too long!");
+            if constexpr (detail::has_allocate_at_least<Allocator>::value) {
+                allocation_result<T*> result = this->alloc().allocate_at_least(capacity);
+                capacity = result.count;
+                return result.ptr;
+            }
+            else
+                return alloc_traits::allocate(this->alloc(), capacity);
+        }
+        
+        /********************************************************
+         * Начало переноса в новый буфер
+         ********************************************************
+         * Перенос, начатый прошлым ростом, заканчивается сразу
+         * (при бюджете не меньше нужного этого не бывает)
+         ********************************************************
+         * \param required Минимально необходимая емкость
+         */
+        
+        void grow(const std::size_t &required) {
+            finish_migration();
+            if (budget_ == 0 || count_ == 0) {
+                reallocate(GrowthPolicy()(size_, required));
+                return;
+            }
+            std::size_t capacity = GrowthPolicy()(size_, required);
+            T* data = allocate(capacity);
+            old_ = data_;
+            old_size_ = size_;
+            old_count_ = count_;
+            migrated_ = 0;
+            data_ = data;
+            size_ = capacity;
+            rate_ = migration_rate(count_);
+        }
+        
+        /********************************************************
+         * Сколько элементов переносить за операцию
+         ********************************************************
+         * Не меньше бюджета и не меньше left / (свободное место),
+         * чтобы перенос закончился до заполнения нового буфера
+         */
+        
+        std::size_t migration_rate(const std::size_t &left) const noexcept {
+            if (budget_ == 0)
+                return left;
+            const std::size_t free = size_ - count_;
+            const std::size_t required = free == 0 ? left : (left + free - 1) / free;
+            return required > budget_ ? required : budget_;
+        }
+        
+        /********************************************************
+         * Перенос всех элементов в новый буфер емкостью size
+         */
+        
+        void reallocate(const std::size_t &size) {
+            std::size_t capacity = size;
+            T* data = allocate(capacity);
+            if constexpr (relocate_bitwise) {
+                if (count_ != 0)
+                    std::memcpy(static_cast<void*>(data), data_, count_ * sizeof(T));
+            }
+            else {
+                std::size_t i = 0;
+                try {
+                    for (; i < count_; ++i)
+                        alloc_traits::construct(this->alloc(), data + i, move_if_noexcept(data_[i]));
+                }
+                catch (...) {
+                    for (std::size_t j = 0; j < i; ++j)
+                        alloc_traits::destroy(this->alloc(), data + j);
+                    alloc_traits::deallocate(this->alloc(), data, capacity);
+                    throw;
+                }
+                for (i = 0; i < count_; ++i)
+                    alloc_traits::destroy(this->alloc(), data_ + i);
+            }
+            if (data_)
+                alloc_traits::deallocate(this->alloc(), data_, size_);
+            data_ = data;
+            size_ = capacity;
+        }
+        
+        /********************************************************
+         * Возврат ядру страниц старого буфера, из которых
+         * элементы уже перенесены
+         ********************************************************
+         * Иначе освобождение большого буфера (munmap) в конце
+         * переноса само занимает десятки миллисекунд. Страницы
+         * возвращаются порциями от discard_step байт
+         */
+        
+        void discard() noexcept {
+#if defined(__linux__)
+            if (old_size_ * sizeof(T) < discard_threshold)
+                return;
+            static const std::uintptr_t page = std::uintptr_t(sysconf(_SC_PAGESIZE));
+            const std::uintptr_t begin = released_ != 0 ? released_ :
+                (reinterpret_cast<std::uintptr_t>(old_) + page - 1) / page * page;
+            const std::uintptr_t end = reinterpret_cast<std::uintptr_t>(old_ + migrated_) / page * page;
+            if (end >= begin + discard_step) {
+                madvise(reinterpret_cast<void*>(begin), end - begin, MADV_DONTNEED);
+                released_ = end;
+            }
+#endif
+        }
+        
+        /********************************************************
+         * Освобождение старого буфера после переноса
+         */
+        
+        void release_old() noexcept {
+            if (old_)
+                alloc_traits::deallocate(this->alloc(), old_, old_size_);
+            old_ = nullptr;
+            old_size_ = 0;
+            old_count_ = 0;
+            migrated_ = 0;
+            rate_ = 0;
+            released_ = 0;
+        }
+        
+        /********************************************************
+         * Удаление всех элементов и освобождение памяти
+         */
+        
+        void release() noexcept {
+            clear();
+            if (data_)
+                alloc_traits::deallocate(this->alloc(), data_, size_);
+            reset();
+        }
+        
+        /********************************************************
+         * Состояние пустого вектора без памяти
+         */
+        
+        /********************************************************
+         * Перенос буферов и состояния переноса из other (память
+         * должна быть выделена равным аллокатором)
+         */
+        
+        void take(incremental_vector &other) noexcept {
+            data_ = other.data_;
+            size_ = other.size_;
+            count_ = other.count_;
+            old_ = other.old_;
+            old_size_ = other.old_size_;
+            old_count_ = other.old_count_;
+            migrated_ = other.migrated_;
+            rate_ = other.rate_;
+            released_ = other.released_;
+            other.reset();
+        }
+        
+        void reset() noexcept {
+            data_ = nullptr;
+            size_ = 0;
+            count_ = 0;
+            old_ = nullptr;
+            old_size_ = 0;
+            old_count_ = 0;
+            migrated_ = 0;
+            rate_ = 0;
+            released_ = 0;
+        }
+        
+        /********************************************************
+         * Ссылка, из которой элемент будет перемещен, если
+         * перемещение не бросает исключений, иначе скопирован
+         */
+        
+        static typename std::conditional<
+            !std::is_nothrow_move_constructible<T>::value && std::is_copy_constructible<T>::value,
+            const T&, T&&>::type
+        move_if_noexcept(T &value) noexcept {
+            return pva::move(value);
+        }
+        
+        static constexpr bool relocate_bitwise = is_trivially_relocatable<T>::value &&
+            detail::default_construct<Allocator, T>::value; /*< Элементы переносятся побайтово*/
+        static constexpr std::size_t discard_threshold = std::size_t(64) << 20; /*< Размер старого буфера для возврата страниц*/
+        static constexpr std::size_t discard_step = std::size_t(2) << 20; /*< Порция возврата страниц*/
+        static constexpr bool nothrow_migrate = relocate_bitwise ||
+            std::is_nothrow_move_constructible<T>::value; /*< Перенос не бросает исключений*/
+        
+        T* data_; /*< Новый (текущий) буфер*/
+        std::size_t size_; /*< Емкость data_*/
+        std::size_t count_; /*< Число элементов в векторе*/
+        T* old_; /*< Старый буфер, из которого идет перенос (nullptr - переноса нет)*/
+        std::size_t old_size_; /*< Емкость old_*/
+        std::size_t old_count_; /*< Конец элементов, лежащих в old_*/
+        std::size_t migrated_; /*< Элементы [0, migrated_) уже перенесены в data_*/
+        std::size_t budget_; /*< Бюджет переноса за операцию*/
+        std::size_t rate_; /*< Переносится за операцию в текущем переносе*/
+        std::uintptr_t released_; /*< Конец страниц old_, уже возвращенных ядру (0 - ни одной)*/
+    };
+    
+    /********************************************************
+     * Функция замены двух векторов
+     */
+    
+    template<class T, class Allocator, class GrowthPolicy>
+    inline void swap(incremental_vector<T, Allocator, GrowthPolicy> &lhs,
+                     incremental_vector<T, Allocator, GrowthPolicy> &rhs) noexcept {
+        lhs.swap(rhs);
+    }
+}
@@ -0,0 +1,608 @@
+/********************************************************
+ * \file
+ * \brief Заголовочный файл с описанием контейнера 'mmap_vector'
+ ********************************************************
+ * Файл содержит в себе реализацию вектора, который хранит
+ * элементы в отображенном в память файле 'mmap_vector'
+ * (только POSIX)
+ */
+
+#pragma once
+
+#include "vector.h"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace pva {
+    
+    /********************************************************
+     * \brief Режим открытия файла mmap_vector
+     */
+    
+    enum class map_mode {
+        read_only, /*< Только чтение, отображение разделяется между процессами*/
+        read_write /*< Чтение и запись, файл создается, если его нет*/
+    };
+    
+    /********************************************************
+     * \brief Подсказка ядру о порядке доступа (madvise)
+     */
+    
+    enum class map_advice {
+        normal, /*< MADV_NORMAL*/
+        sequential, /*< MADV_SEQUENTIAL: чтение подряд, агрессивное упреждение*/
+        random, /*< MADV_RANDOM: без упреждающего чтения*/
+        will_need, /*< MADV_WILLNEED: подгрузить страницы заранее*/
+        dont_need /*< MADV_DONTNEED: страницы можно выгрузить*/
+    };
+    
+    /********************************************************
+     * \brief Класс - вектор в отображенном в память файле
+     ********************************************************
+     * Файл начинается с 64-байтного заголовка (сигнатура,
+     * размер элемента, число элементов), за ним лежат
+     * элементы. Открытие файла не читает элементы: страницы
+     * подгружаются ядром при первом обращении, поэтому
+     * многогигабайтный вектор открывается мгновенно. Вектор
+     * растет через ftruncate и перестраивание отображения
+     * (mremap на Linux), итераторы и ссылки при этом, как у
+     * vector, становятся недействительными. Число элементов
+     * хранится в заголовке, так что файл можно открыть снова
+     * в этом или другом процессе. Деструктор обрезает файл
+     * до числа элементов, но не вызывает msync: данные
+     * попадут на диск, когда их сбросит ядро, или после flush()
+     */
+    
+    template<class T, class GrowthPolicy = growth_double>
+    class mmap_vector {
+        static_assert(std::is_trivially_copyable<T>::value, "mmap_vector requires a trivially copyable type");
+        static_assert(alignof(T) <= 64, "mmap_vector supports alignment up to 64 bytes");
+    
+    public:
+        typedef T value_type;
+        typedef std::size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef pva::iterator<T> iterator;
+        typedef pva::iterator<const T> const_iterator;
+        
+        /**********************************************
+         * Конструктор
+         **********************************************
+         * Отображает файл в память. В режиме read_write
+         * отсутствующий файл создается пустым
+         **********************************************
+         * \param path Путь к файлу
+         * \param mode Режим открытия
+         */
+        
+        explicit mmap_vector(const std::string &path, map_mode mode = map_mode::read_write)
+        :mode_(mode), file_(-1), mapping_(nullptr), length_(0), size_(0), data_(nullptr) {
+            const int flags = mode == map_mode::read_only ? O_RDONLY : O_RDWR | O_CREAT;
+            file_ = ::open(path.c_str(), flags | O_CLOEXEC, 0644);
+            if (file_ < 0)
+                fail("open");
+            try {
+                struct stat info;
+                if (::fstat(file_, &info) != 0)
+                    fail("fstat");
+                std::size_t length = static_cast<std::size_t>(info.st_size);
+                if (length == 0 && mode == map_mode::read_write) {
+                    resize_file(header_size);
+                    length = header_size;
+                    map(length);
+                    header* head = new (mapping_) header();
+                    std::memcpy(head->magic, signature, sizeof(head->magic));
+                    head->element_size = sizeof(T);
+                    head->count = 0;
+                }
+                else {
+                    if (length < header_size)
+                        throw std::runtime_error("File is not an mmap_vector!");
+                    map(length);
+                    const header* head = static_cast<const header*>(mapping_);
+                    if (std::memcmp(head->magic, signature, sizeof(head->magic)) != 0 ||
+                        head->element_size != sizeof(T))
+                        throw std::runtime_error("File is not an mmap_vector of this type!");
+                    if (head->count > (length - header_size) / sizeof(T))
+                        throw std::runtime_error("mmap_vector file is truncated!");
+                }
+            }
+            catch (...) {
+                close();
+                throw;
+            }
+        }
+        
+        /**********************************************
+         * Конструктор перемещения
+         */
+        
+        mmap_vector(mmap_vector &&copy) noexcept
+        :mode_(copy.mode_), file_(copy.file_), mapping_(copy.mapping_), length_(copy.length_),
+         size_(copy.size_), data_(copy.data_) {
+            copy.file_ = -1;
+            copy.mapping_ = nullptr;
+            copy.length_ = 0;
+            copy.size_ = 0;
+            copy.data_ = nullptr;
+        }
+        
+        mmap_vector(const mmap_vector &) = delete;
+        mmap_vector& operator =(const mmap_vector &) = delete;
+        
+        /**********************************************
+         * Перегруженный оператор присваивания через rvalue - ссылки
+         */
+        
+        mmap_vector& operator =(mmap_vector &&copy) noexcept {
+            if (&copy != this) {
+                close();
+                mode_ = copy.mode_;
+                file_ = copy.file_;
+                mapping_ = copy.mapping_;
+                length_ = copy.length_;
+                size_ = copy.size_;
+                data_ = copy.data_;
+                copy.file_ = -1;
+                copy.mapping_ = nullptr;
+                copy.length_ = 0;
+                copy.size_ = 0;
+                copy.data_ = nullptr;
+            }
+            return *this;
+        }
+        
+        /**********************************************
+         * Деструктор
+         **********************************************
+         * Обрезает файл до числа элементов и закрывает его
+         */
+        
+        ~mmap_vector() {
+            close();
+        }
+        
+        /********************************************************
+         * Резервирование места в файле
+         ********************************************************
+         * \param size Число элементов, которое должно поместиться
+         * \return True - файл вырос, false - места хватало
+         */
+        
+        bool reserve(const std::size_t &size) {
+            if (size <= size_)
+                return false;
+            writable();
+            remap(size);
+            return true;
+        }
+        
+        /********************************************************
+         * Емкость вектора (элементов помещается в файл)
+         */
+        
+        std::size_t capacity() const {
+            return size_;
+        }
+        
+        /********************************************************
+         * Число элементов в векторе
+         */
+        
+        std::size_t size() const {
+            return mapping_ ? static_cast<const header*>(mapping_)->count : 0;
+        }
+        
+        /********************************************************
+         * Проверка на пустоту
+         */
+        
+        bool empty() const {
+            return size() == 0;
+        }
+        
+        /********************************************************
+         * Открыт ли вектор только для чтения
+         */
+        
+        bool read_only() const noexcept {
+            return mode_ == map_mode::read_only;
+        }
+        
+        /********************************************************
+         * Добавление элемента в конец вектора
+         ********************************************************
+         * \param value Значение элемента
+         */
+        
+        void push_back(const T &value) {
+            writable();
+            const std::size_t count = size();
+            if (count == size_) {
+                const T copy = value;
+                remap(GrowthPolicy()(size_, count + 1));
+                data_[count] = copy;
+            }
+            else
+                data_[count] = value;
+            set_size(count + 1);
+        }
+        
+        /********************************************************
+         * Создание элемента в конце вектора
+         ********************************************************
+         * \param args Аргументы конструктора элемента
+         * \return Ссылку на созданный элемент
+         */
+        
+        template<class... Args>
+        T& emplace_back(Args&&... args) {
+            push_back(T(pva::forward<Args>(args)...));
+            return back();
+        }
+        
+        /********************************************************
+         * Добавление массива [first, last) в конец вектора
+         ********************************************************
+         * Файл растет не больше одного раза, элементы
+         * копируются одним memcpy
+         ********************************************************
+         * \param first Начало массива
+         * \param last Конец массива
+         */
+        
+        void append(const T* first, const T* last) {
+            writable();
+            const std::size_t count = size();
+            const std::size_t added = last - first;
+            if (added == 0)
+                return;
+            if (added > size_ - count) {
+                if (first >= data_ && first < data_ + size_) {
+                    vector<T> temp(first, last);
+                    append(temp.data(), temp.data() + temp.size());
+                    return;
+                }
+                remap(GrowthPolicy()(size_, count + added));
+            }
+            std::memcpy(static_cast<void*>(data_ + count), first, added * sizeof(T));
+            set_size(count + added);
+        }
+        
+        /********************************************************
+         * Удаление последнего элемента вектора
+         */
+        
+        void pop_back() {
+            writable();
+            PVA_ASSERT(!empty(), "Vector is empty!");
+            set_size(size() - 1);
+        }
+        
+        /********************************************************
+         * Изменение числа элементов
+         ********************************************************
+         * Новые элементы заполняются нулями (новые страницы
+         * файла нулевые)
+         ********************************************************
+         * \param size Новое число элементов
+         */
+        
+        void resize(const std::size_t &size) {
+            writable();
+            const std::size_t count = this->size();
+            if (size > size_)
+                remap(size);
+            if (size > count)
+                std::memset(static_cast<void*>(data_ + count), 0, (size - count) * sizeof(T));
+            set_size(size);
+        }
+        
+        /********************************************************
+         * Изменение числа элементов с заполнением значением
+         ********************************************************
+         * \param size Новое число элементов
+         * \param value Значение новых элементов
+         */
+        
+        void resize(const std::size_t &size, const T &value) {
+            writable();
+            const std::size_t count = this->size();
+            if (size > size_) {
+                const T copy = value;
+                remap(size);
+                for (std::size_t i = count; i < size; ++i)
+                    data_[i] = copy;
+            }
+            else
+                for (std::size_t i = count; i < size; ++i)
+                    data_[i] = value;
+            set_size(size);
+        }
+        
+        /********************************************************
+         * Удаление всех элементов
+         ********************************************************
+         * Файл не обрезается, см. shrink_to_fit()
+         */
+        
+        void clear() {
+            writable();
+            set_size(0);
+        }
+        
+        /********************************************************
+         * Обрезание файла до числа элементов
+         */
+        
+        void shrink_to_fit() {
+            writable();
+            if (size() < size_)
+                remap(size());
+        }
+        
+        /********************************************************
+         * Сброс изменений на диск (msync)
+         ********************************************************
+         * \param wait True - дождаться записи (MS_SYNC), false -
+         * только поставить запись в очередь (MS_ASYNC)
+         */
+        
+        void flush(bool wait = true) {
+            if (mapping_ && mode_ == map_mode::read_write &&
+                ::msync(mapping_, length_, wait ? MS_SYNC : MS_ASYNC) != 0)
+                fail("msync");
+        }
+        
+        /********************************************************
+         * Подсказка ядру о порядке доступа к элементам (madvise)
+         ********************************************************
+         * \param advice Подсказка
+         */
+        
+        void advise(map_advice advice) {
+            if (!mapping_)
+                return;
+            int value = MADV_NORMAL;
+            switch (advice) {
+                case map_advice::normal: value = MADV_NORMAL; break;
+                case map_advice::sequential: value = MADV_SEQUENTIAL; break;
+                case map_advice::random: value = MADV_RANDOM; break;
+                case map_advice::will_need: value = MADV_WILLNEED; break;
+                case map_advice::dont_need: value = MADV_DONTNEED; break;
+            }
+            if (::madvise(mapping_, length_, value) != 0)
+                fail("madvise");
+        }
+        
+        /********************************************************
+         * Обращение к элементу вектора с проверкой индекса
+         ********************************************************
+         * \param index Индекс элемента
+         * \return Ссылку на элемент вектора по индексу
+         */
+        
+        T& at(const std::size_t &index) {
+            if (index >= size())
+                throw std::out_of_range("Index more than size of vector!");
+            return data_[index];
+        }
+        
+        const T& at(const std::size_t &index) const {
+            if (index >= size())
+                throw std::out_of_range("Index more than size of vector!");
+            return data_[index];
+        }
+        
+        /********************************************************
+         * Перегруженный оператор [] (обращение к элементу вектора)
+         ********************************************************
+         * Индекс проверяется только при PVA_CHECKED. В режиме
+         * read_only запись в элемент приводит к SIGSEGV
+         */
+        
+        T& operator [](const std::size_t &index) {
+            PVA_ASSERT(index < size(), "Index more than size of vector!");
+            return data_[index];
+        }
+        
+        const T& operator [](const std::size_t &index) const {
+            PVA_ASSERT(index < size(), "Index more than size of vector!");
+            return data_[index];
+        }
+        
+        T& front() {
+            return (*this)[0];
+        }
+        
+        const T& front() const {
+            return (*this)[0];
+        }
+        
+        T& back() {
+            return (*this)[size() - 1];
+        }
+        
+        const T& back() const {
+            return (*this)[size() - 1];
+        }
+        
+        T* data() noexcept {
+            return data_;
+        }
+        
+        const T* data() const noexcept {
+            return data_;
+        }
+        
+        iterator begin() {
+            return iterator(data_);
+        }
+        
+        iterator end() {
+            return iterator(data_ + size());
+        }
+        
+        const_iterator begin() const {
+            return const_iterator(data_);
+        }
+        
+        const_iterator end() const {
+            return const_iterator(data_ + size());
+        }
+        
+        const_iterator cbegin() const {
+            return begin();
+        }
+        
+        const_iterator cend() const {
+            return end();
+        }
+    
+    private:
+        /********************************************************
+         * \brief Заголовок файла
+         */
+        
+        struct header {
+            char magic[8]; /*< Сигнатура "PVAMMAP1"*/
+            std::uint64_t element_size; /*< sizeof(T), проверяется при открытии*/
+            std::uint64_t count; /*< Число элементов*/
+            char reserved[40]; /*< Дополнение до 64 байт*/
+        };
+        
+        static_assert(sizeof(header) == 64, "mmap_vector header must be 64 bytes");
+        
+        static constexpr std::size_t header_size = sizeof(header); /*< Смещение элементов в файле*/
+        static constexpr char signature[8] = {'P', 'V', 'A', 'M', 'M', 'A', 'P', '1'}; /*< Сигнатура файла*/
+        
+        /********************************************************
+         * Ошибка системного вызова
+         */
+        
+        [[noreturn]] static void fail(const char* call) {
+            throw std::system_error(errno, std::generic_category(), call);
+        }
+        
+        /********************************************************
+         * Проверка, что вектор можно менять
+         */
+        
+        void writable() const {
+            if (mode_ == map_mode::read_only)
+                throw std::logic_error("mmap_vector is read-only!");
+        }
+        
+        /********************************************************
+         * Запись числа элементов в заголовок
+         */
+        
+        void set_size(std::size_t count) noexcept {
+            static_cast<header*>(mapping_)->count = count;
+        }
+        
+        /********************************************************
+         * Изменение размера файла
+         */
+        
+        void resize_file(std::size_t length) {
+            if (::ftruncate(file_, static_cast<off_t>(length)) != 0)
+                fail("ftruncate");
+        }
+        
+        /********************************************************
+         * Отображение файла длиной length в память
+         */
+        
+        void map(std::size_t length) {
+            const int protection = mode_ == map_mode::read_only ? PROT_READ : PROT_READ | PROT_WRITE;
+            void* mapping = ::mmap(nullptr, length, protection, MAP_SHARED, file_, 0);
+            if (mapping == MAP_FAILED)
+                fail("mmap");
+            attach(mapping, length);
+        }
+        
+        /********************************************************
+         * Запоминание отображения
+         */
+        
+        void attach(void* mapping, std::size_t length) noexcept {
+            mapping_ = mapping;
+            length_ = length;
+            size_ = (length - header_size) / sizeof(T);
+            data_ = reinterpret_cast<T*>(static_cast<char*>(mapping) + header_size);
+        }
+        
+        /********************************************************
+         * Изменение емкости: размер файла и отображения
+         ********************************************************
+         * \param capacity Новая емкость в элементах
+         */
+        
+        void remap(std::size_t capacity) {
+            if (capacity > (std::numeric_limits<std::size_t>::max() - header_size) / sizeof(T))
+                throw std::length_error("Length of vector is too large!");
+            const std::size_t length = header_size + capacity * sizeof(T);
+            if (length > length_)
+                resize_file(length);
+#if defined(__linux__)
+            void* mapping = ::mremap(mapping_, length_, length, MREMAP_MAYMOVE);
+            if (mapping == MAP_FAILED)
+                fail("mremap");
+            if (length < length_)
+                resize_file(length);
+            attach(mapping, length);
+#else
+            ::munmap(mapping_, length_);
+            mapping_ = nullptr;
+            if (length < length_)
+                resize_file(length);
+            map(length);
+#endif
+        }
+        
+        /********************************************************
+         * Снятие отображения и закрытие файла
+         ********************************************************
+         * Файл, открытый на запись, обрезается до числа элементов
+         */
+        
+        void close() noexcept {
+            if (mapping_) {
+                const std::size_t count = size();
+                ::munmap(mapping_, length_);
+                if (mode_ == map_mode::read_write && count < size_)
+                    (void)::ftruncate(file_, static_cast<off_t>(header_size + count * sizeof(T)));
+                mapping_ = nullptr;
+            }
+            if (file_ >= 0)
+                ::close(file_);
+            file_ = -1;
+            length_ = 0;
+            size_ = 0;
+            data_ = nullptr;
+        }
+        
+        map_mode mode_; /*< Режим открытия*/
+        int file_; /*< Дескриптор файла*/
+        void* mapping_; /*< Начало отображения (заголовок)*/
+        std::size_t length_; /*< Длина отображения в байтах*/
+        std::size_t size_; /*< Емкость вектора (число элементов, помещающихся в файл)*/
+        T* data_; /*< Массив элементов в отображении*/
+    };
+}
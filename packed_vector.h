@@ -0,0 +1,711 @@
+/********************************************************
+ * \file
+ * \brief Заголовочный файл с описанием контейнеров
+ * 'packed_vector' и 'block_packed_vector'
+ ********************************************************
+ * Файл содержит в себе векторы целых, упакованных в
+ * минимальное число бит: 'packed_vector' (одна ширина на
+ * весь вектор, растет при добавлении) и
+ * 'block_packed_vector' (блоки со своей базой и шириной,
+ * frame of reference), их итератор 'packed_iterator' и
+ * ядра распаковки (на x86 через AVX2 с выбором
+ * реализации по процессору во время выполнения)
+ */
+
+#pragma once
+
+#include "vector.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+namespace pva {
+    
+    namespace detail {
+        
+        /********************************************************
+         * Маска из width младших бит
+         */
+        
+        inline std::uint64_t low_bits(unsigned width) noexcept {
+            return width >= 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << width) - 1;
+        }
+        
+        /********************************************************
+         * Число бит, нужное для записи value
+         */
+        
+        inline unsigned bit_width(std::uint64_t value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+            return value == 0 ? 0 : 64 - unsigned(__builtin_clzll(value));
+#else
+            unsigned width = 0;
+            for (; value != 0; value >>= 1)
+                ++width;
+            return width;
+#endif
+        }
+        
+        /********************************************************
+         * Чтение поля из width бит, начиная с бита position
+         ********************************************************
+         * За полем должно быть доступно еще одно слово
+         */
+        
+        inline std::uint64_t read_bits(const std::uint64_t* words, std::size_t position, unsigned width) noexcept {
+            const std::size_t index = position / 64;
+            const unsigned offset = unsigned(position % 64);
+            std::uint64_t value = words[index] >> offset;
+            if (offset + width > 64)
+                value |= words[index + 1] << (64 - offset);
+            return value & low_bits(width);
+        }
+        
+        /********************************************************
+         * Запись value в поле из width бит, начиная с бита
+         * position
+         */
+        
+        inline void write_bits(std::uint64_t* words, std::size_t position, unsigned width, std::uint64_t value) noexcept {
+            if (width == 0)
+                return;
+            const std::size_t index = position / 64;
+            const unsigned offset = unsigned(position % 64);
+            const std::uint64_t mask = low_bits(width);
+            words[index] = (words[index] & ~(mask << offset)) | (value << offset);
+            if (offset + width > 64) {
+                const unsigned shift = 64 - offset;
+                words[index + 1] = (words[index + 1] & ~(mask >> shift)) | (value >> shift);
+            }
+        }
+        
+        /********************************************************
+         * Распаковка count полей скалярным циклом
+         ********************************************************
+         * \param words Упакованные слова
+         * \param position Бит начала первого поля
+         * \param width Ширина поля
+         * \param count Число полей
+         * \param out Массив под count значений
+         */
+        
+        template<class T>
+        inline void unpack_bits_scalar(const std::uint64_t* words, std::size_t position, unsigned width,
+                                       std::size_t count, T* out) noexcept {
+            for (std::size_t i = 0; i < count; ++i, position += width)
+                out[i] = static_cast<T>(read_bits(words, position, width));
+        }
+
+#if PVA_SIMD_X86
+        /********************************************************
+         * Распаковка полей шириной до 57 бит (AVX2)
+         ********************************************************
+         * Четыре поля за шаг: 8 байт с байта начала каждого
+         * поля загружаются vpgatherqq, сдвигаются на остаток
+         * от деления начала на 8 и маскируются. За полями
+         * должно быть доступно еще одно слово. Вызывается
+         * только если cpu_has_avx2()
+         */
+        
+        __attribute__((target("avx2")))
+        inline void unpack_bits_avx2(const std::uint64_t* words, std::size_t position, unsigned width,
+                                     std::size_t count, std::uint64_t* out) noexcept {
+            const long long* bytes = reinterpret_cast<const long long*>(words);
+            const __m256i mask = _mm256_set1_epi64x(static_cast<long long>(low_bits(width)));
+            const __m256i step = _mm256_set1_epi64x(static_cast<long long>(4 * width));
+            const __m256i seven = _mm256_set1_epi64x(7);
+            __m256i bits = _mm256_setr_epi64x(static_cast<long long>(position),
+                                              static_cast<long long>(position + width),
+                                              static_cast<long long>(position + 2 * width),
+                                              static_cast<long long>(position + 3 * width));
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                const __m256i value = _mm256_i64gather_epi64(bytes, _mm256_srli_epi64(bits, 3), 1);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                                    _mm256_and_si256(_mm256_srlv_epi64(value, _mm256_and_si256(bits, seven)), mask));
+                bits = _mm256_add_epi64(bits, step);
+            }
+            unpack_bits_scalar(words, position + i * width, width, count - i, out + i);
+        }
+#endif
+        
+        /********************************************************
+         * Распаковка count полей
+         ********************************************************
+         * См. unpack_bits_scalar. Для 64-битных T на x86 с
+         * AVX2 (и полей до 57 бит) - векторное ядро
+         */
+        
+        template<class T>
+        inline void unpack_bits(const std::uint64_t* words, std::size_t position, unsigned width,
+                                std::size_t count, T* out) noexcept {
+#if PVA_SIMD_X86
+            if constexpr (sizeof(T) == sizeof(std::uint64_t))
+                if (width <= 57 && count >= 8 && cpu_has_avx2()) {
+                    unpack_bits_avx2(words, position, width, count, reinterpret_cast<std::uint64_t*>(out));
+                    return;
+                }
+#endif
+            unpack_bits_scalar(words, position, width, count, out);
+        }
+    }
+    
+    /********************************************************
+     * \brief Итератор упакованного вектора
+     ********************************************************
+     * Хранит вектор и индекс, разыменование возвращает
+     * значение (элементы меняются только через set)
+     */
+    
+    template<class Container>
+    class packed_iterator {
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef typename Container::value_type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef void pointer;
+        typedef value_type reference;
+        
+        packed_iterator() noexcept
+        :container_(nullptr), index_(0) {}
+        
+        packed_iterator(const Container* container, std::size_t index) noexcept
+        :container_(container), index_(index) {}
+        
+        value_type operator *() const {
+            return (*container_)[index_];
+        }
+        
+        value_type operator [](const difference_type &size) const {
+            return (*container_)[index_ + size];
+        }
+        
+        packed_iterator& operator ++() noexcept {
+            ++index_;
+            return *this;
+        }
+        
+        packed_iterator operator ++(int) noexcept {
+            packed_iterator old(*this);
+            ++index_;
+            return old;
+        }
+        
+        packed_iterator& operator --() noexcept {
+            --index_;
+            return *this;
+        }
+        
+        packed_iterator operator --(int) noexcept {
+            packed_iterator old(*this);
+            --index_;
+            return old;
+        }
+        
+        packed_iterator& operator +=(const difference_type &size) noexcept {
+            index_ += size;
+            return *this;
+        }
+        
+        packed_iterator operator +(const difference_type &size) const noexcept {
+            return packed_iterator(container_, index_ + size);
+        }
+        
+        packed_iterator& operator -=(const difference_type &size) noexcept {
+            index_ -= size;
+            return *this;
+        }
+        
+        packed_iterator operator -(const difference_type &size) const noexcept {
+            return packed_iterator(container_, index_ - size);
+        }
+        
+        difference_type operator -(const packed_iterator &other) const noexcept {
+            return difference_type(index_) - difference_type(other.index_);
+        }
+        
+        bool operator ==(const packed_iterator &other) const noexcept {
+            return index_ == other.index_;
+        }
+        
+        bool operator !=(const packed_iterator &other) const noexcept {
+            return index_ != other.index_;
+        }
+        
+        bool operator <(const packed_iterator &other) const noexcept {
+            return index_ < other.index_;
+        }
+        
+        bool operator >(const packed_iterator &other) const noexcept {
+            return index_ > other.index_;
+        }
+        
+        bool operator <=(const packed_iterator &other) const noexcept {
+            return index_ <= other.index_;
+        }
+        
+        bool operator >=(const packed_iterator &other) const noexcept {
+            return index_ >= other.index_;
+        }
+    
+    private:
+        const Container* container_; /*< Вектор*/
+        std::size_t index_; /*< Индекс элемента*/
+    };
+    
+    /********************************************************
+     * \brief Вектор целых с общей шириной в битах
+     ********************************************************
+     * Каждый элемент занимает width() бит в массиве слов
+     * std::uint64_t. Ширина выбирается по наибольшему
+     * значению: если добавляемое значение не помещается,
+     * все элементы переупаковываются в новую ширину (не
+     * более 64 раз за жизнь вектора). Доступ по индексу -
+     * O(1) (одно-два слова), запись - через set. Слова
+     * хранятся в pva::vector с Allocator и GrowthPolicy,
+     * за данными всегда есть запасное слово (нужно
+     * векторной распаковке)
+     */
+    
+    template<class T = std::uint64_t, class Allocator = malloc_allocator<std::uint64_t>,
+             class GrowthPolicy = growth_double>
+    class packed_vector {
+        static_assert(std::is_integral<T>::value && std::is_unsigned<T>::value,
+                      "packed_vector stores unsigned integers");
+        
+        typedef vector<std::uint64_t, Allocator, GrowthPolicy> storage;
+    
+    public:
+        typedef T value_type;
+        typedef std::size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T reference;
+        typedef T const_reference;
+        typedef packed_iterator<packed_vector> iterator;
+        typedef packed_iterator<packed_vector> const_iterator;
+        
+        /**********************************************
+         * Конструктор пустого вектора
+         **********************************************
+         * \param width Начальная ширина элемента в битах
+         */
+        
+        explicit packed_vector(unsigned width = 0)
+        :count_(0), width_(0) {
+            widen(width);
+        }
+        
+        /**********************************************
+         * Конструктор из диапазона [first, last)
+         **********************************************
+         * Ширина выбирается по наибольшему значению
+         * сразу, без переупаковок
+         */
+        
+        template<class InputIt, class = typename std::enable_if<detail::is_iterator<InputIt>::value>::type>
+        packed_vector(InputIt first, InputIt last)
+        :count_(0), width_(0) {
+            if constexpr (detail::is_forward_iterator<InputIt>::value) {
+                std::uint64_t top = 0;
+                std::size_t count = 0;
+                for (InputIt it = first; it != last; ++it, ++count)
+                    top |= std::uint64_t(*it);
+                widen(detail::bit_width(top));
+                reserve(count);
+            }
+            for (; first != last; ++first)
+                push_back(T(*first));
+        }
+        
+        std::size_t size() const noexcept {
+            return count_;
+        }
+        
+        bool empty() const noexcept {
+            return count_ == 0;
+        }
+        
+        /********************************************************
+         * Ширина элемента в битах
+         */
+        
+        unsigned width() const noexcept {
+            return width_;
+        }
+        
+        /********************************************************
+         * Объем упакованных данных в байтах
+         */
+        
+        std::size_t bytes() const noexcept {
+            return words_.capacity() * sizeof(std::uint64_t);
+        }
+        
+        /********************************************************
+         * Выделение памяти под size элементов текущей ширины
+         */
+        
+        void reserve(const std::size_t &size) {
+            words_.reserve(words_for(size, width_));
+        }
+        
+        void shrink_to_fit() {
+            words_.shrink_to_fit();
+        }
+        
+        /********************************************************
+         * Удаление всех элементов (ширина и емкость остаются)
+         */
+        
+        void clear() noexcept {
+            words_.clear();
+            count_ = 0;
+        }
+        
+        /********************************************************
+         * Расширение элементов до width бит
+         ********************************************************
+         * Элементы переупаковываются с конца на месте: новое
+         * поле элемента i не заходит на старые поля
+         * элементов перед ним. Меньшая ширина игнорируется
+         */
+        
+        void widen(unsigned width) {
+            if (width > 64)
+                throw std::length_error("Width of packed element is more than 64 bits!");
+            if (width <= width_)
+                return;
+            if (count_ != 0) {
+                words_.resize(words_for(count_, width), 0);
+                std::uint64_t* words = words_.data();
+                for (std::size_t i = count_; i-- > 0;)
+                    detail::write_bits(words, i * width, width, detail::read_bits(words, i * width_, width_));
+            }
+            width_ = width;
+        }
+        
+        void push_back(T value) {
+            widen(detail::bit_width(value));
+            words_.resize(words_for(count_ + 1, width_), 0);
+            detail::write_bits(words_.data(), count_ * width_, width_, value);
+            ++count_;
+        }
+        
+        void pop_back() {
+            PVA_ASSERT(count_ != 0, "pop_back() on empty packed_vector");
+            --count_;
+        }
+        
+        /********************************************************
+         * Изменение количества элементов
+         ********************************************************
+         * \param size Новое количество элементов
+         * \param value Значение новых элементов
+         */
+        
+        void resize(const std::size_t &size, T value = 0) {
+            widen(detail::bit_width(value));
+            if (size > count_) {
+                words_.resize(words_for(size, width_), 0);
+                for (std::size_t i = count_; i < size; ++i)
+                    detail::write_bits(words_.data(), i * width_, width_, value);
+            }
+            count_ = size;
+        }
+        
+        T operator [](const std::size_t &index) const noexcept {
+            PVA_ASSERT(index < count_, "packed_vector index out of range");
+            return static_cast<T>(detail::read_bits(words_.data(), index * width_, width_));
+        }
+        
+        T at(const std::size_t &index) const {
+            if (index >= count_)
+                throw std::out_of_range("Index more than size of vector!");
+            return (*this)[index];
+        }
+        
+        T front() const noexcept {
+            return (*this)[0];
+        }
+        
+        T back() const noexcept {
+            return (*this)[count_ - 1];
+        }
+        
+        /********************************************************
+         * Запись элемента (при необходимости с расширением)
+         */
+        
+        void set(const std::size_t &index, T value) {
+            if (index >= count_)
+                throw std::out_of_range("Index more than size of vector!");
+            widen(detail::bit_width(value));
+            detail::write_bits(words_.data(), index * width_, width_, value);
+        }
+        
+        /********************************************************
+         * Распаковка count элементов, начиная с first
+         ********************************************************
+         * \param first Индекс первого элемента
+         * \param count Число элементов
+         * \param out Массив под count значений
+         */
+        
+        void decode(const std::size_t &first, const std::size_t &count, T* out) const {
+            if (first > count_ || count > count_ - first)
+                throw std::out_of_range("Decoded range is out of vector!");
+            if (count != 0)
+                detail::unpack_bits(words_.data(), first * width_, width_, count, out);
+        }
+        
+        /********************************************************
+         * Распаковка всего вектора в обычный вектор out
+         */
+        
+        template<class OutAllocator, class OutGrowthPolicy>
+        void decode(vector<T, OutAllocator, OutGrowthPolicy> &out) const {
+            out.clear();
+            out.resize_for_overwrite(count_);
+            decode(0, count_, out.data());
+        }
+        
+        const_iterator begin() const noexcept {
+            return const_iterator(this, 0);
+        }
+        
+        const_iterator end() const noexcept {
+            return const_iterator(this, count_);
+        }
+        
+        void swap(packed_vector &other) noexcept(noexcept(std::declval<storage&>().swap(std::declval<storage&>()))) {
+            words_.swap(other.words_);
+            std::swap(count_, other.count_);
+            std::swap(width_, other.width_);
+        }
+        
+        bool operator ==(const packed_vector &other) const {
+            if (count_ != other.count_)
+                return false;
+            for (std::size_t i = 0; i < count_; ++i)
+                if ((*this)[i] != other[i])
+                    return false;
+            return true;
+        }
+        
+        bool operator !=(const packed_vector &other) const {
+            return !(*this == other);
+        }
+    
+    private:
+        /********************************************************
+         * Число слов под count элементов ширины width вместе
+         * с запасным словом
+         */
+        
+        static std::size_t words_for(const std::size_t &count, unsigned width) noexcept {
+            return count * width / 64 + 2;
+        }
+        
+        storage words_; /*< Упакованные элементы*/
+        std::size_t count_; /*< Число элементов*/
+        unsigned width_; /*< Ширина элемента в битах*/
+    };
+    
+    /********************************************************
+     * \brief Вектор целых, упакованных блоками (frame of
+     * reference)
+     ********************************************************
+     * Элементы делятся на блоки по BlockSize. Блок хранит
+     * заголовок (база - наименьшее значение блока, начало
+     * данных и ширина) и разности элементов с базой,
+     * упакованные в ширину наибольшей разности. Для
+     * упорядоченных идентификаторов разности внутри блока
+     * малы, и элемент занимает несколько бит даже при
+     * больших абсолютных значениях. Доступ по индексу -
+     * O(1): заголовок блока и одно-два слова. Вектор
+     * пополняется только в конец: последний неполный
+     * блок хранится распакованным и упаковывается, когда
+     * заполнится
+     */
+    
+    template<class T = std::uint64_t, std::size_t BlockSize = 128,
+             class Allocator = malloc_allocator<std::uint64_t>, class GrowthPolicy = growth_double>
+    class block_packed_vector {
+        static_assert(std::is_integral<T>::value && std::is_unsigned<T>::value,
+                      "block_packed_vector stores unsigned integers");
+        static_assert(BlockSize > 0, "Block must not be empty");
+        
+        /********************************************************
+         * \brief Заголовок упакованного блока
+         */
+        
+        struct header {
+            T base; /*< Наименьшее значение блока*/
+            std::uint64_t position; /*< Бит начала данных блока, сдвинутый на 8, и ширина в младших 8 битах*/
+        };
+        
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<header> header_allocator;
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<T> value_allocator;
+    
+    public:
+        typedef T value_type;
+        typedef std::size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T reference;
+        typedef T const_reference;
+        typedef packed_iterator<block_packed_vector> iterator;
+        typedef packed_iterator<block_packed_vector> const_iterator;
+        
+        static constexpr std::size_t block_size = BlockSize; /*< Элементов в блоке*/
+        
+        block_packed_vector() {}
+        
+        template<class InputIt, class = typename std::enable_if<detail::is_iterator<InputIt>::value>::type>
+        block_packed_vector(InputIt first, InputIt last) {
+            append(first, last);
+        }
+        
+        std::size_t size() const noexcept {
+            return headers_.size() * BlockSize + tail_.size();
+        }
+        
+        bool empty() const noexcept {
+            return headers_.empty() && tail_.empty();
+        }
+        
+        /********************************************************
+         * Объем данных и заголовков в байтах
+         */
+        
+        std::size_t bytes() const noexcept {
+            return words_.capacity() * sizeof(std::uint64_t) + headers_.capacity() * sizeof(header) +
+                   tail_.capacity() * sizeof(T);
+        }
+        
+        void shrink_to_fit() {
+            words_.shrink_to_fit();
+            headers_.shrink_to_fit();
+        }
+        
+        /********************************************************
+         * Удаление всех элементов (емкость остается)
+         */
+        
+        void clear() noexcept {
+            words_.clear();
+            headers_.clear();
+            tail_.clear();
+            bits_ = 0;
+        }
+        
+        void push_back(T value) {
+            if (tail_.empty())
+                tail_.reserve(BlockSize);
+            tail_.push_back(value);
+            if (tail_.size() == BlockSize)
+                seal();
+        }
+        
+        template<class InputIt, class = typename std::enable_if<detail::is_iterator<InputIt>::value>::type>
+        void append(InputIt first, InputIt last) {
+            for (; first != last; ++first)
+                push_back(T(*first));
+        }
+        
+        T operator [](const std::size_t &index) const noexcept {
+            PVA_ASSERT(index < size(), "block_packed_vector index out of range");
+            const std::size_t block = index / BlockSize;
+            if (block == headers_.size())
+                return tail_[index % BlockSize];
+            const header &current = headers_[block];
+            const unsigned width = unsigned(current.position & 0xFF);
+            return static_cast<T>(current.base + detail::read_bits(words_.data(),
+                                                                   (current.position >> 8) +
+                                                                   (index % BlockSize) * width, width));
+        }
+        
+        T at(const std::size_t &index) const {
+            if (index >= size())
+                throw std::out_of_range("Index more than size of vector!");
+            return (*this)[index];
+        }
+        
+        T front() const noexcept {
+            return (*this)[0];
+        }
+        
+        T back() const noexcept {
+            return (*this)[size() - 1];
+        }
+        
+        /********************************************************
+         * Распаковка всего вектора в обычный вектор out
+         ********************************************************
+         * Блоки распаковываются ядром unpack_bits прямо в
+         * буфер out, затем к ним прибавляется база
+         */
+        
+        template<class OutAllocator, class OutGrowthPolicy>
+        void decode(vector<T, OutAllocator, OutGrowthPolicy> &out) const {
+            out.clear();
+            out.resize_for_overwrite(size());
+            T* target = out.data();
+            for (std::size_t block = 0; block < headers_.size(); ++block, target += BlockSize) {
+                const header &current = headers_[block];
+                detail::unpack_bits(words_.data(), current.position >> 8, unsigned(current.position & 0xFF),
+                                    BlockSize, target);
+                const T base = current.base;
+                for (std::size_t i = 0; i < BlockSize; ++i)
+                    target[i] += base;
+            }
+            for (std::size_t i = 0; i < tail_.size(); ++i)
+                target[i] = tail_[i];
+        }
+        
+        const_iterator begin() const noexcept {
+            return const_iterator(this, 0);
+        }
+        
+        const_iterator end() const noexcept {
+            return const_iterator(this, size());
+        }
+        
+        void swap(block_packed_vector &other) noexcept {
+            words_.swap(other.words_);
+            headers_.swap(other.headers_);
+            tail_.swap(other.tail_);
+            std::swap(bits_, other.bits_);
+        }
+    
+    private:
+        /********************************************************
+         * Упаковка заполненного последнего блока
+         */
+        
+        void seal() {
+            T base = tail_[0];
+            T top = tail_[0];
+            for (std::size_t i = 1; i < BlockSize; ++i) {
+                base = tail_[i] < base ? tail_[i] : base;
+                top = tail_[i] > top ? tail_[i] : top;
+            }
+            const unsigned width = detail::bit_width(std::uint64_t(top - base));
+            words_.resize((bits_ + BlockSize * width) / 64 + 2, 0);
+            std::uint64_t* words = words_.data();
+            for (std::size_t i = 0; i < BlockSize; ++i)
+                detail::write_bits(words, bits_ + i * width, width, std::uint64_t(tail_[i] - base));
+            headers_.push_back(header{base, (std::uint64_t(bits_) << 8) | width});
+            bits_ += BlockSize * width;
+            tail_.clear();
+        }
+        
+        vector<std::uint64_t, Allocator, GrowthPolicy> words_; /*< Упакованные разности блоков*/
+        vector<header, header_allocator, GrowthPolicy> headers_; /*< Заголовки блоков*/
+        vector<T, value_allocator> tail_; /*< Неполный последний блок*/
+        std::size_t bits_ = 0; /*< Занято бит в words_*/
+    };
+}
@@ -0,0 +1,931 @@
+/********************************************************
+ * \file
+ * \brief Заголовочный файл с параллельными алгоритмами
+ ********************************************************
+ * Файл содержит в себе пул потоков с перехватом задач
+ * 'parallel::thread_pool', параллельные for_each,
+ * transform, reduce, sort и fill над 'vector' и политику
+ * 'parallel::par' параллельного создания векторов с
+ * размещением страниц по узлам NUMA
+ */
+
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace pva {
+    
+    namespace detail {
+        
+        /********************************************************
+         * Режимы mbind/get_mempolicy (linux/mempolicy.h)
+         */
+        
+        const int mpol_bind = 2; /*< Страницы только на узлах маски*/
+        const int mpol_interleave = 3; /*< Страницы по очереди на узлах маски*/
+        const int mpol_f_mems_allowed = 1 << 2; /*< get_mempolicy: доступные узлы*/
+        
+        /********************************************************
+         * Маска узлов NUMA, на которых потоку можно выделять
+         * память (до 64 узлов)
+         ********************************************************
+         * \return Маску узлов или 0, если ядро не поддерживает
+         * NUMA или вызов запрещен
+         */
+        
+        inline unsigned long numa_nodes() noexcept {
+#if defined(__linux__) && defined(SYS_get_mempolicy)
+            static const unsigned long nodes = [] {
+                int mode = 0;
+                unsigned long mask = 0;
+                if (syscall(SYS_get_mempolicy, &mode, &mask, sizeof(mask) * 8 + 1, nullptr, mpol_f_mems_allowed) != 0)
+                    return 0ul;
+                return mask;
+            }();
+            return nodes;
+#else
+            return 0;
+#endif
+        }
+        
+        /********************************************************
+         * Размещение целых страниц [data, data + bytes) на
+         * узлах mask (mbind)
+         ********************************************************
+         * Действует на страницы, которых еще не касались:
+         * уже созданные страницы не переносятся
+         ********************************************************
+         * \return True - если политика страниц установлена
+         */
+        
+        inline bool numa_place(void* data, std::size_t bytes, int mode, unsigned long mask) noexcept {
+#if defined(__linux__) && defined(SYS_mbind)
+            const std::uintptr_t page = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+            const std::uintptr_t first = (reinterpret_cast<std::uintptr_t>(data) + page - 1) / page * page;
+            const std::uintptr_t last = (reinterpret_cast<std::uintptr_t>(data) + bytes) / page * page;
+            if (last <= first)
+                return false;
+            return syscall(SYS_mbind, first, last - first, mode, &mask, sizeof(mask) * 8 + 1, 0) == 0;
+#else
+            (void)data;
+            (void)bytes;
+            (void)mode;
+            (void)mask;
+            return false;
+#endif
+        }
+    }
+    
+    /********************************************************
+     * \brief Пространство имен параллельных алгоритмов
+     */
+    
+    namespace parallel {
+        
+        /********************************************************
+         * \brief Разбиение диапазона на куски
+         ********************************************************
+         * Диапазон [0, count) делится пополам, пока куски
+         * больше grain. Точки деления кратны align со сдвигом
+         * offset, чтобы границы кусков попадали на границы
+         * кэш-линий и потоки не писали в одну линию
+         */
+        
+        struct partition {
+            std::size_t grain = 1; /*< Размер куска, который уже не делится*/
+            std::size_t align = 1; /*< Кратность точек деления*/
+            std::size_t offset = 0; /*< Сдвиг точек деления*/
+        };
+        
+        /********************************************************
+         * Разбиение массива на куски по кэш-линиям
+         ********************************************************
+         * \param data Начало массива
+         * \param grain Минимальный размер куска в байтах
+         * \param line Граница кусков в байтах (64 - кэш-линия,
+         * 4096 - страница)
+         * \return Разбиение, границы которого выровнены на line байт
+         */
+        
+        template<class T>
+        inline partition partition_for(const T* data, std::size_t grain = 16384, std::size_t line = 64) {
+            partition result;
+            result.grain = grain / sizeof(T) ? grain / sizeof(T) : 1;
+            if (line % sizeof(T) == 0) {
+                result.align = line / sizeof(T);
+                const std::size_t misalign = reinterpret_cast<std::uintptr_t>(data) % line;
+                if (misalign % sizeof(T) == 0)
+                    result.offset = misalign / sizeof(T);
+            }
+            if (result.grain < result.align)
+                result.grain = result.align;
+            return result;
+        }
+        
+        /********************************************************
+         * \brief Пул потоков с перехватом задач (work stealing)
+         ********************************************************
+         * У каждого потока своя очередь кусков. Поток берет
+         * куски с конца своей очереди, а без работы перехватывает
+         * самые большие куски из начала чужих очередей. Поток,
+         * вызвавший run(), тоже работает, пока диапазон не будет
+         * обработан, поэтому вложенные вызовы не блокируют пул.
+         * Пул из N потоков запускает N - 1 рабочий поток
+         */
+        
+        class thread_pool {
+        public:
+            /**********************************************
+             * Число потоков по умолчанию
+             **********************************************
+             * Переменная окружения PVA_THREADS или число
+             * аппаратных потоков
+             */
+            
+            static std::size_t default_threads() {
+                if (const char* env = std::getenv("PVA_THREADS")) {
+                    const long threads = std::atol(env);
+                    if (threads > 0)
+                        return static_cast<std::size_t>(threads);
+                }
+                const unsigned threads = std::thread::hardware_concurrency();
+                return threads ? threads : 1;
+            }
+            
+            /**********************************************
+             * Конструктор
+             **********************************************
+             * \param threads Число потоков, включая вызывающий
+             */
+            
+            explicit thread_pool(std::size_t threads = default_threads())
+            :workers_(threads > 1 ? threads - 1 : 0),
+             queues_(new queue[workers_ + 1]),
+             threads_(new std::thread[workers_]) {
+                for (std::size_t i = 0; i < workers_; ++i)
+                    threads_[i] = std::thread(&thread_pool::work, this, i);
+            }
+            
+            thread_pool(const thread_pool &) = delete;
+            thread_pool& operator =(const thread_pool &) = delete;
+            
+            /**********************************************
+             * Деструктор
+             **********************************************
+             * Дожидается завершения рабочих потоков
+             */
+            
+            ~thread_pool() {
+                {
+                    std::lock_guard<std::mutex> lock(sleep_mutex_);
+                    stop_ = true;
+                }
+                wake_.notify_all();
+                for (std::size_t i = 0; i < workers_; ++i)
+                    threads_[i].join();
+            }
+            
+            /********************************************************
+             * Число потоков пула, включая вызывающий
+             */
+            
+            std::size_t threads() const noexcept {
+                return workers_ + 1;
+            }
+            
+            /********************************************************
+             * Закрепление рабочих потоков за процессорами
+             ********************************************************
+             * Рабочий поток k закрепляется за k-м (по кругу)
+             * процессором из доступных процессу, вызывающий поток
+             * не закрепляется. Тогда кусок k в run_static каждый
+             * раз обрабатывается на том же процессоре и узле NUMA,
+             * и планировщик не уводит поток от его страниц.
+             * Закрепление действует до уничтожения пула, поэтому
+             * пул сам его не включает: вызывается явно для своего
+             * пула. Повторные вызовы ничего не делают
+             ********************************************************
+             * \return True - если потоки закреплены
+             */
+            
+            bool pin_workers() {
+                std::lock_guard<std::mutex> lock(sleep_mutex_);
+                if (pin_tried_)
+                    return pinned_;
+                pin_tried_ = true;
+#if defined(__linux__)
+                cpu_set_t allowed;
+                if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+                    return false;
+                int cpus[CPU_SETSIZE];
+                std::size_t count = 0;
+                for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+                    if (CPU_ISSET(cpu, &allowed))
+                        cpus[count++] = cpu;
+                if (count == 0)
+                    return false;
+                pinned_ = true;
+                for (std::size_t k = 0; k < workers_; ++k) {
+                    cpu_set_t one;
+                    CPU_ZERO(&one);
+                    CPU_SET(cpus[k % count], &one);
+                    if (pthread_setaffinity_np(threads_[k].native_handle(), sizeof(one), &one) != 0)
+                        pinned_ = false;
+                }
+#endif
+                return pinned_;
+            }
+            
+            /********************************************************
+             * Параллельная обработка диапазона
+             ********************************************************
+             * Вызывает function(begin, end) для кусков, которые
+             * вместе покрывают [0, count), и возвращается, когда
+             * все куски обработаны. Первое исключение из function
+             * пробрасывается вызывающему, оставшиеся куски при
+             * этом пропускаются
+             ********************************************************
+             * \param count Размер диапазона
+             * \param part Разбиение на куски
+             * \param function Обработчик куска
+             */
+            
+            template<class Function>
+            void run(std::size_t count, const partition &part, Function &&function) {
+                if (count == 0)
+                    return;
+                if (workers_ == 0 || count <= part.grain) {
+                    function(std::size_t(0), count);
+                    return;
+                }
+                job_impl<typename std::remove_reference<Function>::type> current(function, count, part);
+                const std::size_t self = current_queue();
+                process(task{&current, 0, count}, self);
+                while (current.remaining.load(std::memory_order_acquire) != 0) {
+                    task next;
+                    if (take(self, next))
+                        process(next, self);
+                    else
+                        std::this_thread::yield();
+                }
+                if (current.error)
+                    std::rethrow_exception(current.error);
+            }
+            
+            /********************************************************
+             * Обработка диапазона по куску на поток
+             ********************************************************
+             * [0, count) делится на threads() равных кусков с
+             * границами по part.align и part.offset. Кусок k
+             * обрабатывает k-й рабочий поток, последний -
+             * вызывающий, куски не перехватываются. При одинаковом
+             * разбиении каждый поток снова получает свой кусок:
+             * так вектор создается на тех потоках (и узлах NUMA),
+             * которые будут его обрабатывать. Исключения - как в run()
+             ********************************************************
+             * \param count Размер диапазона
+             * \param part Выравнивание границ кусков (grain не
+             * используется)
+             * \param function Обработчик куска
+             */
+            
+            template<class Function>
+            void run_static(std::size_t count, const partition &part, Function &&function) {
+                if (count == 0)
+                    return;
+                if (workers_ == 0) {
+                    function(std::size_t(0), count);
+                    return;
+                }
+                partition whole;
+                whole.grain = count;
+                job_impl<typename std::remove_reference<Function>::type> current(function, count, whole);
+                const std::size_t slices = workers_ + 1;
+                auto bound = [&](std::size_t k) {
+                    if (k == slices)
+                        return count;
+                    const std::size_t value = count / slices * k + count % slices * k / slices;
+                    const std::size_t excess = (value + part.offset) % part.align;
+                    return excess < value ? value - excess : std::size_t(0);
+                };
+                {
+                    std::lock_guard<std::mutex> lock(sleep_mutex_);
+                    for (std::size_t k = 0; k < workers_; ++k) {
+                        if (bound(k) >= bound(k + 1))
+                            continue;
+                        std::lock_guard<std::mutex> queue_lock(queues_[k].mutex);
+                        queues_[k].pinned.push_back(task{&current, bound(k), bound(k + 1)});
+                        queues_[k].pinned_count.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                wake_.notify_all();
+                const std::size_t self = current_queue();
+                if (bound(workers_) < count)
+                    process(task{&current, bound(workers_), count}, self);
+                while (current.remaining.load(std::memory_order_acquire) != 0) {
+                    task next;
+                    if (take(self, next))
+                        process(next, self);
+                    else
+                        std::this_thread::yield();
+                }
+                if (current.error)
+                    std::rethrow_exception(current.error);
+            }
+        
+        private:
+            /********************************************************
+             * \brief Обрабатываемый диапазон
+             */
+            
+            struct job {
+                job(std::size_t count, const partition &part)
+                :remaining(count), part(part) {}
+                
+                virtual ~job() = default;
+                virtual void execute(std::size_t begin, std::size_t end) = 0;
+                
+                std::atomic<std::size_t> remaining; /*< Число еще не обработанных элементов*/
+                partition part; /*< Разбиение на куски*/
+                std::atomic<bool> failed{false}; /*< Обработчик бросил исключение*/
+                std::exception_ptr error; /*< Первое брошенное исключение*/
+            };
+            
+            template<class Function>
+            struct job_impl : job {
+                job_impl(Function &function, std::size_t count, const partition &part)
+                :job(count, part), function(function) {}
+                
+                void execute(std::size_t begin, std::size_t end) override {
+                    function(begin, end);
+                }
+                
+                Function &function; /*< Обработчик куска*/
+            };
+            
+            /********************************************************
+             * \brief Кусок диапазона в очереди
+             */
+            
+            struct task {
+                job* owner; /*< Диапазон, которому принадлежит кусок*/
+                std::size_t begin; /*< Начало куска*/
+                std::size_t end; /*< Конец куска*/
+            };
+            
+            /********************************************************
+             * \brief Очередь кусков потока
+             ********************************************************
+             * Выровнена на кэш-линию, чтобы соседние очереди не
+             * мешали друг другу
+             */
+            
+            struct alignas(64) queue {
+                std::mutex mutex; /*< Защищает tasks и pinned*/
+                std::deque<task> tasks; /*< Куски, ожидающие обработки*/
+                std::deque<task> pinned; /*< Куски run_static, которые нельзя перехватывать*/
+                std::atomic<std::size_t> pinned_count{0}; /*< Размер pinned*/
+            };
+            
+            /********************************************************
+             * Индекс очереди текущего потока
+             ********************************************************
+             * У рабочих потоков своя очередь, остальные потоки
+             * кладут куски в общую очередь с индексом workers_
+             */
+            
+            std::size_t current_queue() const noexcept {
+                return current_pool_ == this ? current_index_ : workers_;
+            }
+            
+            /********************************************************
+             * Добавление куска в очередь и пробуждение потока
+             */
+            
+            void push(const task &next, std::size_t index) {
+                {
+                    std::lock_guard<std::mutex> lock(queues_[index].mutex);
+                    queues_[index].tasks.push_back(next);
+                }
+                {
+                    std::lock_guard<std::mutex> lock(sleep_mutex_);
+                    queued_.fetch_add(1, std::memory_order_relaxed);
+                }
+                wake_.notify_one();
+            }
+            
+            /********************************************************
+             * Поиск куска для обработки
+             ********************************************************
+             * Сначала закрепленные за потоком куски, затем конец
+             * своей очереди, затем начало общей и чужих очередей
+             ********************************************************
+             * \param index Очередь текущего потока
+             * \param next Найденный кусок
+             * \return True - если кусок найден
+             */
+            
+            bool take(std::size_t index, task &next) {
+                if (queues_[index].pinned_count.load(std::memory_order_relaxed) != 0) {
+                    std::lock_guard<std::mutex> lock(queues_[index].mutex);
+                    if (!queues_[index].pinned.empty()) {
+                        next = queues_[index].pinned.front();
+                        queues_[index].pinned.pop_front();
+                        queues_[index].pinned_count.fetch_sub(1, std::memory_order_relaxed);
+                        return true;
+                    }
+                }
+                if (queued_.load(std::memory_order_relaxed) == 0)
+                    return false;
+                {
+                    std::lock_guard<std::mutex> lock(queues_[index].mutex);
+                    if (!queues_[index].tasks.empty()) {
+                        next = queues_[index].tasks.back();
+                        queues_[index].tasks.pop_back();
+                        queued_.fetch_sub(1, std::memory_order_relaxed);
+                        return true;
+                    }
+                }
+                for (std::size_t i = 1; i <= workers_; ++i) {
+                    queue &victim = queues_[(index + i) % (workers_ + 1)];
+                    std::lock_guard<std::mutex> lock(victim.mutex);
+                    if (!victim.tasks.empty()) {
+                        next = victim.tasks.front();
+                        victim.tasks.pop_front();
+                        queued_.fetch_sub(1, std::memory_order_relaxed);
+                        return true;
+                    }
+                }
+                return false;
+            }
+            
+            /********************************************************
+             * Обработка куска
+             ********************************************************
+             * Пока кусок больше grain, его правая половина
+             * отдается в очередь для перехвата
+             */
+            
+            void process(task current, std::size_t index) {
+                job &owner = *current.owner;
+                const partition &part = owner.part;
+                while (current.end - current.begin > part.grain) {
+                    std::size_t middle = current.begin + (current.end - current.begin) / 2;
+                    middle -= (middle + part.offset) % part.align;
+                    if (middle <= current.begin)
+                        break;
+                    push(task{&owner, middle, current.end}, index);
+                    current.end = middle;
+                }
+                if (!owner.failed.load(std::memory_order_relaxed)) {
+                    try {
+                        owner.execute(current.begin, current.end);
+                    }
+                    catch (...) {
+                        if (!owner.failed.exchange(true))
+                            owner.error = std::current_exception();
+                    }
+                }
+                owner.remaining.fetch_sub(current.end - current.begin, std::memory_order_acq_rel);
+            }
+            
+            /********************************************************
+             * Цикл рабочего потока
+             */
+            
+            void work(std::size_t index) {
+                current_pool_ = this;
+                current_index_ = index;
+                for (;;) {
+                    task next;
+                    if (take(index, next)) {
+                        process(next, index);
+                        continue;
+                    }
+                    std::unique_lock<std::mutex> lock(sleep_mutex_);
+                    wake_.wait(lock, [this, index] {
+                        return stop_ || queued_.load(std::memory_order_relaxed) != 0 ||
+                               queues_[index].pinned_count.load(std::memory_order_relaxed) != 0;
+                    });
+                    if (stop_ && queued_.load(std::memory_order_relaxed) == 0)
+                        return;
+                }
+            }
+            
+            inline static thread_local const thread_pool* current_pool_ = nullptr; /*< Пул текущего потока*/
+            inline static thread_local std::size_t current_index_ = 0; /*< Очередь текущего потока*/
+            
+            std::size_t workers_; /*< Число рабочих потоков*/
+            std::unique_ptr<queue[]> queues_; /*< Очереди рабочих потоков и общая очередь*/
+            std::unique_ptr<std::thread[]> threads_; /*< Рабочие потоки*/
+            std::atomic<std::size_t> queued_{0}; /*< Число кусков во всех очередях*/
+            std::mutex sleep_mutex_; /*< Защищает stop_, закрепление и ожидание работы*/
+            std::condition_variable wake_; /*< Пробуждение рабочих потоков*/
+            bool stop_ = false; /*< Пул уничтожается*/
+            bool pin_tried_ = false; /*< pin_workers() уже вызывался*/
+            bool pinned_ = false; /*< Рабочие потоки закреплены за процессорами*/
+        };
+        
+        /********************************************************
+         * Пул по умолчанию
+         ********************************************************
+         * Создается при первом обращении, число потоков - см.
+         * thread_pool::default_threads()
+         */
+        
+        inline thread_pool& default_pool() {
+            static thread_pool pool;
+            return pool;
+        }
+        
+        /********************************************************
+         * Параллельный вызов f для каждого элемента вектора
+         ********************************************************
+         * \param pool Пул потоков
+         * \param v Вектор
+         * \param f Функция от ссылки на элемент
+         */
+        
+        template<class T, class Allocator, class GrowthPolicy, class Function>
+        inline void for_each(thread_pool &pool, vector<T, Allocator, GrowthPolicy> &v, Function f) {
+            T* data = v.data();
+            pool.run(v.size(), partition_for(data), [data, &f](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; ++i)
+                    f(data[i]);
+            });
+        }
+        
+        template<class T, class Allocator, class GrowthPolicy, class Function>
+        inline void for_each(vector<T, Allocator, GrowthPolicy> &v, Function f) {
+            for_each(default_pool(), v, f);
+        }
+        
+        /********************************************************
+         * Параллельное преобразование вектора
+         ********************************************************
+         * out[i] = f(in[i]). Размер out становится равным
+         * размеру in (новые элементы создаются конструктором
+         * по умолчанию, затем присваиваются). in и out могут
+         * быть одним вектором
+         ********************************************************
+         * \param pool Пул потоков
+         * \param in Исходный вектор
+         * \param out Вектор результатов
+         * \param f Функция от элемента in
+         */
+        
+        template<class T, class A1, class G1, class U, class A2, class G2, class Function>
+        inline void transform(thread_pool &pool, const vector<T, A1, G1> &in, vector<U, A2, G2> &out, Function f) {
+            out.resize(in.size());
+            const T* source = in.data();
+            U* target = out.data();
+            pool.run(in.size(), partition_for(target), [source, target, &f](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; ++i)
+                    target[i] = f(source[i]);
+            });
+        }
+        
+        template<class T, class A1, class G1, class U, class A2, class G2, class Function>
+        inline void transform(const vector<T, A1, G1> &in, vector<U, A2, G2> &out, Function f) {
+            transform(default_pool(), in, out, f);
+        }
+        
+        /********************************************************
+         * Параллельная свертка вектора
+         ********************************************************
+         * Куски сворачиваются независимо, затем результаты
+         * кусков сворачиваются с init. Как и у std::reduce,
+         * порядок применения op не определен: op должна быть
+         * ассоциативной и коммутативной
+         ********************************************************
+         * \param pool Пул потоков
+         * \param v Вектор
+         * \param init Начальное значение
+         * \param op Бинарная операция
+         * \return Свертка init и всех элементов
+         */
+        
+        template<class T, class Allocator, class GrowthPolicy, class U, class BinaryOp>
+        inline U reduce(thread_pool &pool, const vector<T, Allocator, GrowthPolicy> &v, U init, BinaryOp op) {
+            const T* data = v.data();
+            const std::size_t count = v.size();
+            const std::size_t grain = partition_for(data).grain;
+            std::size_t parts = (count + grain - 1) / grain;
+            if (parts > pool.threads() * 8)
+                parts = pool.threads() * 8;
+            if (parts <= 1) {
+                for (std::size_t i = 0; i < count; ++i)
+                    init = op(init, data[i]);
+                return init;
+            }
+            struct alignas(64) slot {
+                std::optional<U> value; /*< Свертка куска*/
+            };
+            std::unique_ptr<slot[]> partial(new slot[parts]);
+            pool.run(parts, partition(), [&](std::size_t first, std::size_t last) {
+                for (std::size_t k = first; k < last; ++k) {
+                    const std::size_t begin = count * k / parts;
+                    const std::size_t end = count * (k + 1) / parts;
+                    U value = data[begin];
+                    for (std::size_t i = begin + 1; i < end; ++i)
+                        value = op(value, data[i]);
+                    partial[k].value.emplace(pva::move(value));
+                }
+            });
+            for (std::size_t k = 0; k < parts; ++k)
+                init = op(init, *partial[k].value);
+            return init;
+        }
+        
+        template<class T, class Allocator, class GrowthPolicy, class U, class BinaryOp>
+        inline U reduce(const vector<T, Allocator, GrowthPolicy> &v, U init, BinaryOp op) {
+            return reduce(default_pool(), v, pva::move(init), op);
+        }
+        
+        template<class T, class Allocator, class GrowthPolicy, class U>
+        inline U reduce(const vector<T, Allocator, GrowthPolicy> &v, U init) {
+            return reduce(default_pool(), v, pva::move(init), std::plus<>());
+        }
+        
+        /********************************************************
+         * Параллельная сортировка вектора
+         ********************************************************
+         * Вектор делится на куски по числу потоков, куски
+         * сортируются std::sort параллельно, затем сливаются
+         * попарно std::inplace_merge, на каждом уровне слияния
+         * тоже параллельно. Сортировка неустойчивая
+         ********************************************************
+         * \param pool Пул потоков
+         * \param v Вектор
+         * \param comp Сравнение элементов
+         */
+        
+        template<class T, class Allocator, class GrowthPolicy, class Compare>
+        inline void sort(thread_pool &pool, vector<T, Allocator, GrowthPolicy> &v, Compare comp) {
+            T* data = v.data();
+            const std::size_t count = v.size();
+            const std::size_t grain = partition_for(data).grain;
+            std::size_t parts = pool.threads() * 4;
+            if (parts > count / grain)
+                parts = count / grain;
+            if (parts <= 1) {
+                std::sort(data, data + count, comp);
+                return;
+            }
+            auto bound = [count, parts](std::size_t k) {
+                return count * (k < parts ? k : parts) / parts;
+            };
+            pool.run(parts, partition(), [&](std::size_t first, std::size_t last) {
+                for (std::size_t k = first; k < last; ++k)
+                    std::sort(data + bound(k), data + bound(k + 1), comp);
+            });
+            for (std::size_t width = 1; width < parts; width *= 2) {
+                const std::size_t pairs = (parts + 2 * width - 1) / (2 * width);
+                pool.run(pairs, partition(), [&](std::size_t first, std::size_t last) {
+                    for (std::size_t p = first; p < last; ++p) {
+                        const std::size_t low = 2 * width * p;
+                        if (low + width < parts)
+                            std::inplace_merge(data + bound(low), data + bound(low + width),
+                                               data + bound(low + 2 * width), comp);
+                    }
+                });
+            }
+        }
+        
+        template<class T, class Allocator, class GrowthPolicy, class Compare>
+        inline void sort(vector<T, Allocator, GrowthPolicy> &v, Compare comp) {
+            sort(default_pool(), v, comp);
+        }
+        
+        template<class T, class Allocator, class GrowthPolicy>
+        inline void sort(thread_pool &pool, vector<T, Allocator, GrowthPolicy> &v) {
+            sort(pool, v, std::less<>());
+        }
+        
+        template<class T, class Allocator, class GrowthPolicy>
+        inline void sort(vector<T, Allocator, GrowthPolicy> &v) {
+            sort(default_pool(), v, std::less<>());
+        }
+        
+        /********************************************************
+         * Параллельное заполнение вектора значением
+         ********************************************************
+         * \param pool Пул потоков
+         * \param v Вектор
+         * \param value Значение
+         */
+        
+        template<class T, class Allocator, class GrowthPolicy>
+        inline void fill(thread_pool &pool, vector<T, Allocator, GrowthPolicy> &v, const T &value) {
+            T* data = v.data();
+            pool.run(v.size(), partition_for(data), [data, &value](std::size_t begin, std::size_t end) {
+                std::fill(data + begin, data + end, value);
+            });
+        }
+        
+        template<class T, class Allocator, class GrowthPolicy>
+        inline void fill(vector<T, Allocator, GrowthPolicy> &v, const T &value) {
+            fill(default_pool(), v, value);
+        }
+        
+        /********************************************************
+         * \brief Размещение страниц вектора по узлам NUMA
+         */
+        
+        enum class numa_placement {
+            first_touch, /*< Страница на узле потока, который ее создал*/
+            interleave, /*< Страницы по очереди на всех узлах*/
+            bind /*< Все страницы на одном узле*/
+        };
+        
+        /********************************************************
+         * \brief Политика параллельного создания вектора
+         ********************************************************
+         * Передается в конструкторы и assign вектора:
+         * vector<double> v(n, 0.0, parallel::par). Элементы
+         * создаются кусками через thread_pool::run_static, по
+         * куску на поток пула. По умолчанию страницы ложатся
+         * на узел NUMA потока, который их создал (first touch),
+         * и for_each, transform и fill с той же политикой (то
+         * же разбиение через run_static) идут по локальной
+         * памяти. Остальные вызовы алгоритмов перехватывают
+         * работу и о страницах не заботятся. Чтобы планировщик
+         * не уводил потоки от их страниц, рабочие потоки своего
+         * пула можно закрепить (thread_pool::pin_workers).
+         * interleave() и bind() задают размещение через mbind;
+         * если ядро без NUMA или вызов запрещен, остается first
+         * touch. Буферы
+         * меньше place_threshold байт не размещаются, как и
+         * буферы, не занимающие своих страниц (см.
+         * owns_pages у malloc_allocator и aligned_allocator)
+         */
+        
+        class policy : public pva::detail::parallel_policy {
+        public:
+            static constexpr std::size_t place_threshold = std::size_t(1) << 20; /*< Минимальный размещаемый буфер*/
+            
+            constexpr policy() noexcept
+            :pool_(nullptr), placement_(numa_placement::first_touch), node_(0) {}
+            
+            /********************************************************
+             * Политика с пулом pool вместо default_pool()
+             */
+            
+            policy on(thread_pool &pool) const noexcept {
+                policy result(*this);
+                result.pool_ = &pool;
+                return result;
+            }
+            
+            /********************************************************
+             * Политика, чередующая страницы по всем узлам NUMA
+             */
+            
+            policy interleave() const noexcept {
+                policy result(*this);
+                result.placement_ = numa_placement::interleave;
+                return result;
+            }
+            
+            /********************************************************
+             * Политика, размещающая страницы на узле node
+             */
+            
+            policy bind(unsigned node) const noexcept {
+                policy result(*this);
+                result.placement_ = numa_placement::bind;
+                result.node_ = node;
+                return result;
+            }
+            
+            thread_pool& pool() const {
+                return pool_ ? *pool_ : default_pool();
+            }
+            
+            numa_placement placement() const noexcept {
+                return placement_;
+            }
+            
+            /********************************************************
+             * Размещение страниц нового буфера
+             ********************************************************
+             * \param data Буфер
+             * \param bytes Размер буфера в байтах
+             * \return True - если размещение задано через mbind
+             */
+            
+            bool place(void* data, std::size_t bytes) const noexcept {
+                if (placement_ == numa_placement::first_touch || bytes < place_threshold)
+                    return false;
+                const unsigned long nodes = pva::detail::numa_nodes();
+                if (placement_ == numa_placement::interleave) {
+                    if ((nodes & (nodes - 1)) == 0)
+                        return false;
+                    return pva::detail::numa_place(data, bytes, pva::detail::mpol_interleave, nodes);
+                }
+                if (node_ >= sizeof(nodes) * 8 || !(nodes >> node_ & 1))
+                    return false;
+                return pva::detail::numa_place(data, bytes, pva::detail::mpol_bind, 1ul << node_);
+            }
+            
+            /********************************************************
+             * Обработка [0, count) элементов data по куску на поток
+             ********************************************************
+             * Границы кусков выровнены на страницы data
+             */
+            
+            template<class T, class Function>
+            void run(std::size_t count, const T* data, Function &&function) const {
+                pool().run_static(count, partition_for(data, 0, 4096), pva::forward<Function>(function));
+            }
+            
+            /********************************************************
+             * Наибольшее число кусков в run() - по одному на поток
+             */
+            
+            std::size_t slices() const {
+                return pool().threads();
+            }
+        
+        private:
+            thread_pool* pool_; /*< Пул (nullptr - default_pool())*/
+            numa_placement placement_; /*< Размещение страниц*/
+            unsigned node_; /*< Узел для bind*/
+        };
+        
+        inline constexpr policy par{}; /*< Параллельное создание на default_pool() с first touch*/
+        
+        /********************************************************
+         * Параллельный вызов f для каждого элемента вектора
+         * по куску на поток политики
+         ********************************************************
+         * Куски не перехватываются и совпадают с кусками, на
+         * которых вектор был создан с той же политикой: поток
+         * обрабатывает свои страницы. Медленный кусок
+         * задерживает весь вызов
+         ********************************************************
+         * \param policy Политика, например parallel::par
+         * \param v Вектор
+         * \param f Функция от ссылки на элемент
+         */
+        
+        template<class T, class Allocator, class GrowthPolicy, class Function>
+        inline void for_each(const policy &policy, vector<T, Allocator, GrowthPolicy> &v, Function f) {
+            T* data = v.data();
+            policy.run(v.size(), data, [data, &f](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; ++i)
+                    f(data[i]);
+            });
+        }
+        
+        /********************************************************
+         * Параллельное преобразование вектора по куску на поток
+         * политики (разбиение по страницам out, см. for_each)
+         */
+        
+        template<class T, class A1, class G1, class U, class A2, class G2, class Function>
+        inline void transform(const policy &policy, const vector<T, A1, G1> &in, vector<U, A2, G2> &out, Function f) {
+            out.resize(in.size());
+            const T* source = in.data();
+            U* target = out.data();
+            policy.run(in.size(), target, [source, target, &f](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; ++i)
+                    target[i] = f(source[i]);
+            });
+        }
+        
+        /********************************************************
+         * Параллельное заполнение вектора по куску на поток
+         * политики (см. for_each)
+         */
+        
+        template<class T, class Allocator, class GrowthPolicy>
+        inline void fill(const policy &policy, vector<T, Allocator, GrowthPolicy> &v, const T &value) {
+            T* data = v.data();
+            policy.run(v.size(), data, [data, &value](std::size_t begin, std::size_t end) {
+                std::fill(data + begin, data + end, value);
+            });
+        }
+    }
+}
@@ -0,0 +1,161 @@
+/********************************************************
+ * \file
+ * \brief Заголовочный файл с описанием итератора 'segmented_iterator'
+ ********************************************************
+ * Файл содержит в себе итератор по индексу для контейнеров,
+ * элементы которых не лежат одним массивом
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace pva {
+    
+    /********************************************************
+     * \brief Итератор по индексу элемента
+     ********************************************************
+     * Хранит вектор и индекс элемента: элементы лежат не
+     * одним массивом (в сегментах concurrent_vector, в двух
+     * буферах incremental_vector), поэтому указатель на
+     * элемент нельзя просто сдвигать. Итератор произвольного
+     * доступа
+     */
+    
+    template<class Container, class T>
+    class segmented_iterator {
+        template<class, class>
+        friend class segmented_iterator;
+    
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef typename std::remove_cv<T>::type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T* pointer;
+        typedef T& reference;
+        
+        /**********************************************
+         * Конструктор по умолчанию
+         */
+        
+        segmented_iterator() noexcept
+        :container_(nullptr), index_(0) {}
+        
+        /**********************************************
+         * Конструктор итератора на элемент
+         **********************************************
+         * \param container Вектор
+         * \param index Индекс элемента
+         */
+        
+        segmented_iterator(Container* container, std::size_t index) noexcept
+        :container_(container), index_(index) {}
+        
+        /**********************************************
+         * Преобразование итератора в константный
+         */
+        
+        template<class C, class U, class = typename std::enable_if<
+            std::is_same<const C, Container>::value && std::is_same<const U, T>::value>::type>
+        segmented_iterator(const segmented_iterator<C, U> &copy) noexcept
+        :container_(copy.container_), index_(copy.index_) {}
+        
+        T& operator *() const {
+            return (*container_)[index_];
+        }
+        
+        T* operator ->() const {
+            return &(*container_)[index_];
+        }
+        
+        T& operator [](const difference_type &offset) const {
+            return (*container_)[index_ + offset];
+        }
+        
+        segmented_iterator& operator ++() {
+            ++index_;
+            return *this;
+        }
+        
+        segmented_iterator operator ++(int) {
+            segmented_iterator old(*this);
+            ++index_;
+            return old;
+        }
+        
+        segmented_iterator& operator --() {
+            --index_;
+            return *this;
+        }
+        
+        segmented_iterator operator --(int) {
+            segmented_iterator old(*this);
+            --index_;
+            return old;
+        }
+        
+        segmented_iterator& operator +=(const difference_type &size) {
+            index_ += size;
+            return *this;
+        }
+        
+        segmented_iterator operator +(const difference_type &size) const {
+            return segmented_iterator(container_, index_ + size);
+        }
+        
+        friend segmented_iterator operator +(const difference_type &size, const segmented_iterator &it) {
+            return it + size;
+        }
+        
+        segmented_iterator& operator -=(const difference_type &size) {
+            index_ -= size;
+            return *this;
+        }
+        
+        segmented_iterator operator -(const difference_type &size) const {
+            return segmented_iterator(container_, index_ - size);
+        }
+        
+        difference_type operator -(const segmented_iterator &other) const {
+            return difference_type(index_) - difference_type(other.index_);
+        }
+        
+        /*****************************************************
+         * Индекс элемента, на который указывает итератор
+         */
+        
+        std::size_t index() const noexcept {
+            return index_;
+        }
+        
+        bool operator ==(const segmented_iterator &other) const {
+            return index_ == other.index_;
+        }
+        
+        bool operator !=(const segmented_iterator &other) const {
+            return index_ != other.index_;
+        }
+        
+        bool operator <(const segmented_iterator &other) const {
+            return index_ < other.index_;
+        }
+        
+        bool operator >(const segmented_iterator &other) const {
+            return index_ > other.index_;
+        }
+        
+        bool operator <=(const segmented_iterator &other) const {
+            return index_ <= other.index_;
+        }
+        
+        bool operator >=(const segmented_iterator &other) const {
+            return index_ >= other.index_;
+        }
+    
+    private:
+        Container* container_; /*< Вектор*/
+        std::size_t index_; /*< Индекс элемента*/
+    };
+}
@@ -0,0 +1,593 @@
+/********************************************************
+ * \file
+ * \brief Заголовочный файл с двоичной сериализацией 'vector'
+ ********************************************************
+ * Файл содержит в себе запись и чтение вектора в потоки
+ * и файловые дескрипторы 'write'/'read' и потоковое
+ * чтение по частям 'chunk_reader'
+ */
+
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#define PVA_HAS_FD_IO 1
+#else
+#define PVA_HAS_FD_IO 0
+#endif
+
+namespace pva {
+    
+    /********************************************************
+     * \brief Формат сериализации вектора
+     ********************************************************
+     * Заголовок 32 байта, все поля little-endian:
+     * 0  - сигнатура "PVAV"
+     * 4  - версия формата (uint16)
+     * 6  - флаги (uint16), бит 0 - элементы big-endian
+     * 8  - размер элемента (uint32)
+     * 12 - зарезервировано (uint32, 0)
+     * 16 - число элементов (uint64)
+     * 24 - контрольная сумма элементов (uint64)
+     * Далее - элементы подряд в порядке байт записавшей
+     * машины. Арифметические элементы при чтении на машине
+     * с другим порядком байт переставляются
+     */
+    
+    namespace serialization {
+        constexpr std::uint16_t version = 1; /*< Текущая версия формата*/
+        constexpr std::size_t header_size = 32; /*< Размер заголовка в байтах*/
+        constexpr std::uint16_t big_endian_flag = 1; /*< Флаг: элементы big-endian*/
+    }
+    
+    namespace detail {
+        
+        /********************************************************
+         * Порядок байт машины little-endian
+         */
+        
+        inline bool little_endian() noexcept {
+            const std::uint16_t value = 1;
+            unsigned char first;
+            std::memcpy(&first, &value, 1);
+            return first == 1;
+        }
+        
+        /********************************************************
+         * Перестановка байт объекта
+         */
+        
+        inline void swap_bytes(void* data, std::size_t size) noexcept {
+            unsigned char* bytes = static_cast<unsigned char*>(data);
+            for (std::size_t i = 0; i < size / 2; ++i) {
+                const unsigned char byte = bytes[i];
+                bytes[i] = bytes[size - 1 - i];
+                bytes[size - 1 - i] = byte;
+            }
+        }
+        
+        /********************************************************
+         * Запись и чтение little-endian чисел в буфер заголовка
+         */
+        
+        inline void store_le(unsigned char* target, std::uint64_t value, std::size_t size) noexcept {
+            for (std::size_t i = 0; i < size; ++i)
+                target[i] = static_cast<unsigned char>(value >> (8 * i));
+        }
+        
+        inline std::uint64_t load_le(const unsigned char* source, std::size_t size) noexcept {
+            std::uint64_t value = 0;
+            for (std::size_t i = 0; i < size; ++i)
+                value |= std::uint64_t(source[i]) << (8 * i);
+            return value;
+        }
+        
+        /********************************************************
+         * \brief Контрольная сумма элементов
+         ********************************************************
+         * Обрабатывает данные по 8 байт (little-endian слова),
+         * поэтому сумма не зависит от того, какими частями
+         * подаются данные, и быстрее побайтовых хэшей
+         */
+        
+        class checksum {
+        public:
+            /********************************************************
+             * Добавление данных
+             ********************************************************
+             * \param data Данные
+             * \param size Размер данных в байтах
+             */
+            
+            void update(const void* data, std::size_t size) noexcept {
+                if (size == 0)
+                    return;
+                const unsigned char* bytes = static_cast<const unsigned char*>(data);
+                length_ += size;
+                while (pending_size_ != 0 && size != 0) {
+                    pending_[pending_size_++] = *bytes++;
+                    --size;
+                    if (pending_size_ == 8) {
+                        mix(load_le(pending_, 8));
+                        pending_size_ = 0;
+                    }
+                }
+                if (pending_size_ != 0)
+                    return;
+                for (; size >= 8; size -= 8, bytes += 8) {
+                    std::uint64_t word;
+                    std::memcpy(&word, bytes, 8);
+                    mix(little_endian() ? word : load_le(bytes, 8));
+                }
+                std::memcpy(pending_, bytes, size);
+                pending_size_ = size;
+            }
+            
+            /********************************************************
+             * Итоговое значение суммы
+             */
+            
+            std::uint64_t value() const noexcept {
+                std::uint64_t hash = hash_;
+                if (pending_size_ != 0)
+                    hash = step(hash, load_le(pending_, pending_size_));
+                hash ^= length_;
+                hash ^= hash >> 33;
+                hash *= 0xFF51AFD7ED558CCDull;
+                hash ^= hash >> 33;
+                hash *= 0xC4CEB9FE1A85EC53ull;
+                hash ^= hash >> 33;
+                return hash;
+            }
+        
+        private:
+            static std::uint64_t step(std::uint64_t hash, std::uint64_t word) noexcept {
+                hash ^= word * 0x9E3779B97F4A7C15ull;
+                hash = (hash << 27) | (hash >> 37);
+                return hash * 0x100000001B3ull + 0x52DCE729ull;
+            }
+            
+            void mix(std::uint64_t word) noexcept {
+                hash_ = step(hash_, word);
+            }
+            
+            std::uint64_t hash_ = 0xCBF29CE484222325ull; /*< Текущее значение*/
+            std::uint64_t length_ = 0; /*< Число обработанных байт*/
+            unsigned char pending_[8] = {}; /*< Неполное слово*/
+            std::size_t pending_size_ = 0; /*< Число байт в pending_*/
+        };
+        
+        /********************************************************
+         * \brief Разобранный заголовок
+         */
+        
+        struct serial_header {
+            std::uint64_t count; /*< Число элементов*/
+            std::uint64_t checksum; /*< Контрольная сумма элементов*/
+            bool swap; /*< Элементы нужно переставлять*/
+        };
+        
+        /********************************************************
+         * Заполнение заголовка
+         ********************************************************
+         * \param buffer Буфер размером serialization::header_size
+         */
+        
+        template<class T>
+        inline void encode_header(unsigned char* buffer, std::uint64_t count, std::uint64_t sum) noexcept {
+            std::memcpy(buffer, "PVAV", 4);
+            store_le(buffer + 4, serialization::version, 2);
+            store_le(buffer + 6, little_endian() ? 0 : serialization::big_endian_flag, 2);
+            store_le(buffer + 8, sizeof(T), 4);
+            store_le(buffer + 12, 0, 4);
+            store_le(buffer + 16, count, 8);
+            store_le(buffer + 24, sum, 8);
+        }
+        
+        /********************************************************
+         * Проверка и разбор заголовка
+         ********************************************************
+         * Бросает std::runtime_error, если заголовок не от
+         * вектора из T или элементы нельзя прочитать на этой
+         * машине
+         */
+        
+        template<class T>
+        inline serial_header decode_header(const unsigned char* buffer) {
+            if (std::memcmp(buffer, "PVAV", 4) != 0)
+                throw std::runtime_error("Stream does not contain a serialized vector!");
+            if (load_le(buffer + 4, 2) > serialization::version)
+                throw std::runtime_error("Serialized vector has unsupported version!");
+            if (load_le(buffer + 8, 4) != sizeof(T))
+                throw std::runtime_error("Serialized vector has different element size!");
+            serial_header result;
+            result.count = load_le(buffer + 16, 8);
+            result.checksum = load_le(buffer + 24, 8);
+            const bool big = (load_le(buffer + 6, 2) & serialization::big_endian_flag) != 0;
+            result.swap = big == little_endian();
+            if (result.swap && sizeof(T) > 1 && !std::is_arithmetic<T>::value && !std::is_enum<T>::value)
+                throw std::runtime_error("Serialized vector has different byte order!");
+            if (result.count > std::numeric_limits<std::size_t>::max() / sizeof(T))
+                throw std::length_error("Length of vector is too large!");
+            return result;
+        }
+        
+        /********************************************************
+         * Перестановка байт элементов, записанных на машине с
+         * другим порядком байт
+         */
+        
+        template<class T>
+        inline void swap_elements(T* data, std::size_t count) noexcept {
+            if constexpr (sizeof(T) > 1)
+                for (std::size_t i = 0; i < count; ++i)
+                    swap_bytes(data + i, sizeof(T));
+        }
+
+        constexpr std::size_t unknown_size = std::size_t(-1); /*< Остаток источника неизвестен*/
+        
+        /********************************************************
+         * Число байт до конца потока
+         ********************************************************
+         * \return unknown_size, если поток не поддерживает
+         * позиционирование (канал, сокет)
+         */
+        
+        inline std::size_t stream_remaining(std::istream &in) {
+            const std::istream::pos_type current = in.tellg();
+            if (current == std::istream::pos_type(-1))
+                return unknown_size;
+            std::size_t result = unknown_size;
+            if (in.seekg(0, std::ios_base::end)) {
+                const std::istream::pos_type end = in.tellg();
+                if (end != std::istream::pos_type(-1) && end >= current)
+                    result = static_cast<std::size_t>(end - current);
+            }
+            in.clear();
+            in.seekg(current);
+            return result;
+        }
+        
+        /********************************************************
+         * Чтение элементов прямо в буфер вектора
+         ********************************************************
+         * Число элементов из заголовка проверяется по остатку
+         * источника. Если остаток неизвестен, буфер растет по
+         * мере чтения, так что поддельный заголовок не заставит
+         * выделить больше, чем пришло данных. Элементы не
+         * инициализируются перед чтением; если чтение
+         * оборвалось, v остается пустым
+         ********************************************************
+         * \param v Вектор
+         * \param count Число элементов из заголовка
+         * \param available Остаток источника в байтах
+         * \param read_bytes Чтение ровно size байт в data
+         */
+        
+        template<class T, class Allocator, class GrowthPolicy, class Reader>
+        inline void read_elements(vector<T, Allocator, GrowthPolicy> &v, std::size_t count, std::size_t available,
+                                  Reader read_bytes) {
+            if (available != unknown_size && count > available / sizeof(T))
+                throw std::runtime_error("Unexpected end of serialized vector!");
+            v.clear();
+            try {
+                if (available != unknown_size) {
+                    v.resize_for_overwrite(count);
+                    if (count != 0)
+                        read_bytes(v.data(), count * sizeof(T));
+                    return;
+                }
+                const std::size_t initial = (std::size_t(1) << 20) / sizeof(T) + 1;
+                for (std::size_t done = 0; done < count;) {
+                    const std::size_t step = std::min(count - done, std::max(done, initial));
+                    v.resize_for_overwrite(done + step);
+                    read_bytes(v.data() + done, step * sizeof(T));
+                    done += step;
+                }
+            }
+            catch (...) {
+                v.clear();
+                throw;
+            }
+        }
+        
+        /********************************************************
+         * Проверка контрольной суммы прочитанных элементов
+         ********************************************************
+         * Если сумма не сошлась, v очищается (поврежденные
+         * данные не остаются в векторе) и бросается
+         * std::runtime_error. Иначе элементы, записанные с
+         * другим порядком байт, переставляются
+         */
+        
+        template<class T, class Allocator, class GrowthPolicy>
+        inline void verify_elements(vector<T, Allocator, GrowthPolicy> &v, const serial_header &header) {
+            checksum sum;
+            sum.update(v.data(), v.size() * sizeof(T));
+            if (sum.value() != header.checksum) {
+                v.clear();
+                throw std::runtime_error("Serialized vector checksum mismatch!");
+            }
+            if (header.swap)
+                swap_elements(v.data(), v.size());
+        }
+
+#if PVA_HAS_FD_IO
+        /********************************************************
+         * Ошибка системного вызова
+         */
+        
+        [[noreturn]] inline void io_failed(const char* call) {
+            throw std::system_error(errno, std::generic_category(), call);
+        }
+        
+        /********************************************************
+         * Чтение ровно size байт из дескриптора
+         */
+        
+        inline void read_all(int fd, void* data, std::size_t size) {
+            char* target = static_cast<char*>(data);
+            while (size != 0) {
+                const ssize_t done = ::read(fd, target, size);
+                if (done < 0 && errno == EINTR)
+                    continue;
+                if (done < 0)
+                    io_failed("read");
+                if (done == 0)
+                    throw std::runtime_error("Unexpected end of serialized vector!");
+                target += done;
+                size -= static_cast<std::size_t>(done);
+            }
+        }
+        
+        /********************************************************
+         * Число байт до конца файла
+         ********************************************************
+         * \return unknown_size, если дескриптор не обычный файл
+         */
+        
+        inline std::size_t fd_remaining(int fd) noexcept {
+            struct stat status;
+            if (::fstat(fd, &status) != 0 || !S_ISREG(status.st_mode))
+                return unknown_size;
+            const off_t current = ::lseek(fd, 0, SEEK_CUR);
+            if (current < 0 || current > status.st_size)
+                return unknown_size;
+            return static_cast<std::size_t>(status.st_size - current);
+        }
+#endif
+    }
+    
+    /********************************************************
+     * Запись вектора в поток
+     ********************************************************
+     * Элементы записываются одним вызовом write
+     ********************************************************
+     * \param out Поток (открытый в двоичном режиме)
+     * \param v Вектор
+     */
+    
+    template<class T, class Allocator, class GrowthPolicy>
+    inline void write(std::ostream &out, const vector<T, Allocator, GrowthPolicy> &v) {
+        static_assert(std::is_trivially_copyable<T>::value, "Serialization requires a trivially copyable type");
+        detail::checksum sum;
+        sum.update(v.data(), v.size() * sizeof(T));
+        unsigned char header[serialization::header_size];
+        detail::encode_header<T>(header, v.size(), sum.value());
+        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+        if (!v.empty())
+            out.write(reinterpret_cast<const char*>(v.data()), static_cast<std::streamsize>(v.size() * sizeof(T)));
+        if (!out)
+            throw std::runtime_error("Failed to write vector!");
+    }
+    
+    /********************************************************
+     * Чтение вектора из потока
+     ********************************************************
+     * Содержимое v заменяется, элементы читаются одним
+     * вызовом read прямо в буфер вектора. Число элементов
+     * проверяется по остатку потока до выделения памяти.
+     * Бросает std::runtime_error, если поток оборвался или
+     * не сошлась контрольная сумма; v при этом остается пустым
+     ********************************************************
+     * \param in Поток (открытый в двоичном режиме)
+     * \param v Вектор
+     */
+    
+    template<class T, class Allocator, class GrowthPolicy>
+    inline void read(std::istream &in, vector<T, Allocator, GrowthPolicy> &v) {
+        static_assert(std::is_trivially_copyable<T>::value, "Serialization requires a trivially copyable type");
+        unsigned char buffer[serialization::header_size];
+        if (!in.read(reinterpret_cast<char*>(buffer), sizeof(buffer)))
+            throw std::runtime_error("Unexpected end of serialized vector!");
+        const detail::serial_header header = detail::decode_header<T>(buffer);
+        detail::read_elements(v, static_cast<std::size_t>(header.count), detail::stream_remaining(in),
+                              [&in](void* data, std::size_t size) {
+                                  if (!in.read(static_cast<char*>(data), static_cast<std::streamsize>(size)))
+                                      throw std::runtime_error("Unexpected end of serialized vector!");
+                              });
+        detail::verify_elements(v, header);
+    }
+
+#if PVA_HAS_FD_IO
+    /********************************************************
+     * Запись вектора в файловый дескриптор
+     ********************************************************
+     * Заголовок и элементы уходят одним writev (повторяется,
+     * если ядро записало не все)
+     ********************************************************
+     * \param fd Дескриптор файла, канала или сокета
+     * \param v Вектор
+     */
+    
+    template<class T, class Allocator, class GrowthPolicy>
+    inline void write(int fd, const vector<T, Allocator, GrowthPolicy> &v) {
+        static_assert(std::is_trivially_copyable<T>::value, "Serialization requires a trivially copyable type");
+        detail::checksum sum;
+        sum.update(v.data(), v.size() * sizeof(T));
+        unsigned char header[serialization::header_size];
+        detail::encode_header<T>(header, v.size(), sum.value());
+        iovec parts[2];
+        parts[0].iov_base = header;
+        parts[0].iov_len = sizeof(header);
+        parts[1].iov_base = const_cast<T*>(v.data());
+        parts[1].iov_len = v.size() * sizeof(T);
+        iovec* current = parts;
+        int left = v.empty() ? 1 : 2;
+        while (left != 0) {
+            const ssize_t done = ::writev(fd, current, left);
+            if (done < 0 && errno == EINTR)
+                continue;
+            if (done < 0)
+                detail::io_failed("writev");
+            std::size_t written = static_cast<std::size_t>(done);
+            while (left != 0 && written >= current->iov_len) {
+                written -= current->iov_len;
+                ++current;
+                --left;
+            }
+            if (left != 0) {
+                current->iov_base = static_cast<char*>(current->iov_base) + written;
+                current->iov_len -= written;
+            }
+        }
+    }
+    
+    /********************************************************
+     * Чтение вектора из файлового дескриптора
+     ********************************************************
+     * Заголовок читается первым (по нему выделяется память,
+     * если число элементов не больше остатка файла), затем
+     * элементы читаются прямо в буфер вектора. При ошибке v
+     * остается пустым
+     ********************************************************
+     * \param fd Дескриптор файла, канала или сокета
+     * \param v Вектор
+     */
+    
+    template<class T, class Allocator, class GrowthPolicy>
+    inline void read(int fd, vector<T, Allocator, GrowthPolicy> &v) {
+        static_assert(std::is_trivially_copyable<T>::value, "Serialization requires a trivially copyable type");
+        unsigned char buffer[serialization::header_size];
+        detail::read_all(fd, buffer, sizeof(buffer));
+        const detail::serial_header header = detail::decode_header<T>(buffer);
+        detail::read_elements(v, static_cast<std::size_t>(header.count), detail::fd_remaining(fd),
+                              [fd](void* data, std::size_t size) {
+                                  detail::read_all(fd, data, size);
+                              });
+        detail::verify_elements(v, header);
+    }
+#endif
+    
+    /********************************************************
+     * \brief Потоковое чтение сериализованного вектора
+     ********************************************************
+     * Читает элементы частями в буфер вызывающего, не держа
+     * весь вектор в памяти. Контрольная сумма проверяется,
+     * когда прочитан последний элемент
+     */
+    
+    template<class T>
+    class chunk_reader {
+        static_assert(std::is_trivially_copyable<T>::value, "Serialization requires a trivially copyable type");
+    
+    public:
+        /**********************************************
+         * Конструктор
+         **********************************************
+         * Читает и проверяет заголовок
+         **********************************************
+         * \param in Поток (открытый в двоичном режиме)
+         */
+        
+        explicit chunk_reader(std::istream &in)
+        :in_(in) {
+            unsigned char buffer[serialization::header_size];
+            if (!in_.read(reinterpret_cast<char*>(buffer), sizeof(buffer)))
+                throw std::runtime_error("Unexpected end of serialized vector!");
+            header_ = detail::decode_header<T>(buffer);
+            remaining_ = static_cast<std::size_t>(header_.count);
+        }
+        
+        /********************************************************
+         * Число элементов в сериализованном векторе
+         */
+        
+        std::size_t size() const noexcept {
+            return static_cast<std::size_t>(header_.count);
+        }
+        
+        /********************************************************
+         * Число еще не прочитанных элементов
+         */
+        
+        std::size_t remaining() const noexcept {
+            return remaining_;
+        }
+        
+        /********************************************************
+         * Чтение очередной части в массив
+         ********************************************************
+         * \param buffer Массив под элементы
+         * \param count Размер массива
+         * \return Число прочитанных элементов (0 - конец)
+         */
+        
+        std::size_t read(T* buffer, std::size_t count) {
+            if (count > remaining_)
+                count = remaining_;
+            if (count == 0)
+                return 0;
+            if (!in_.read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(count * sizeof(T))))
+                throw std::runtime_error("Unexpected end of serialized vector!");
+            sum_.update(buffer, count * sizeof(T));
+            remaining_ -= count;
+            if (remaining_ == 0 && sum_.value() != header_.checksum)
+                throw std::runtime_error("Serialized vector checksum mismatch!");
+            if (header_.swap)
+                detail::swap_elements(buffer, count);
+            return count;
+        }
+        
+        /********************************************************
+         * Чтение очередной части в вектор
+         ********************************************************
+         * Содержимое chunk заменяется
+         ********************************************************
+         * \param chunk Вектор под элементы
+         * \param count Максимальное число элементов
+         * \return False - элементы закончились
+         */
+        
+        template<class Allocator, class GrowthPolicy>
+        bool read(vector<T, Allocator, GrowthPolicy> &chunk, std::size_t count) {
+            if (count > remaining_)
+                count = remaining_;
+            chunk.clear();
+            chunk.resize_for_overwrite(count);
+            return read(chunk.data(), count) != 0;
+        }
+    
+    private:
+        std::istream &in_; /*< Поток*/
+        detail::serial_header header_; /*< Заголовок*/
+        std::size_t remaining_; /*< Число непрочитанных элементов*/
+        detail::checksum sum_; /*< Сумма прочитанных элементов*/
+    };
+}
@@ -0,0 +1,56 @@
+/********************************************************
+ * \file
+ * \brief Заголовочный файл с описанием контейнера 'small_vector'
+ ********************************************************
+ * Файл содержит в себе реализацию класса 'small_vector'
+ */
+
+#pragma once
+
+#include "allocator.h"
+#include "vector.h"
+
+namespace pva {
+    
+    /********************************************************
+     * \brief Класс - вектор с внутренним буфером
+     ********************************************************
+     * Первые N элементов хранятся внутри самого объекта, куча
+     * используется только когда элементов становится больше.
+     * Интерфейс и итераторы те же, что у pva::vector
+     */
+    
+    template<class T, std::size_t N, class Allocator = malloc_allocator<T>,
+             class GrowthPolicy = growth_double>
+    class small_vector : public vector<T, inline_allocator<T, N, Allocator>, GrowthPolicy> {
+        typedef vector<T, inline_allocator<T, N, Allocator>, GrowthPolicy> base;
+    
+    public:
+        static const std::size_t inline_capacity = N; /*< Размер внутреннего буфера*/
+        
+        using base::base;
+        
+        /**********************************************
+         * Конструктор по умолчанию
+         **********************************************
+         * Память не выделяется: первое добавление
+         * использует внутренний буфер
+         */
+        
+        small_vector() noexcept {}
+        
+        /**********************************************
+         * Конструктор с аллокатором для памяти вне буфера
+         **********************************************
+         * \param allocator Аллокатор, через который выделяется куча
+         */
+        
+        explicit small_vector(const Allocator &allocator) noexcept
+        :base(inline_allocator<T, N, Allocator>(allocator)) {}
+        
+        small_vector(const small_vector &copy) = default;
+        small_vector(small_vector &&copy) = default;
+        small_vector& operator =(const small_vector &copy) = default;
+        small_vector& operator =(small_vector &&copy) = default;
+    };
+}
@@ -0,0 +1,544 @@
+/********************************************************
+ * \file
+ * \brief Заголовочный файл с описанием контейнера 'soa_vector'
+ ********************************************************
+ * Файл содержит в себе реализацию вектора записей,
+ * хранящего каждое поле в отдельном столбце 'soa_vector'
+ * (structure of arrays), и его итератора 'soa_iterator'
+ */
+
+#pragma once
+
+#include "span.h"
+#include "vector.h"
+
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace pva {
+    
+    /********************************************************
+     * \brief Итератор soa_vector
+     ********************************************************
+     * Хранит вектор и индекс строки. Разыменование дает
+     * прокси-ссылку: кортеж ссылок на поля строки
+     */
+    
+    template<class Container, class Reference>
+    class soa_iterator {
+        template<class, class>
+        friend class soa_iterator;
+    
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef typename Container::value_type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef void pointer;
+        typedef Reference reference;
+        
+        /**********************************************
+         * Конструктор по умолчанию
+         */
+        
+        soa_iterator() noexcept
+        :container_(nullptr), index_(0) {}
+        
+        /**********************************************
+         * Конструктор итератора на строку
+         **********************************************
+         * \param container Вектор
+         * \param index Индекс строки
+         */
+        
+        soa_iterator(Container* container, std::size_t index) noexcept
+        :container_(container), index_(index) {}
+        
+        /**********************************************
+         * Преобразование итератора в константный
+         */
+        
+        template<class OtherContainer, class OtherReference,
+                 class = typename std::enable_if<std::is_same<const OtherContainer, Container>::value>::type>
+        soa_iterator(const soa_iterator<OtherContainer, OtherReference> &copy) noexcept
+        :container_(copy.container_), index_(copy.index_) {}
+        
+        Reference operator *() const {
+            return (*container_)[index_];
+        }
+        
+        Reference operator [](const difference_type &size) const {
+            return (*container_)[index_ + size];
+        }
+        
+        soa_iterator& operator ++() noexcept {
+            ++index_;
+            return *this;
+        }
+        
+        soa_iterator operator ++(int) noexcept {
+            soa_iterator result(*this);
+            ++index_;
+            return result;
+        }
+        
+        soa_iterator& operator --() noexcept {
+            --index_;
+            return *this;
+        }
+        
+        soa_iterator operator --(int) noexcept {
+            soa_iterator result(*this);
+            --index_;
+            return result;
+        }
+        
+        soa_iterator& operator +=(const difference_type &size) noexcept {
+            index_ += size;
+            return *this;
+        }
+        
+        soa_iterator& operator -=(const difference_type &size) noexcept {
+            index_ -= size;
+            return *this;
+        }
+        
+        soa_iterator operator +(const difference_type &size) const noexcept {
+            return soa_iterator(container_, index_ + size);
+        }
+        
+        soa_iterator operator -(const difference_type &size) const noexcept {
+            return soa_iterator(container_, index_ - size);
+        }
+        
+        /********************************************************
+         * Индекс строки
+         */
+        
+        std::size_t index() const noexcept {
+            return index_;
+        }
+    
+    private:
+        Container* container_; /*< Вектор*/
+        std::size_t index_; /*< Индекс строки*/
+    };
+    
+    /********************************************************
+     * Перегруженный оператор - (расстояние между итераторами)
+     ********************************************************
+     * \param lhs Уменьшаемое
+     * \param rhs Вычитаемое
+     * \return Число строк от rhs до lhs
+     */
+    
+    template<class C1, class R1, class C2, class R2>
+    inline std::ptrdiff_t operator -(const soa_iterator<C1, R1> &lhs, const soa_iterator<C2, R2> &rhs) noexcept {
+        return std::ptrdiff_t(lhs.index()) - std::ptrdiff_t(rhs.index());
+    }
+    
+    /********************************************************
+     * Операторы сравнения итераторов soa_vector
+     ********************************************************
+     * Сравниваются индексы строк, константный итератор
+     * можно сравнивать с изменяемым
+     */
+    
+    template<class C1, class R1, class C2, class R2>
+    inline bool operator ==(const soa_iterator<C1, R1> &lhs, const soa_iterator<C2, R2> &rhs) noexcept {
+        return lhs.index() == rhs.index();
+    }
+    
+    template<class C1, class R1, class C2, class R2>
+    inline bool operator !=(const soa_iterator<C1, R1> &lhs, const soa_iterator<C2, R2> &rhs) noexcept {
+        return lhs.index() != rhs.index();
+    }
+    
+    template<class C1, class R1, class C2, class R2>
+    inline bool operator <(const soa_iterator<C1, R1> &lhs, const soa_iterator<C2, R2> &rhs) noexcept {
+        return lhs.index() < rhs.index();
+    }
+    
+    template<class C1, class R1, class C2, class R2>
+    inline bool operator >(const soa_iterator<C1, R1> &lhs, const soa_iterator<C2, R2> &rhs) noexcept {
+        return lhs.index() > rhs.index();
+    }
+    
+    template<class C1, class R1, class C2, class R2>
+    inline bool operator <=(const soa_iterator<C1, R1> &lhs, const soa_iterator<C2, R2> &rhs) noexcept {
+        return lhs.index() <= rhs.index();
+    }
+    
+    template<class C1, class R1, class C2, class R2>
+    inline bool operator >=(const soa_iterator<C1, R1> &lhs, const soa_iterator<C2, R2> &rhs) noexcept {
+        return lhs.index() >= rhs.index();
+    }
+    
+    /********************************************************
+     * \brief Вектор записей, хранящий поля по столбцам
+     ********************************************************
+     * Каждое поле Fields лежит в своем pva::vector, поэтому
+     * обход одного-двух полей читает только их столбцы, а
+     * циклы по столбцу (см. column) векторизуются. Емкость
+     * всех столбцов выбирается одним решением GrowthPolicy,
+     * так что столбцы перевыделяются вместе и одинаково
+     * часто. Строка доступна как прокси-ссылка - кортеж
+     * ссылок на поля (std::get, структурное связывание,
+     * присваивание кортежем значений)
+     */
+    
+    template<class... Fields>
+    class soa_vector {
+        static_assert(sizeof...(Fields) > 0, "soa_vector needs at least one field");
+        
+        typedef std::index_sequence_for<Fields...> indices;
+        typedef growth_double growth_policy;
+    
+    public:
+        typedef std::tuple<Fields...> value_type;
+        typedef std::tuple<Fields&...> reference;
+        typedef std::tuple<const Fields&...> const_reference;
+        typedef std::size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef soa_iterator<soa_vector, reference> iterator;
+        typedef soa_iterator<const soa_vector, const_reference> const_iterator;
+        
+        /********************************************************
+         * Тип поля с номером I
+         */
+        
+        template<std::size_t I>
+        using field_type = typename std::tuple_element<I, value_type>::type;
+        
+        static const std::size_t field_count = sizeof...(Fields); /*< Число полей (столбцов)*/
+        
+        /**********************************************
+         * Конструктор по умолчанию
+         */
+        
+        soa_vector() {}
+        
+        /**********************************************
+         * Конструктор вектора из size строк
+         * со значениями полей по умолчанию
+         */
+        
+        explicit soa_vector(const std::size_t &size) {
+            resize(size);
+        }
+        
+        soa_vector(const soa_vector &copy) = default;
+        soa_vector(soa_vector &&copy) = default;
+        soa_vector& operator =(const soa_vector &copy) = default;
+        soa_vector& operator =(soa_vector &&copy) = default;
+        
+        /********************************************************
+         * Число строк
+         */
+        
+        std::size_t size() const noexcept {
+            return std::get<0>(columns_).size();
+        }
+        
+        bool empty() const noexcept {
+            return size() == 0;
+        }
+        
+        /********************************************************
+         * Емкость: число строк, которые поместятся во все
+         * столбцы без перевыделения
+         */
+        
+        std::size_t capacity() const noexcept {
+            return capacity(indices());
+        }
+        
+        /********************************************************
+         * Резервирование памяти под size строк во всех столбцах
+         ********************************************************
+         * \param size Число строк
+         * \return True - память выделилась, false - обратное
+         */
+        
+        bool reserve(const std::size_t &size) {
+            if (size <= capacity())
+                return false;
+            reserve(size, indices());
+            return true;
+        }
+        
+        /********************************************************
+         * Добавление строки в конец
+         ********************************************************
+         * Каждое поле создается из своего аргумента. При
+         * исключении уже добавленные поля удаляются
+         ********************************************************
+         * \param args Аргументы конструкторов полей (по одному на поле)
+         * \return Прокси-ссылку на добавленную строку
+         */
+        
+        template<class... Args>
+        reference emplace_back(Args&&... args) {
+            static_assert(sizeof...(Args) == sizeof...(Fields), "One argument per field is required");
+            const std::size_t index = size();
+            grow(index + 1);
+            append(indices(), pva::forward<Args>(args)...);
+            return (*this)[index];
+        }
+        
+        /********************************************************
+         * Добавление строки в конец
+         ********************************************************
+         * \param value Кортеж значений полей
+         */
+        
+        void push_back(const value_type &value) {
+            push_row(value, indices());
+        }
+        
+        void push_back(value_type &&value) {
+            push_row(pva::move(value), indices());
+        }
+        
+        /********************************************************
+         * Удаление последней строки
+         */
+        
+        void pop_back() {
+            pop_back(indices());
+        }
+        
+        /********************************************************
+         * Удаление строки с индексом index
+         ********************************************************
+         * Следующие строки сдвигаются в каждом столбце
+         */
+        
+        void erase(const std::size_t &index) {
+            if (index >= size())
+                throw std::out_of_range("Index more than size of vector!");
+            erase(index, indices());
+        }
+        
+        /********************************************************
+         * Изменение количества строк
+         ********************************************************
+         * Новые строки заполняются значениями по умолчанию.
+         * При исключении все столбцы возвращаются к прежнему
+         * размеру
+         */
+        
+        void resize(const std::size_t &size) {
+            const std::size_t old = this->size();
+            if (size > old)
+                grow(size);
+            try {
+                resize(size, indices());
+            }
+            catch (...) {
+                resize(old, indices());
+                throw;
+            }
+        }
+        
+        /********************************************************
+         * Удаление всех строк (емкость не меняется)
+         */
+        
+        void clear() {
+            clear(indices());
+        }
+        
+        /********************************************************
+         * Освобождение неиспользуемой памяти во всех столбцах
+         */
+        
+        void shrink_to_fit() {
+            shrink_to_fit(indices());
+        }
+        
+        /********************************************************
+         * Обмен содержимым с другим вектором
+         */
+        
+        void swap(soa_vector &other) noexcept {
+            columns_.swap(other.columns_);
+        }
+        
+        /********************************************************
+         * Прокси-ссылка на строку с индексом index
+         ********************************************************
+         * Индекс проверяется только при PVA_CHECKED
+         */
+        
+        reference operator [](const std::size_t &index) {
+            return row(index, indices());
+        }
+        
+        const_reference operator [](const std::size_t &index) const {
+            return row(index, indices());
+        }
+        
+        /********************************************************
+         * Прокси-ссылка на строку с проверкой индекса
+         */
+        
+        reference at(const std::size_t &index) {
+            if (index >= size())
+                throw std::out_of_range("Index more than size of vector!");
+            return (*this)[index];
+        }
+        
+        const_reference at(const std::size_t &index) const {
+            if (index >= size())
+                throw std::out_of_range("Index more than size of vector!");
+            return (*this)[index];
+        }
+        
+        /********************************************************
+         * Столбец поля с номером I
+         ********************************************************
+         * Диапазон действителен до следующего перевыделения
+         * памяти (добавления строк сверх емкости, reserve,
+         * shrink_to_fit)
+         */
+        
+        template<std::size_t I>
+        span<field_type<I>> column() noexcept {
+            vector<field_type<I>> &values = std::get<I>(columns_);
+            return span<field_type<I>>(values.data(), values.size());
+        }
+        
+        template<std::size_t I>
+        span<const field_type<I>> column() const noexcept {
+            const vector<field_type<I>> &values = std::get<I>(columns_);
+            return span<const field_type<I>>(values.data(), values.size());
+        }
+        
+        iterator begin() noexcept {
+            return iterator(this, 0);
+        }
+        
+        const_iterator begin() const noexcept {
+            return const_iterator(this, 0);
+        }
+        
+        const_iterator cbegin() const noexcept {
+            return begin();
+        }
+        
+        iterator end() noexcept {
+            return iterator(this, size());
+        }
+        
+        const_iterator end() const noexcept {
+            return const_iterator(this, size());
+        }
+        
+        const_iterator cend() const noexcept {
+            return end();
+        }
+    
+    private:
+        
+        /********************************************************
+         * Увеличение емкости всех столбцов до одной емкости
+         * согласно GrowthPolicy
+         ********************************************************
+         * \param required Минимально необходимое число строк
+         */
+        
+        void grow(const std::size_t &required) {
+            const std::size_t current = capacity();
+            if (required > current)
+                reserve(growth_policy()(current, required), indices());
+        }
+        
+        template<std::size_t... I>
+        std::size_t capacity(std::index_sequence<I...>) const noexcept {
+            std::size_t result = std::get<0>(columns_).capacity();
+            ((result = std::get<I>(columns_).capacity() < result ? std::get<I>(columns_).capacity() : result), ...);
+            return result;
+        }
+        
+        template<std::size_t... I>
+        void reserve(const std::size_t &size, std::index_sequence<I...>) {
+            (std::get<I>(columns_).reserve(size), ...);
+        }
+        
+        /********************************************************
+         * Добавление полей строки в столбцы, емкость которых
+         * уже достаточна
+         ********************************************************
+         * Если поле бросает исключение, добавленные перед ним
+         * поля удаляются
+         */
+        
+        template<std::size_t... I, class... Args>
+        void append(std::index_sequence<I...>, Args&&... args) {
+            std::size_t done = 0;
+            try {
+                ((std::get<I>(columns_).emplace_back(pva::forward<Args>(args)), ++done), ...);
+            }
+            catch (...) {
+                ((I < done ? std::get<I>(columns_).pop_back() : void()), ...);
+                throw;
+            }
+        }
+        
+        template<class Tuple, std::size_t... I>
+        void push_row(Tuple &&value, std::index_sequence<I...>) {
+            grow(size() + 1);
+            append(indices(), std::get<I>(pva::forward<Tuple>(value))...);
+        }
+        
+        template<std::size_t... I>
+        void pop_back(std::index_sequence<I...>) {
+            (std::get<I>(columns_).pop_back(), ...);
+        }
+        
+        template<std::size_t... I>
+        void erase(const std::size_t &index, std::index_sequence<I...>) {
+            (std::get<I>(columns_).erase(std::get<I>(columns_).cbegin() + index), ...);
+        }
+        
+        template<std::size_t... I>
+        void resize(const std::size_t &size, std::index_sequence<I...>) {
+            (std::get<I>(columns_).resize(size), ...);
+        }
+        
+        template<std::size_t... I>
+        void clear(std::index_sequence<I...>) {
+            (std::get<I>(columns_).clear(), ...);
+        }
+        
+        template<std::size_t... I>
+        void shrink_to_fit(std::index_sequence<I...>) {
+            (std::get<I>(columns_).shrink_to_fit(), ...);
+        }
+        
+        template<std::size_t... I>
+        reference row(const std::size_t &index, std::index_sequence<I...>) {
+            return reference(std::get<I>(columns_)[index]...);
+        }
+        
+        template<std::size_t... I>
+        const_reference row(const std::size_t &index, std::index_sequence<I...>) const {
+            return const_reference(std::get<I>(columns_)[index]...);
+        }
+        
+        std::tuple<vector<Fields>...> columns_; /*< Столбцы полей*/
+    };
+    
+    /********************************************************
+     * Функция замены двух векторов
+     */
+    
+    template<class... Fields>
+    inline void swap(soa_vector<Fields...> &lhs, soa_vector<Fields...> &rhs) noexcept {
+        lhs.swap(rhs);
+    }
+}
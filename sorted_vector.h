@@ -0,0 +1,592 @@
+/********************************************************
+ * \file
+ * \brief Заголовочный файл с описанием контейнеров
+ * 'sorted_vector' и 'eytzinger_set'
+ ********************************************************
+ * Файл содержит в себе упорядоченное множество в
+ * непрерывном буфере 'sorted_vector', поиск без ветвлений
+ * и множество только для чтения в раскладке Эйтцингера
+ * 'eytzinger_set'
+ */
+
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace pva {
+    
+    namespace detail {
+        
+        /********************************************************
+         * Предвыборка строки кэша с адресом address
+         */
+        
+        inline void prefetch(const void* address) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(address);
+#else
+            (void)address;
+#endif
+        }
+        
+        /********************************************************
+         * Первый элемент [data, data + count), не меньший key
+         ********************************************************
+         * Бинарный поиск без ветвлений: на каждом шаге
+         * половина диапазона отбрасывается сдвигом на
+         * half * (результат сравнения), поэтому нет промахов
+         * предсказания переходов и число шагов зависит только
+         * от count. Середины обеих возможных половин
+         * предвыбираются заранее
+         ********************************************************
+         * \param data Упорядоченный массив
+         * \param count Число элементов
+         * \param key Искомый ключ
+         * \param comp Сравнение
+         * \return Указатель на элемент или data + count
+         */
+        
+        template<class T, class Key, class Compare>
+        inline const T* branchless_lower_bound(const T* data, std::size_t count, const Key &key, Compare &comp) {
+            if (count == 0)
+                return data;
+            while (count > 1) {
+                const std::size_t half = count / 2;
+                prefetch(data + half / 2);
+                prefetch(data + half + half / 2);
+                data += half * std::size_t(comp(data[half - 1], key));
+                count -= half;
+            }
+            return data + std::size_t(comp(*data, key));
+        }
+        
+        /********************************************************
+         * Первый элемент [data, data + count), больший key
+         ********************************************************
+         * См. branchless_lower_bound
+         */
+        
+        template<class T, class Key, class Compare>
+        inline const T* branchless_upper_bound(const T* data, std::size_t count, const Key &key, Compare &comp) {
+            if (count == 0)
+                return data;
+            while (count > 1) {
+                const std::size_t half = count / 2;
+                data += half * std::size_t(!comp(key, data[half - 1]));
+                count -= half;
+            }
+            return data + std::size_t(!comp(key, *data));
+        }
+    }
+    
+    /********************************************************
+     * \brief Упорядоченное множество в непрерывном буфере
+     ********************************************************
+     * Хранит различные (по Compare) элементы по возрастанию
+     * в pva::vector. Поиск - бинарный без ветвлений,
+     * вставка и удаление одного элемента - O(n) сдвигом,
+     * insert_range вставляет пакет за один линейный проход.
+     * Элементы доступны только для чтения, чтобы не нарушить
+     * порядок. Итераторы становятся недействительными после
+     * любого изменения множества
+     */
+    
+    template<class T, class Compare = std::less<T>, class Allocator = malloc_allocator<T>>
+    class sorted_vector {
+        typedef vector<T, Allocator> storage;
+    
+    public:
+        typedef T key_type;
+        typedef T value_type;
+        typedef Compare key_compare;
+        typedef Compare value_compare;
+        typedef Allocator allocator_type;
+        typedef std::size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const T& reference;
+        typedef const T& const_reference;
+        typedef typename storage::const_iterator iterator;
+        typedef typename storage::const_iterator const_iterator;
+        typedef typename storage::const_reverse_iterator reverse_iterator;
+        typedef typename storage::const_reverse_iterator const_reverse_iterator;
+        
+        /**********************************************
+         * Конструктор пустого множества
+         */
+        
+        sorted_vector() {}
+        
+        /**********************************************
+         * Конструктор пустого множества со сравнением
+         **********************************************
+         * \param comp Сравнение
+         * \param allocator Аллокатор
+         */
+        
+        explicit sorted_vector(const Compare &comp, const Allocator &allocator = Allocator())
+        :data_(allocator), compare_(comp) {}
+        
+        /**********************************************
+         * Конструктор множества из элементов [first, last)
+         **********************************************
+         * Повторы отбрасываются (остается первый)
+         */
+        
+        template<class InputIt, class = typename std::enable_if<detail::is_iterator<InputIt>::value>::type>
+        sorted_vector(InputIt first, InputIt last, const Compare &comp = Compare(),
+                      const Allocator &allocator = Allocator())
+        :data_(allocator), compare_(comp) {
+            insert_range(first, last);
+        }
+        
+        sorted_vector(std::initializer_list<T> values, const Compare &comp = Compare(),
+                      const Allocator &allocator = Allocator())
+        :sorted_vector(values.begin(), values.end(), comp, allocator) {}
+        
+        std::size_t size() const noexcept {
+            return data_.size();
+        }
+        
+        bool empty() const noexcept {
+            return data_.empty();
+        }
+        
+        std::size_t capacity() const noexcept {
+            return data_.capacity();
+        }
+        
+        void reserve(const std::size_t &size) {
+            data_.reserve(size);
+        }
+        
+        void shrink_to_fit() {
+            data_.shrink_to_fit();
+        }
+        
+        /********************************************************
+         * Удаление всех элементов (память остается за множеством)
+         */
+        
+        void clear() noexcept {
+            data_.clear();
+        }
+        
+        /********************************************************
+         * Вставка элемента
+         ********************************************************
+         * \param value Элемент
+         * \return Итератор на элемент с ключом value и
+         * признак того, что он вставлен (false - уже был)
+         */
+        
+        std::pair<iterator, bool> insert(const T &value) {
+            const_iterator pos = lower_bound(value);
+            if (pos != end() && !compare_(value, *pos))
+                return std::pair<iterator, bool>(pos, false);
+            return std::pair<iterator, bool>(data_.insert(pos, value), true);
+        }
+        
+        std::pair<iterator, bool> insert(T &&value) {
+            const_iterator pos = lower_bound(value);
+            if (pos != end() && !compare_(value, *pos))
+                return std::pair<iterator, bool>(pos, false);
+            return std::pair<iterator, bool>(data_.insert(pos, pva::move(value)), true);
+        }
+        
+        template<class... Args>
+        std::pair<iterator, bool> emplace(Args&&... args) {
+            return insert(T(pva::forward<Args>(args)...));
+        }
+        
+        /********************************************************
+         * Вставка пакета элементов [first, last)
+         ********************************************************
+         * Пакет дописывается в конец буфера и сортируется,
+         * повторы в пакете и ключи, уже бывшие в множестве,
+         * отбрасываются за один проход, после чего обе части
+         * сливаются (std::inplace_merge, линейно при наличии
+         * временного буфера). Итого O(n + k log k) вместо
+         * O(n * k) для k вставок по одному. Если исключение
+         * брошено до слияния, множество остается прежним
+         ********************************************************
+         * \param first Начало пакета
+         * \param last Конец пакета
+         */
+        
+        template<class InputIt, class = typename std::enable_if<detail::is_iterator<InputIt>::value>::type>
+        void insert_range(InputIt first, InputIt last) {
+            const std::size_t count = data_.size();
+            try {
+                data_.append(first, last);
+                if (data_.size() == count)
+                    return;
+                T* const begin = data_.data();
+                T* const batch = begin + count;
+                T* const end = begin + data_.size();
+                if (!std::is_sorted(batch, end, compare_))
+                    std::stable_sort(batch, end, compare_);
+                const T* old = begin;
+                T* out = batch;
+                for (T* it = batch; it != end; ++it) {
+                    if (out != batch && !compare_(out[-1], *it))
+                        continue;
+                    old = detail::branchless_lower_bound(old, std::size_t(batch - old), *it, compare_);
+                    if (old != batch && !compare_(*it, *old))
+                        continue;
+                    if (out != it)
+                        *out = pva::move(*it);
+                    ++out;
+                }
+                data_.erase(data_.cbegin() + (out - begin), data_.cend());
+            } catch (...) {
+                data_.erase(data_.cbegin() + count, data_.cend());
+                throw;
+            }
+            T* const begin = data_.data();
+            std::inplace_merge(begin, begin + count, begin + data_.size(), compare_);
+        }
+        
+        template<class Range, class = decltype(std::begin(std::declval<const Range&>()))>
+        void insert_range(const Range &values) {
+            insert_range(std::begin(values), std::end(values));
+        }
+        
+        /********************************************************
+         * Удаление элемента по итератору
+         ********************************************************
+         * \return Итератор на следующий элемент
+         */
+        
+        iterator erase(const_iterator pos) {
+            return data_.erase(pos);
+        }
+        
+        iterator erase(const_iterator first, const_iterator last) {
+            return data_.erase(first, last);
+        }
+        
+        /********************************************************
+         * Удаление элемента с ключом key
+         ********************************************************
+         * \return Число удаленных элементов (0 или 1)
+         */
+        
+        std::size_t erase(const T &key) {
+            const_iterator pos = find(key);
+            if (pos == end())
+                return 0;
+            data_.erase(pos);
+            return 1;
+        }
+        
+        /********************************************************
+         * Удаление всех элементов, для которых pred истинен
+         ********************************************************
+         * Порядок оставшихся элементов сохраняется
+         ********************************************************
+         * \return Число удаленных элементов
+         */
+        
+        template<class Predicate>
+        std::size_t erase_if(Predicate pred) {
+            return data_.erase_if(pred);
+        }
+        
+        /********************************************************
+         * Первый элемент, не меньший key
+         */
+        
+        const_iterator lower_bound(const T &key) const {
+            return position(detail::branchless_lower_bound(data_.data(), data_.size(), key, compare_));
+        }
+        
+        /********************************************************
+         * Первый элемент, больший key
+         */
+        
+        const_iterator upper_bound(const T &key) const {
+            return position(detail::branchless_upper_bound(data_.data(), data_.size(), key, compare_));
+        }
+        
+        std::pair<const_iterator, const_iterator> equal_range(const T &key) const {
+            const_iterator pos = lower_bound(key);
+            if (pos == end() || compare_(key, *pos))
+                return std::pair<const_iterator, const_iterator>(pos, pos);
+            return std::pair<const_iterator, const_iterator>(pos, pos + 1);
+        }
+        
+        /********************************************************
+         * Поиск элемента с ключом key
+         ********************************************************
+         * \return Итератор на элемент или end()
+         */
+        
+        const_iterator find(const T &key) const {
+            const T* found = detail::branchless_lower_bound(data_.data(), data_.size(), key, compare_);
+            if (found == data_.data() + data_.size() || compare_(key, *found))
+                return end();
+            return position(found);
+        }
+        
+        bool contains(const T &key) const {
+            const T* found = detail::branchless_lower_bound(data_.data(), data_.size(), key, compare_);
+            return found != data_.data() + data_.size() && !compare_(key, *found);
+        }
+        
+        std::size_t count(const T &key) const {
+            return contains(key) ? 1 : 0;
+        }
+        
+        /********************************************************
+         * Индекс элемента с ключом key
+         ********************************************************
+         * \return Индекс или size(), если элемента нет
+         */
+        
+        std::size_t index_of(const T &key) const {
+            const T* found = detail::branchless_lower_bound(data_.data(), data_.size(), key, compare_);
+            if (found == data_.data() + data_.size() || compare_(key, *found))
+                return data_.size();
+            return std::size_t(found - data_.data());
+        }
+        
+        const T& operator [](const std::size_t &index) const {
+            return data_[index];
+        }
+        
+        const T& at(const std::size_t &index) const {
+            return data_.at(index);
+        }
+        
+        const T& front() const {
+            return data_.front();
+        }
+        
+        const T& back() const {
+            return data_.back();
+        }
+        
+        const T* data() const noexcept {
+            return data_.data();
+        }
+        
+        const_iterator begin() const {
+            return data_.begin();
+        }
+        
+        const_iterator cbegin() const {
+            return data_.cbegin();
+        }
+        
+        const_iterator end() const {
+            return data_.end();
+        }
+        
+        const_iterator cend() const {
+            return data_.cend();
+        }
+        
+        const_reverse_iterator rbegin() const {
+            return data_.rbegin();
+        }
+        
+        const_reverse_iterator rend() const {
+            return data_.rend();
+        }
+        
+        key_compare key_comp() const {
+            return compare_;
+        }
+        
+        allocator_type get_allocator() const {
+            return data_.get_allocator();
+        }
+        
+        void swap(sorted_vector &other) noexcept(noexcept(std::declval<storage&>().swap(std::declval<storage&>()))) {
+            data_.swap(other.data_);
+            std::swap(compare_, other.compare_);
+        }
+        
+        bool operator ==(const sorted_vector &other) const {
+            return data_ == other.data_;
+        }
+        
+        bool operator !=(const sorted_vector &other) const {
+            return data_ != other.data_;
+        }
+    
+    private:
+        const_iterator position(const T* found) const {
+            return data_.cbegin() + (found - data_.data());
+        }
+        
+        storage data_; /*< Элементы по возрастанию*/
+        mutable Compare compare_; /*< Сравнение*/
+    };
+    
+    template<class T, class Compare, class Allocator>
+    inline void swap(sorted_vector<T, Compare, Allocator> &lhs, sorted_vector<T, Compare, Allocator> &rhs)
+    noexcept(noexcept(lhs.swap(rhs))) {
+        lhs.swap(rhs);
+    }
+    
+    /********************************************************
+     * \brief Множество только для чтения в раскладке
+     * Эйтцингера
+     ********************************************************
+     * Элементы лежат в порядке обхода в ширину неявного
+     * бинарного дерева поиска: потомки узла k - узлы 2k и
+     * 2k + 1. Первые уровни дерева, нужные каждому поиску,
+     * занимают несколько строк кэша в начале буфера, а
+     * потомки узла на несколько уровней вниз лежат рядом,
+     * что позволяет предвыбирать их заранее. На больших
+     * массивах поиск быстрее бинарного по упорядоченному
+     * массиву. Порядок хранения - не по возрастанию
+     */
+    
+    template<class T, class Compare = std::less<T>, class Allocator = malloc_allocator<T>>
+    class eytzinger_set {
+        typedef vector<T, Allocator> storage;
+    
+    public:
+        typedef T key_type;
+        typedef T value_type;
+        typedef Compare key_compare;
+        typedef typename storage::const_iterator const_iterator;
+        
+        eytzinger_set() {}
+        
+        /**********************************************
+         * Конструктор из упорядоченного множества
+         */
+        
+        explicit eytzinger_set(const sorted_vector<T, Compare, Allocator> &values)
+        :tree_(values.get_allocator()), compare_(values.key_comp()) {
+            build(values.data(), values.size());
+        }
+        
+        /**********************************************
+         * Конструктор из элементов [first, last)
+         **********************************************
+         * Повторы отбрасываются
+         */
+        
+        template<class InputIt, class = typename std::enable_if<detail::is_iterator<InputIt>::value>::type>
+        eytzinger_set(InputIt first, InputIt last, const Compare &comp = Compare())
+        :compare_(comp) {
+            const sorted_vector<T, Compare, Allocator> values(first, last, comp);
+            build(values.data(), values.size());
+        }
+        
+        std::size_t size() const noexcept {
+            return tree_.size();
+        }
+        
+        bool empty() const noexcept {
+            return tree_.empty();
+        }
+        
+        /********************************************************
+         * Наименьший элемент, не меньший key
+         ********************************************************
+         * Спуск по дереву без ветвлений: k = 2k + (узел < key).
+         * После выхода за лист младшие единичные биты k - это
+         * повороты направо после последнего поворота налево,
+         * их сдвиг дает узел ответа
+         ********************************************************
+         * \return Указатель на элемент или nullptr
+         */
+        
+        const T* lower_bound(const T &key) const {
+            const T* tree = tree_.data();
+            const std::size_t count = tree_.size();
+            std::size_t node = 1;
+            while (node <= count) {
+                if (node * prefetch_distance <= count)
+                    detail::prefetch(tree + node * prefetch_distance - 1);
+                node = 2 * node + std::size_t(compare_(tree[node - 1], key));
+            }
+            node >>= trailing_ones(node) + 1;
+            return node == 0 ? nullptr : tree + node - 1;
+        }
+        
+        const T* find(const T &key) const {
+            const T* found = lower_bound(key);
+            return found == nullptr || compare_(key, *found) ? nullptr : found;
+        }
+        
+        bool contains(const T &key) const {
+            return find(key) != nullptr;
+        }
+        
+        /********************************************************
+         * Элементы в порядке хранения (не по возрастанию)
+         */
+        
+        const_iterator begin() const {
+            return tree_.begin();
+        }
+        
+        const_iterator end() const {
+            return tree_.end();
+        }
+    
+    private:
+        static constexpr std::size_t prefetch_distance = sizeof(T) < 64 ? 64 / sizeof(T) : 1; /*< Узлов в строке кэша*/
+        
+        static std::size_t trailing_ones(std::size_t value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+            return std::size_t(__builtin_ctzll(~static_cast<unsigned long long>(value)));
+#else
+            std::size_t count = 0;
+            for (; value & 1; value >>= 1)
+                ++count;
+            return count;
+#endif
+        }
+        
+        /********************************************************
+         * Заполнение дерева из упорядоченного массива
+         ********************************************************
+         * \param values Элементы по возрастанию
+         * \param count Число элементов
+         */
+        
+        void build(const T* values, const std::size_t &count) {
+            vector<std::size_t> order;
+            order.resize(count);
+            number(order, 0, 1);
+            tree_.reserve(count);
+            for (std::size_t i = 0; i < count; ++i)
+                tree_.push_back(values[order[i]]);
+        }
+        
+        /********************************************************
+         * Номера в порядке возрастания для поддерева узла node
+         ********************************************************
+         * \param order Индексы элементов по узлам
+         * \param index Следующий индекс по возрастанию
+         * \param node Корень поддерева
+         * \return Индекс после поддерева
+         */
+        
+        static std::size_t number(vector<std::size_t> &order, std::size_t index, const std::size_t &node) {
+            if (node > order.size())
+                return index;
+            index = number(order, index, 2 * node);
+            order[node - 1] = index++;
+            return number(order, index, 2 * node + 1);
+        }
+        
+        storage tree_; /*< Элементы в порядке обхода в ширину*/
+        mutable Compare compare_; /*< Сравнение*/
+    };
+}
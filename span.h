@@ -0,0 +1,112 @@
+/********************************************************
+ * \file
+ * \brief Заголовочный файл с описанием класса 'span'
+ ********************************************************
+ * Файл содержит в себе непрерывный диапазон элементов
+ * без владения памятью 'span' (аналог std::span из C++20)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+namespace pva {
+    
+    /********************************************************
+     * \brief Непрерывный диапазон элементов
+     ********************************************************
+     * Хранит указатель и число элементов, память не
+     * принадлежит диапазону. Итераторы - обычные указатели,
+     * поэтому циклы по диапазону векторизуются компилятором.
+     * Диапазон действителен, пока не перевыделена память
+     * контейнера, из которого он получен
+     */
+    
+    template<class T>
+    class span {
+    public:
+        typedef T element_type;
+        typedef typename std::remove_cv<T>::type value_type;
+        typedef std::size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T* pointer;
+        typedef T& reference;
+        typedef T* iterator;
+        
+        /**********************************************
+         * Конструктор пустого диапазона
+         */
+        
+        span() noexcept
+        :data_(nullptr), count_(0) {}
+        
+        /**********************************************
+         * Конструктор диапазона [data, data + count)
+         */
+        
+        span(T* data, const std::size_t &count) noexcept
+        :data_(data), count_(count) {}
+        
+        /**********************************************
+         * Конструктор диапазона константных элементов
+         * из диапазона изменяемых
+         */
+        
+        template<class U, class = typename std::enable_if<std::is_same<const U, T>::value>::type>
+        span(const span<U> &copy) noexcept
+        :data_(copy.data()), count_(copy.size()) {}
+        
+        T* data() const noexcept {
+            return data_;
+        }
+        
+        std::size_t size() const noexcept {
+            return count_;
+        }
+        
+        bool empty() const noexcept {
+            return count_ == 0;
+        }
+        
+        T* begin() const noexcept {
+            return data_;
+        }
+        
+        T* end() const noexcept {
+            return data_ + count_;
+        }
+        
+        T& operator [](const std::size_t &index) const noexcept {
+            return data_[index];
+        }
+        
+        /********************************************************
+         * Доступ к элементу с проверкой индекса
+         ********************************************************
+         * \param index Индекс элемента
+         * \return Ссылку на элемент
+         */
+        
+        T& at(const std::size_t &index) const {
+            if (index >= count_)
+                throw std::out_of_range("Index more than size of span!");
+            return data_[index];
+        }
+        
+        /********************************************************
+         * Поддиапазон из count элементов, начиная с offset
+         */
+        
+        span subspan(const std::size_t &offset, const std::size_t &count) const {
+            if (offset > count_ || count > count_ - offset)
+                throw std::out_of_range("Subspan is out of range!");
+            return span(data_ + offset, count);
+        }
+    
+    private:
+        T* data_; /*< Первый элемент*/
+        std::size_t count_; /*< Число элементов*/
+    };
+}
@@ -0,0 +1,233 @@
+/********************************************************
+ * \file
+ * \brief Заголовочный файл со статистикой векторов
+ ********************************************************
+ * Файл содержит в себе счетчики выделений памяти,
+ * копирований и перемещений элементов 'vector_stats',
+ * их суммы по типам векторов и обработчик, которому
+ * вектор отдает свою статистику при разрушении. Счетчики
+ * включаются макросом PVA_STATS
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <typeinfo>
+
+#if defined(__has_include)
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#define PVA_HAS_DEMANGLE 1
+#endif
+#endif
+
+#ifndef PVA_HAS_DEMANGLE
+#define PVA_HAS_DEMANGLE 0
+#endif
+
+/********************************************************
+ * Статистика векторов
+ ********************************************************
+ * PVA_STATS = 1 включает счетчики в каждом pva::vector
+ * и их суммы по типам векторов. По умолчанию 0: вектор
+ * ничего не считает, не хранит счетчиков, а stats()
+ * возвращает нули. Значение должно быть одинаковым во
+ * всей программе
+ */
+
+#ifndef PVA_STATS
+#define PVA_STATS 0
+#endif
+
+namespace pva {
+    
+    /********************************************************
+     * \brief Счетчики операций вектора
+     ********************************************************
+     * Копирования и перемещения - это элементы, которые
+     * вектор создал или присвоил сам: при перевыделении,
+     * копировании вектора, вставке и удалении из середины.
+     * Побайтовый перенос считается перемещением
+     */
+    
+    struct vector_stats {
+        std::uint64_t allocations = 0; /*< Число выделений памяти*/
+        std::uint64_t deallocations = 0; /*< Число освобождений памяти*/
+        std::uint64_t bytes_allocated = 0; /*< Всего выделено байт*/
+        std::uint64_t copies = 0; /*< Скопировано элементов*/
+        std::uint64_t moves = 0; /*< Перемещено элементов*/
+        std::uint64_t reallocations = 0; /*< Число переносов элементов в новый буфер*/
+        std::uint64_t peak_capacity = 0; /*< Максимальная емкость*/
+    };
+    
+    /********************************************************
+     * Обработчик статистики разрушаемого вектора
+     ********************************************************
+     * \param type Имя типа вектора
+     * \param stats Статистика вектора за время его жизни
+     */
+    
+    typedef void (*stats_listener)(const char* type, const vector_stats &stats);
+    
+    namespace detail {
+        
+        /********************************************************
+         * \brief Сумма счетчиков всех векторов одного типа
+         ********************************************************
+         * Узлы всех типов образуют список, в который узел
+         * добавляет себя при создании и из которого не удаляется
+         */
+        
+        class stats_node {
+        public:
+            explicit stats_node(const char* name) noexcept
+            :name_(demangle(name)), next_(head().load(std::memory_order_relaxed)) {
+                while (!head().compare_exchange_weak(next_, this, std::memory_order_release,
+                                                     std::memory_order_relaxed)) {}
+            }
+            
+            stats_node(const stats_node &copy) = delete;
+            stats_node& operator =(const stats_node &copy) = delete;
+            
+            void allocate(const std::size_t &bytes, const std::size_t &capacity) noexcept {
+                allocations_.fetch_add(1, std::memory_order_relaxed);
+                bytes_allocated_.fetch_add(bytes, std::memory_order_relaxed);
+                std::uint64_t peak = peak_capacity_.load(std::memory_order_relaxed);
+                while (peak < capacity &&
+                       !peak_capacity_.compare_exchange_weak(peak, capacity, std::memory_order_relaxed)) {}
+            }
+            
+            void deallocate() noexcept {
+                deallocations_.fetch_add(1, std::memory_order_relaxed);
+            }
+            
+            void copy(const std::size_t &count) noexcept {
+                copies_.fetch_add(count, std::memory_order_relaxed);
+            }
+            
+            void move(const std::size_t &count) noexcept {
+                moves_.fetch_add(count, std::memory_order_relaxed);
+            }
+            
+            void reallocate() noexcept {
+                reallocations_.fetch_add(1, std::memory_order_relaxed);
+            }
+            
+            /********************************************************
+             * Снимок счетчиков
+             ********************************************************
+             * Счетчики читаются по одному, поэтому при параллельной
+             * работе векторов снимок может быть несогласованным
+             */
+            
+            vector_stats load() const noexcept {
+                vector_stats result;
+                result.allocations = allocations_.load(std::memory_order_relaxed);
+                result.deallocations = deallocations_.load(std::memory_order_relaxed);
+                result.bytes_allocated = bytes_allocated_.load(std::memory_order_relaxed);
+                result.copies = copies_.load(std::memory_order_relaxed);
+                result.moves = moves_.load(std::memory_order_relaxed);
+                result.reallocations = reallocations_.load(std::memory_order_relaxed);
+                result.peak_capacity = peak_capacity_.load(std::memory_order_relaxed);
+                return result;
+            }
+            
+            const char* name() const noexcept {
+                return name_;
+            }
+            
+            const stats_node* next() const noexcept {
+                return next_;
+            }
+            
+            /********************************************************
+             * Начало списка узлов
+             */
+            
+            static std::atomic<stats_node*>& head() noexcept {
+                static std::atomic<stats_node*> first{nullptr};
+                return first;
+            }
+        
+        private:
+            
+            /********************************************************
+             * Читаемое имя типа
+             ********************************************************
+             * Строка живет до конца программы, как и сам узел
+             */
+            
+            static const char* demangle(const char* name) noexcept {
+#if PVA_HAS_DEMANGLE
+                int status = 0;
+                char* result = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+                if (status == 0 && result)
+                    return result;
+#endif
+                return name;
+            }
+            
+            const char* name_; /*< Имя типа вектора*/
+            stats_node* next_; /*< Следующий узел списка*/
+            std::atomic<std::uint64_t> allocations_{0}; /*< Число выделений памяти*/
+            std::atomic<std::uint64_t> deallocations_{0}; /*< Число освобождений памяти*/
+            std::atomic<std::uint64_t> bytes_allocated_{0}; /*< Всего выделено байт*/
+            std::atomic<std::uint64_t> copies_{0}; /*< Скопировано элементов*/
+            std::atomic<std::uint64_t> moves_{0}; /*< Перемещено элементов*/
+            std::atomic<std::uint64_t> reallocations_{0}; /*< Число переносов в новый буфер*/
+            std::atomic<std::uint64_t> peak_capacity_{0}; /*< Максимальная емкость*/
+        };
+        
+        /********************************************************
+         * Узел суммы счетчиков типа Vector
+         */
+        
+        template<class Vector>
+        stats_node& stats_of() noexcept {
+            static stats_node node(typeid(Vector).name());
+            return node;
+        }
+        
+        /********************************************************
+         * Текущий обработчик статистики
+         */
+        
+        inline std::atomic<stats_listener>& listener() noexcept {
+            static std::atomic<stats_listener> current{nullptr};
+            return current;
+        }
+    }
+    
+    /********************************************************
+     * Установка обработчика статистики разрушаемых векторов
+     ********************************************************
+     * Обработчик вызывается из деструктора каждого вектора
+     * (только при PVA_STATS = 1), поэтому он не должен
+     * бросать исключений и должен быть потокобезопасным
+     ********************************************************
+     * \param listener Обработчик (nullptr - отключить)
+     * \return Предыдущий обработчик
+     */
+    
+    inline stats_listener set_stats_listener(stats_listener listener) noexcept {
+        return detail::listener().exchange(listener, std::memory_order_acq_rel);
+    }
+    
+    /********************************************************
+     * Обход сумм счетчиков по типам векторов
+     ********************************************************
+     * В обход попадают типы, у которых был хотя бы один
+     * подсчитанный вызов (только при PVA_STATS = 1)
+     ********************************************************
+     * \param function Функция вида function(const char* type, const vector_stats &stats)
+     */
+    
+    template<class Function>
+    void for_each_type_stats(Function function) {
+        const detail::stats_node* node = detail::stats_node::head().load(std::memory_order_acquire);
+        for (; node; node = node->next())
+            function(node->name(), node->load());
+    }
+}
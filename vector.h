@@ -9,7 +9,45 @@
 
 #pragma once
 
+#include "allocator.h"
+#include "compare.h"
+#include "stats.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/********************************************************
+ * Режим проверок
+ ********************************************************
+ * PVA_CHECKED = 1 включает проверку индексов в operator[],
+ * front(), back(), pop_back() и проверку действительности
+ * итераторов (для отладочных сборок и санитайзеров).
+ * Нарушение печатает сообщение и вызывает std::abort().
+ * По умолчанию 0: operator[] ничего не проверяет, at()
+ * проверяет индекс всегда. Значение должно быть одинаковым
+ * во всей программе
+ */
+
+#ifndef PVA_CHECKED
+#define PVA_CHECKED 0
+#endif
+
+#if PVA_CHECKED
+#define PVA_ASSERT(condition, message) \
+    ((condition) ? (void)0 : ::pva::detail::assertion_failed(message, __FILE__, __LINE__))
+#else
+#define PVA_ASSERT(condition, message) ((void)0)
+#endif
+
 /********************************************************
  * \brief Пространство имен pva
  ********************************************************
@@ -18,6 +56,18 @@
 
 namespace pva {
     
+    namespace detail {
+        
+        /********************************************************
+         * Сообщение о нарушенной проверке PVA_ASSERT
+         */
+        
+        [[noreturn]] inline void assertion_failed(const char* message, const char* file, int line) {
+            std::cerr << file << ":" << line << ": " << message << std::endl;
+            std::abort();
+        }
+    }
+    
     /**************************************************************
      * Функция для работы с rvalue - ссылками (начиная с С++11)
      **************************************************************
@@ -26,30 +76,146 @@ namespace pva {
      */
     
     template<class T>
-    T&& move(T&& value) {
-        return value;
+    typename std::remove_reference<T>::type&& move(T&& value) noexcept {
+        return static_cast<typename std::remove_reference<T>::type&&>(value);
+    }
+    
+    /**************************************************************
+     * Функция для прямой передачи аргументов (начиная с С++11)
+     **************************************************************
+     * \param value Ссылка на объект
+     * \return Ссылку той же категории, с которой был передан объект
+     */
+    
+    template<class T>
+    T&& forward(typename std::remove_reference<T>::type &value) noexcept {
+        return static_cast<T&&>(value);
+    }
+    
+    template<class T>
+    T&& forward(typename std::remove_reference<T>::type &&value) noexcept {
+        return static_cast<T&&>(value);
     }
     
+    /********************************************************
+     * \brief Политика роста емкости вектора
+     ********************************************************
+     * При нехватке места емкость умножается на Num / Den, но не
+     * становится меньше требуемой. Любой функтор с такой же
+     * сигнатурой operator() может использоваться вместо нее
+     */
+    
+    template<std::size_t Num, std::size_t Den = 1>
+    struct growth_factor {
+        static_assert(Den != 0 && Num > Den, "Growth factor must be greater than 1");
+        
+        /********************************************************
+         * Вычисление новой емкости
+         ********************************************************
+         * \param capacity Текущая емкость вектора
+         * \param required Минимально необходимая емкость
+         * \return Новая емкость вектора
+         */
+        
+        std::size_t operator ()(const std::size_t &capacity, const std::size_t &required) const {
+            const std::size_t max = std::numeric_limits<std::size_t>::max();
+            if (capacity > max / Num)
+                return required > max / Den ? required : max / Den;
+            std::size_t next = capacity * Num / Den;
+            return next < required ? required : next;
+        }
+    };
+    
+    typedef growth_factor<2> growth_double; /*< Рост в 2 раза*/
+    typedef growth_factor<3, 2> growth_one_and_half; /*< Рост в 1.5 раза*/
+    
+    /********************************************************
+     * \brief Можно ли переносить объекты типа T побайтово
+     ********************************************************
+     * Перенос (перемещение с разрушением исходника) таких
+     * объектов заменяется на memcpy/memmove и realloc. По
+     * умолчанию верно для тривиально копируемых типов; для
+     * своих типов (например, владеющих указателем без ссылок
+     * на самих себя) можно специализировать
+     */
+    
+    template<class T>
+    struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+    
     /********************************************************
      * \brief Класс - итератор
      ********************************************************
-     * Описание выше
+     * Непрерывный итератор произвольного доступа: элементы
+     * лежат в памяти подряд, поэтому итератор - обертка над
+     * указателем, и алгоритмы STL выбирают для него самые
+     * быстрые реализации. iterator<const T> - константный
+     * итератор, в него неявно преобразуется iterator<T>
      */
     
     template<class T>
     class iterator {
+        template<class U>
+        friend class iterator;
+        
     public:
+        typedef std::random_access_iterator_tag iterator_category;
+#ifdef __cpp_lib_concepts
+        typedef std::contiguous_iterator_tag iterator_concept;
+#endif
+        typedef typename std::remove_cv<T>::type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T* pointer;
+        typedef T& reference;
+        
         /**********************************************
          * Конструктор по умолчанию
          **********************************************
-         * \param ptr Указатель на элемент вектор(изначально nullptr)
+         * Итератор ни на что не указывает
+         */
+        
+        iterator() noexcept
+        :ptr_(nullptr) {}
+        
+        /**********************************************
+         * Конструктор итератора на элемент
+         **********************************************
+         * \param ptr Указатель на элемент вектора
          */
         
-        explicit iterator(T* ptr = nullptr)
+        explicit iterator(T* ptr) noexcept
         :ptr_(ptr) {}
         
-        iterator(const iterator &copy)
-        :ptr_(copy.ptr_) {}
+#if PVA_CHECKED
+        /**********************************************
+         * Конструктор проверяемого итератора
+         **********************************************
+         * \param ptr Указатель на элемент вектора
+         * \param version Счетчик изменений вектора: итератор
+         * действителен, пока счетчик не изменился
+         */
+        
+        iterator(T* ptr, const std::size_t* version)
+        :ptr_(ptr), version_(version), expected_(*version) {}
+#endif
+        
+        iterator(const iterator &copy) = default;
+        
+        /**********************************************
+         * Преобразование iterator<T> в iterator<const T>
+         **********************************************
+         * \param copy Неконстантный итератор
+         */
+        
+        template<class U, class = typename std::enable_if<std::is_same<const U, T>::value &&
+                                                           !std::is_same<U, T>::value>::type>
+        iterator(const iterator<U> &copy) noexcept
+        :ptr_(copy.ptr_)
+#if PVA_CHECKED
+        , version_(copy.version_), expected_(copy.expected_)
+#endif
+        {}
+        
+        iterator& operator =(const iterator &copy) = default;
         
         /**********************************************
          * Деструктор
@@ -65,18 +231,32 @@ namespace pva {
          * \return Ссылку на разыменованный элемент
          */
         
-        T& operator *(){
+        T& operator *() const {
+            PVA_ASSERT(valid(), "Iterator is invalidated!");
             return *ptr_;
         }
         
         /********************************************************
-         * Перегруженный оператор * (разыменование)
+         * Перегруженный оператор -> (обращение к члену элемента)
          ********************************************************
-         * \return Ссылку на разыменованный элемент
+         * \return Указатель на элемент
          */
         
-        const T& operator *() const {
-            return *ptr_;
+        T* operator ->() const {
+            PVA_ASSERT(valid(), "Iterator is invalidated!");
+            return ptr_;
+        }
+        
+        /********************************************************
+         * Перегруженный оператор [] (обращение к элементу со смещением)
+         ********************************************************
+         * \param offset Смещение относительно итератора
+         * \return Ссылку на элемент
+         */
+        
+        T& operator [](const difference_type &offset) const {
+            PVA_ASSERT(valid(), "Iterator is invalidated!");
+            return ptr_[offset];
         }
         
         /********************************************************
@@ -93,474 +273,2179 @@ namespace pva {
         /********************************************************
          * Перегруженный оператор ++ (инкремент постфиксный)
          ********************************************************
-         * \return Итератор
+         * \return Итератор до инкремента
          */
         
         iterator operator ++(int) {
-            ptr_++;
+            iterator old(*this);
+            ++ptr_;
+            return old;
+        }
+        
+        /********************************************************
+         * Перегруженный оператор -- (декремент префиксный)
+         ********************************************************
+         * \return Итератор
+         */
+        
+        iterator& operator --() {
+            --ptr_;
+            return *this;
+        }
+        
+        /********************************************************
+         * Перегруженный оператор -- (декремент постфиксный)
+         ********************************************************
+         * \return Итератор до декремента
+         */
+        
+        iterator operator --(int) {
+            iterator old(*this);
+            --ptr_;
+            return old;
+        }
+        
+        /********************************************************
+         * Перегруженный оператор += (сложение, совмещенное с присваиванием)
+         ********************************************************
+         * \param size Число, на которое нужно переместиться по контейнеру, используя итератор
+         * \return Итератор
+         */
+        
+        iterator& operator +=(const difference_type &size) {
+            ptr_ += size;
+            return *this;
+        }
+        
+        /********************************************************
+         * Перегруженный оператор + (сложение)
+         ********************************************************
+         * \param size Число, на которое нужно переместиться по контейнеру, используя итератор
+         * \return Новый итератор
+         */
+        
+        iterator operator +(const difference_type &size) const {
+            iterator result(*this);
+            result.ptr_ += size;
+            return result;
+        }
+        
+        /********************************************************
+         * Перегруженный оператор -= (вычитание, совмещенное с присваиванием)
+         ********************************************************
+         * \param size Число, на которое нужно переместиться по контейнеру, используя итератор
+         * \return Итератор
+         */
+        
+        iterator& operator -=(const difference_type &size){
+            ptr_ -= size;
             return *this;
         }
         
         /********************************************************
-         * Перегруженный оператор -- (декремент префиксный)
+         * Перегруженный оператор - (вычитание)
+         ********************************************************
+         * \param size Число, на которое нужно переместиться по контейнеру, используя итератор
+         * \return Новый итератор
+         */
+        
+        iterator operator -(const difference_type &size) const{
+            iterator result(*this);
+            result.ptr_ -= size;
+            return result;
+        }
+        
+        /*****************************************************
+         * Получение доступа к указателю вне класса
+         */
+        
+        T* base() const {
+            return ptr_;
+        }
+        
+        /*****************************************************
+         * Проверка, что вектор не менялся после создания итератора
+         *****************************************************
+         * \return True - итератор действителен (или не проверяется)
+         */
+        
+        bool valid() const {
+#if PVA_CHECKED
+            return !version_ || *version_ == expected_;
+#else
+            return true;
+#endif
+        }
+        
+    protected:
+        T* ptr_; /*< Указатель на элемент*/
+#if PVA_CHECKED
+        const std::size_t* version_ = nullptr; /*< Счетчик изменений вектора*/
+        std::size_t expected_ = 0; /*< Значение счетчика при создании итератора*/
+#endif
+    };
+    
+    namespace detail {
+        
+        /********************************************************
+         * \brief Хранилище аллокатора контейнера
+         ********************************************************
+         * Пустые аллокаторы хранятся как базовый класс, чтобы
+         * не увеличивать размер контейнера
+         */
+        
+        template<class Allocator,
+                 bool = std::is_empty<Allocator>::value && !std::is_final<Allocator>::value>
+        class allocator_holder : private Allocator {
+        public:
+            explicit allocator_holder(const Allocator &allocator)
+            :Allocator(allocator) {}
+            
+            explicit allocator_holder(Allocator &&allocator) noexcept
+            :Allocator(pva::move(allocator)) {}
+            
+            Allocator& alloc() noexcept {
+                return *this;
+            }
+            
+            const Allocator& alloc() const noexcept {
+                return *this;
+            }
+        };
+        
+        template<class Allocator>
+        class allocator_holder<Allocator, false> {
+        public:
+            explicit allocator_holder(const Allocator &allocator)
+            :allocator_(allocator) {}
+            
+            explicit allocator_holder(Allocator &&allocator) noexcept
+            :allocator_(pva::move(allocator)) {}
+            
+            Allocator& alloc() noexcept {
+                return allocator_;
+            }
+            
+            const Allocator& alloc() const noexcept {
+                return allocator_;
+            }
+            
+        private:
+            Allocator allocator_; /*< Аллокатор контейнера*/
+        };
+        
+        /********************************************************
+         * Проверка, умеет ли аллокатор allocate_at_least
+         */
+        
+        template<class Allocator, class = void>
+        struct has_allocate_at_least : std::false_type {};
+        
+        template<class Allocator>
+        struct has_allocate_at_least<Allocator, decltype(void(
+            std::declval<Allocator&>().allocate_at_least(std::size_t())))> : std::true_type {};
+        
+        /********************************************************
+         * Проверка, может ли аллокатор хранить элементы внутри себя
+         * (есть метод is_local)
+         */
+        
+        template<class Allocator, class = void>
+        struct has_local_storage : std::false_type {};
+        
+        template<class Allocator>
+        struct has_local_storage<Allocator, decltype(void(
+            std::declval<const Allocator&>().is_local(nullptr)))> : std::true_type {};
+        
+        /********************************************************
+         * Проверка, является ли It итератором
+         */
+        
+        template<class It, class = void>
+        struct is_iterator : std::false_type {};
+        
+        template<class It>
+        struct is_iterator<It, std::void_t<typename std::iterator_traits<It>::iterator_category>>
+        : std::true_type {};
+        
+        /********************************************************
+         * Проверка, можно ли пройти по [first, last) несколько раз
+         * (и заранее узнать длину диапазона)
+         */
+        
+        template<class It>
+        struct is_forward_iterator : std::is_base_of<std::forward_iterator_tag,
+            typename std::iterator_traits<It>::iterator_category> {};
+        
+        /********************************************************
+         * Проверка, является ли It указателем на T (диапазон
+         * можно копировать одним memcpy)
+         */
+        
+        template<class It, class T>
+        struct is_pointer_to : std::integral_constant<bool, std::is_pointer<It>::value &&
+            std::is_same<typename std::remove_cv<typename std::remove_pointer<It>::type>::type, T>::value> {};
+        
+        /********************************************************
+         * Проверка, умеет ли аллокатор reallocate (расширение
+         * буфера без поэлементного переноса, как realloc)
+         */
+        
+        template<class Allocator, class = void>
+        struct has_reallocate : std::false_type {};
+        
+        template<class Allocator>
+        struct has_reallocate<Allocator, decltype(void(
+            std::declval<Allocator&>().reallocate(std::declval<typename Allocator::value_type*>(),
+                                                  std::size_t(), std::size_t())))> : std::true_type {};
+        
+        /********************************************************
+         * Проверка, сообщает ли аллокатор, что буфер занимает
+         * собственные страницы (owns_pages: выделен через mmap,
+         * а не в куче malloc вперемешку с чужими данными)
+         */
+        
+        template<class Allocator, class = void>
+        struct has_owns_pages : std::false_type {};
+        
+        template<class Allocator>
+        struct has_owns_pages<Allocator, decltype(void(Allocator::owns_pages(std::size_t())))> : std::true_type {};
+        
+        /********************************************************
+         * Проверка, создает ли аллокатор объекты как placement new
+         * (нет своих construct и destroy), чтобы их можно было
+         * копировать побайтово
+         */
+        
+        template<class Allocator, class T, class = void>
+        struct has_construct : std::false_type {};
+        
+        template<class Allocator, class T>
+        struct has_construct<Allocator, T, decltype(void(
+            std::declval<Allocator&>().construct(std::declval<T*>(), std::declval<T&&>())))> : std::true_type {};
+        
+        template<class Allocator, class T, class = void>
+        struct has_destroy : std::false_type {};
+        
+        template<class Allocator, class T>
+        struct has_destroy<Allocator, T, decltype(void(
+            std::declval<Allocator&>().destroy(std::declval<T*>())))> : std::true_type {};
+        
+        template<class Allocator, class T>
+        struct default_construct : std::integral_constant<bool,
+            std::is_same<Allocator, std::allocator<T>>::value ||
+            (!has_construct<Allocator, T>::value && !has_destroy<Allocator, T>::value)> {};
+        
+        /********************************************************
+         * \brief Метка политики параллельного создания элементов
+         ********************************************************
+         * Сама политика (parallel::policy) описана в parallel.h:
+         * вектор только вызывает ее place(), run() и slices()
+         */
+        
+        struct parallel_policy {};
+        
+        template<class Policy>
+        struct is_parallel_policy : std::is_base_of<parallel_policy, Policy> {};
+        
+        /********************************************************
+         * Обмен аллокаторов (с поиском swap через ADL)
+         */
+        
+        template<class Allocator>
+        inline void swap_allocators(Allocator &lhs, Allocator &rhs) {
+            using std::swap;
+            swap(lhs, rhs);
+        }
+    }
+    
+    /********************************************************
+     * \brief Класс - вектор
+     ********************************************************
+     * Данный класс - реализация класса 'vector' из STL.
+     * Память выделяется через Allocator (модель аллокаторов STL,
+     * включая propagate_on_container_* и
+     * select_on_container_copy_construction).
+     * Побайтово переносимые элементы (is_trivially_relocatable)
+     * переносятся memcpy/memmove, а буфер растет через reallocate
+     * аллокатора, если он его умеет (см. malloc_allocator).
+     * GrowthPolicy определяет, во сколько раз растет емкость
+     * при нехватке места (см. growth_factor)
+     */
+    
+    template<class T, class Allocator = malloc_allocator<T>, class GrowthPolicy = growth_double>
+    class vector : private detail::allocator_holder<Allocator> {
+        typedef detail::allocator_holder<Allocator> holder;
+        typedef std::allocator_traits<Allocator> alloc_traits;
+        
+    public:
+        typedef T value_type;
+        typedef Allocator allocator_type;
+        typedef std::size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef T* pointer;
+        typedef const T* const_pointer;
+        typedef pva::iterator<T> iterator;
+        typedef pva::iterator<const T> const_iterator;
+        typedef std::reverse_iterator<iterator> reverse_iterator;
+        typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+        
+        /**********************************************
+         * Конструктор по умолчанию
+         */
+        
+        vector() noexcept(noexcept(Allocator()))
+        :holder(Allocator()), size_(0), count_(0), data_(nullptr) {}
+        
+        /**********************************************
+         * Конструктор пустого вектора с заданным аллокатором
+         **********************************************
+         * \param allocator Аллокатор, через который выделяется память
+         */
+        
+        explicit vector(const Allocator &allocator) noexcept
+        :holder(allocator), size_(0), count_(0), data_(nullptr) {}
+        
+        /********************************************************
+         * Конструктор, который задает вектору определнный размер
+         ********************************************************
+         * Выделяет память под size элементов, не создавая их
+         ********************************************************
+         * \param size Размер вектора
+         * \param allocator Аллокатор, через который выделяется память
+         */
+        
+        explicit vector(const std::size_t &size, const Allocator &allocator = Allocator())
+        :holder(allocator), size_(size), count_(0), data_(allocate(size_)) {}
+        
+        /********************************************************
+         * Конструктор, который задает вектор размерм size и
+         * копирует элементы из массива data в вектор
+         ********************************************************
+         * \param size Размер вектора
+         * \param data Массив, который скопируется в вектор
+         * \param allocator Аллокатор, через который выделяется память
+         */
+        
+        vector(const std::size_t &size, const T* data, const Allocator &allocator = Allocator())
+        :holder(allocator), size_(size), count_(0), data_(allocate(size_)) {
+            copy_construct(data, data + size, size);
+        }
+        
+        /********************************************************
+         * Конструктор из диапазона [first, last)
+         ********************************************************
+         * Для однопроходных итераторов элементы добавляются по
+         * одному, иначе память выделяется один раз
+         ********************************************************
+         * \param first Начало диапазона
+         * \param last Конец диапазона
+         * \param allocator Аллокатор, через который выделяется память
+         */
+        
+        template<class InputIt, class = typename std::enable_if<detail::is_iterator<InputIt>::value>::type>
+        vector(InputIt first, InputIt last, const Allocator &allocator = Allocator())
+        :holder(allocator), size_(0), count_(0), data_(nullptr) {
+            if constexpr (detail::is_forward_iterator<InputIt>::value) {
+                const std::size_t count = std::distance(first, last);
+                size_ = count;
+                data_ = allocate(size_);
+                copy_construct(first, last, count);
+            }
+            else {
+                try {
+                    for (; first != last; ++first)
+                        emplace_back(*first);
+                }
+                catch (...) {
+                    release();
+                    throw;
+                }
+            }
+        }
+        
+        /********************************************************
+         * Параллельный конструктор из size копий value
+         ********************************************************
+         * Куски буфера создаются на потоках пула политики
+         * (см. parallel::policy в parallel.h): страницы
+         * многогигабайтного вектора оказываются на узлах NUMA
+         * потоков, которые потом обрабатывают эти куски
+         ********************************************************
+         * \param size Число элементов
+         * \param value Значение элементов
+         * \param policy Политика, например parallel::par
+         * \param allocator Аллокатор, через который выделяется память
+         */
+        
+        template<class Policy, class = typename std::enable_if<detail::is_parallel_policy<Policy>::value>::type>
+        vector(const std::size_t &size, const T &value, const Policy &policy, const Allocator &allocator = Allocator())
+        :holder(allocator), size_(size), count_(0), data_(allocate(size_)) {
+            place(policy);
+            try {
+                fill_parallel(size, value, policy);
+            }
+            catch (...) {
+                release();
+                throw;
+            }
+        }
+        
+        /**************************************************************
+         * Конструктор копирования
+         **************************************************************
+         * \param copy Внешний объект, который надо скопировать в новый
+         */
+        
+        vector(const vector &copy)
+        :holder(alloc_traits::select_on_container_copy_construction(copy.alloc())),
+        size_(copy.count_), count_(0), data_(allocate(size_)) {
+            copy_construct(copy.data_, copy.data_ + copy.count_, copy.count_);
+        }
+        
+        /**************************************************************
+         * Параллельный конструктор копирования
+         **************************************************************
+         * \param copy Внешний объект, который надо скопировать в новый
+         * \param policy Политика, например parallel::par
+         */
+        
+        template<class Policy, class = typename std::enable_if<detail::is_parallel_policy<Policy>::value>::type>
+        vector(const vector &copy, const Policy &policy)
+        :holder(alloc_traits::select_on_container_copy_construction(copy.alloc())),
+        size_(copy.count_), count_(0), data_(allocate(size_)) {
+            place(policy);
+            try {
+                copy_parallel(copy.data_, copy.count_, policy);
+            }
+            catch (...) {
+                deallocate(data_, size_);
+                throw;
+            }
+        }
+        
+        /**************************************************************
+         * Конструктор перемещения (начиная с С++11)
+         **************************************************************
+         * Забирает буфер у copy без выделения памяти и копирования
+         * элементов, copy остается пустым. Если элементы copy лежат
+         * внутри его аллокатора (см. inline_allocator), они
+         * перемещаются по одному
+         **************************************************************
+         * \param copy Внешний объект, который надо переместить в новый
+         */
+        
+        vector(vector &&copy)
+        noexcept(!detail::has_local_storage<Allocator>::value ||
+                 std::is_nothrow_move_constructible<T>::value)
+        :holder(pva::move(copy.alloc())), size_(copy.size_), count_(copy.count_), data_(copy.data_) {
+            if constexpr (detail::has_local_storage<Allocator>::value) {
+                if (copy.local()) {
+                    size_ = 0;
+                    count_ = 0;
+                    data_ = nullptr;
+                    move_elements(copy);
+                    return;
+                }
+            }
+            copy.size_ = 0;
+            copy.count_ = 0;
+            copy.data_ = nullptr;
+        }
+        
+        /********************************************************
+         * Деструктор
+         ********************************************************
+         * Разрушает элементы и освобождает память от массива data_
+         */
+        
+        ~vector() {
+            release();
+#if PVA_STATS
+            if (stats_listener listener = detail::listener().load(std::memory_order_acquire))
+                listener(detail::stats_of<vector>().name(), stats_);
+#endif
+        }
+        
+        /********************************************************
+         * Резервирование памяти под вектор
+         ********************************************************
+         * Если емкость уже не меньше size, ничего не происходит,
+         * иначе элементы переносятся в буфер емкостью size
+         ********************************************************
+         * \param size Размер, который нужно выделить под вектор
+         * \return True - память выделилась, false - обратное
+         */
+        
+        bool reserve(const std::size_t &size) {
+            if (size <= size_)
+                return false;
+            reallocate(size);
+            return true;
+        }
+        
+        /********************************************************
+         * Получаем размер вектора
+         ********************************************************
+         * \return Размер вектора, под который выделена памятиь
+         * (не количесвто объектов в векторе)
+         */
+        
+        std::size_t capacity() const {
+            return size_;
+        }
+        
+        /********************************************************
+         * Получаем количество элементов в векторе
+         ********************************************************
+         * \return Количество элементов в векторе
+         */
+        
+        std::size_t size() const {
+            return count_;
+        }
+        
+        /********************************************************
+         * Проверка на наличие элементов в векторе
+         ********************************************************
+         * \return True - элементов нет, false - обратное
+         */
+        
+        bool empty() const {
+            if (count_ == 0)
+                return true;
+            return false;
+        }
+        
+        /****************************************************************
+         * Заполняем вектор копиями значения
+         ****************************************************************
+         * \param size Число копий
+         * \param value Значение, которое надо записать size раз в вектор
+         */
+        
+        void assign(const std::size_t &size, const T &value) {
+            invalidate();
+            T copy(value); // value может ссылаться на элемент этого же вектора
+            truncate(0);
+            if (size > size_) {
+                release();
+                std::size_t capacity = size;
+                data_ = allocate(capacity);
+                size_ = capacity;
+            }
+            for (; count_ < size; ++count_)
+                construct(data_ + count_, copy);
+        }
+        
+        /****************************************************************
+         * Параллельное заполнение вектора копиями значения
+         ****************************************************************
+         * Если емкости не хватает, новый буфер размещается и
+         * создается кусками на потоках пула, как в параллельном
+         * конструкторе
+         ****************************************************************
+         * \param size Число копий
+         * \param value Значение, которое надо записать size раз в вектор
+         * \param policy Политика, например parallel::par
+         */
+        
+        template<class Policy, class = typename std::enable_if<detail::is_parallel_policy<Policy>::value>::type>
+        void assign(const std::size_t &size, const T &value, const Policy &policy) {
+            invalidate();
+            T copy(value); // value может ссылаться на элемент этого же вектора
+            truncate(0);
+            if (size > size_) {
+                release();
+                std::size_t capacity = size;
+                data_ = allocate(capacity);
+                size_ = capacity;
+                place(policy);
+            }
+            fill_parallel(size, copy, policy);
+        }
+        
+        /********************************************************
+         * Добавление элемента в конец вектора значений
+         ********************************************************
+         * При нехватке места емкость растет согласно GrowthPolicy,
+         * поэтому добавление выполняется за амортизированное O(1)
+         ********************************************************
+         * \param value Значение вставляемого элемента
+         */
+        
+        void push_back(const T &value) {
+            emplace_back(value);
+        }
+        
+        /********************************************************
+         * Добавление элемента в конец вектора значений через rvalue - ссылки (начиная с С++11)
+         ********************************************************
+         * \param value Значение вставляемого элемента
+         */
+        
+        void push_back(T &&value) {
+            emplace_back(pva::move(value));
+        }
+        
+        /********************************************************
+         * Создание элемента в конце вектора
+         ********************************************************
+         * Элемент конструируется сразу в памяти вектора из args
+         ********************************************************
+         * \param args Аргументы конструктора элемента
+         * \return Ссылку на созданный элемент
+         */
+        
+        template<class... Args>
+        T& emplace_back(Args&&... args) {
+            if (count_ == size_)
+                return emplace_reallocate(count_, pva::forward<Args>(args)...);
+            construct(data_ + count_, pva::forward<Args>(args)...);
+            return data_[count_++];
+        }
+        
+        /********************************************************
+         * Создание элемента перед позицией pos
+         ********************************************************
+         * Элементы после pos сдвигаются на одну позицию вправо
+         ********************************************************
+         * \param pos Итератор на позицию вставки
+         * \param args Аргументы конструктора элемента
+         * \return Итератор на созданный элемент
+         */
+        
+        template<class... Args>
+        iterator emplace(const_iterator pos, Args&&... args) {
+            PVA_ASSERT(owns(pos), "Iterator is out of range!");
+            const std::size_t index = pos.base() - data_;
+            if (count_ == size_)
+                return make_iterator(&emplace_reallocate(index, pva::forward<Args>(args)...));
+            if (index == count_) {
+                construct(data_ + count_, pva::forward<Args>(args)...);
+                ++count_;
+                return make_iterator(data_ + index);
+            }
+            T value(pva::forward<Args>(args)...);
+            invalidate();
+            if constexpr (relocate_bitwise) {
+                std::memmove(static_cast<void*>(data_ + index + 1), data_ + index,
+                             (count_ - index) * sizeof(T));
+                count_moves(count_ - index);
+                construct(data_ + index, pva::move(value));
+                ++count_;
+                return make_iterator(data_ + index);
+            }
+            construct(data_ + count_, pva::move(data_[count_ - 1]));
+            ++count_;
+            for (std::size_t i = count_ - 2; i > index; --i)
+                data_[i] = pva::move(data_[i - 1]);
+            data_[index] = pva::move(value);
+            count_moves(count_ - index);
+            return make_iterator(data_ + index);
+        }
+        
+        /********************************************************
+         * Вставка элемента перед позицией pos
+         ********************************************************
+         * \param pos Итератор на позицию вставки
+         * \param value Значение вставляемого элемента
+         * \return Итератор на вставленный элемент
+         */
+        
+        iterator insert(const_iterator pos, const T &value) {
+            return emplace(pos, value);
+        }
+        
+        /********************************************************
+         * Вставка элемента перед позицией pos через rvalue - ссылки
+         ********************************************************
+         * \param pos Итератор на позицию вставки
+         * \param value Значение вставляемого элемента
+         * \return Итератор на вставленный элемент
+         */
+        
+        iterator insert(const_iterator pos, T &&value) {
+            return emplace(pos, pva::move(value));
+        }
+        
+        /********************************************************
+         * Вставка диапазона [first, last) перед позицией pos
+         ********************************************************
+         * Итоговый размер считается заранее: память выделяется не
+         * больше одного раза, а хвост сдвигается один раз (для
+         * побайтово переносимых элементов - одним memmove).
+         * Диапазон не должен указывать в этот же вектор
+         ********************************************************
+         * \param pos Итератор на позицию вставки
+         * \param first Начало диапазона
+         * \param last Конец диапазона
+         * \return Итератор на первый вставленный элемент
+         */
+        
+        template<class InputIt, class = typename std::enable_if<detail::is_iterator<InputIt>::value>::type>
+        iterator insert(const_iterator pos, InputIt first, InputIt last) {
+            PVA_ASSERT(owns(pos), "Iterator is out of range!");
+            const std::size_t index = pos.base() - data_;
+            if constexpr (!detail::is_forward_iterator<InputIt>::value) {
+                vector temp(first, last, this->alloc());
+                return insert(pos, std::make_move_iterator(temp.data_),
+                              std::make_move_iterator(temp.data_ + temp.count_));
+            }
+            else {
+                const std::size_t count = std::distance(first, last);
+                if (count == 0)
+                    return make_iterator(data_ + index);
+                if (count > size_ - count_ && !grow_in_place(count_ + count)) {
+                    insert_reallocate(index, first, last, count);
+                    return make_iterator(data_ + index);
+                }
+                invalidate();
+                T* position = data_ + index;
+                T* end = data_ + count_;
+                const std::size_t after = count_ - index;
+                if constexpr (relocate_bitwise) {
+                    std::memmove(static_cast<void*>(position + count), position, after * sizeof(T));
+                    count_moves(after);
+                    try {
+                        uninitialized_copy(first, last, position);
+                    }
+                    catch (...) {
+                        std::memmove(static_cast<void*>(position), position + count, after * sizeof(T));
+                        throw;
+                    }
+                    count_ += count;
+                }
+                else if (after > count) {
+                    uninitialized_move(end - count, end, end);
+                    count_ += count;
+                    for (T* from = end - count, *to = end; from != position;)
+                        *--to = pva::move(*--from);
+                    count_moves(after - count);
+                    for (; first != last; ++first, ++position)
+                        *position = *first;
+                    count_copies(count);
+                }
+                else {
+                    InputIt middle = first;
+                    std::advance(middle, after);
+                    uninitialized_copy(middle, last, end);
+                    count_ += count - after;
+                    uninitialized_move(position, end, position + count);
+                    count_ += after;
+                    for (; first != middle; ++first, ++position)
+                        *position = *first;
+                    count_copies(after);
+                }
+                return make_iterator(data_ + index);
+            }
+        }
+        
+        /********************************************************
+         * Добавление диапазона [first, last) в конец вектора
+         ********************************************************
+         * \param first Начало диапазона
+         * \param last Конец диапазона
+         */
+        
+        template<class InputIt, class = typename std::enable_if<detail::is_iterator<InputIt>::value>::type>
+        void append(InputIt first, InputIt last) {
+            insert(cend(), first, last);
+        }
+        
+        /********************************************************
+         * Замена содержимого вектора диапазоном [first, last)
+         ********************************************************
+         * Если емкости хватает, память не перевыделяется
+         ********************************************************
+         * \param first Начало диапазона
+         * \param last Конец диапазона
+         */
+        
+        template<class InputIt, class = typename std::enable_if<detail::is_iterator<InputIt>::value>::type>
+        void assign(InputIt first, InputIt last) {
+            invalidate();
+            if constexpr (!detail::is_forward_iterator<InputIt>::value) {
+                truncate(0);
+                for (; first != last; ++first)
+                    emplace_back(*first);
+            }
+            else {
+                const std::size_t count = std::distance(first, last);
+                if (count > size_) {
+                    std::size_t capacity = count;
+                    T* data = allocate(capacity);
+                    try {
+                        uninitialized_copy(first, last, data);
+                    }
+                    catch (...) {
+                        deallocate(data, capacity);
+                        throw;
+                    }
+                    release();
+                    data_ = data;
+                    size_ = capacity;
+                    count_ = count;
+                    return;
+                }
+                if constexpr (copy_bitwise) {
+                    count_ = 0;
+                    uninitialized_copy(first, last, data_);
+                    count_ = count;
+                    return;
+                }
+                T* current = data_;
+                for (T* end = data_ + (count < count_ ? count : count_); current != end; ++current, ++first)
+                    *current = *first;
+                count_copies(current - data_);
+                if (count > count_) {
+                    uninitialized_copy(first, last, current);
+                    count_ = count;
+                }
+                else
+                    truncate(count);
+            }
+        }
+        
+        /********************************************************
+         * Удаление элемента в позиции pos
+         ********************************************************
+         * \param pos Итератор на удаляемый элемент
+         * \return Итератор на элемент, следующий за удаленным
+         */
+        
+        iterator erase(const_iterator pos) {
+            return erase(pos, pos + 1);
+        }
+        
+        /********************************************************
+         * Удаление элементов [first, last)
+         ********************************************************
+         * Хвост сдвигается один раз (для побайтово переносимых
+         * элементов - одним memmove)
+         ********************************************************
+         * \param first Начало удаляемого диапазона
+         * \param last Конец удаляемого диапазона
+         * \return Итератор на элемент, следующий за удаленными
+         */
+        
+        iterator erase(const_iterator first, const_iterator last) {
+            PVA_ASSERT(owns(first) && owns(last) && !(last < first), "Iterator is out of range!");
+            T* from = data_ + (first.base() - data_);
+            T* to = data_ + (last.base() - data_);
+            const std::size_t count = to - from;
+            if (count == 0)
+                return make_iterator(from);
+            invalidate();
+            T* end = data_ + count_;
+            if constexpr (relocate_bitwise) {
+                destroy(from, to);
+                std::memmove(static_cast<void*>(from), to, (end - to) * sizeof(T));
+            }
+            else {
+                for (T* current = from; to != end; ++current, ++to)
+                    *current = pva::move(*to);
+                destroy(end - count, end);
+            }
+            count_moves(end - (from + count));
+            count_ -= count;
+            return make_iterator(from);
+        }
+        
+        /********************************************************
+         * Удаление последнего элемента вектора
+         ********************************************************
+         * Емкость вектора не меняется
+         */
+        
+        void pop_back() {
+            PVA_ASSERT(count_ != 0, "Vector is empty!");
+            invalidate();
+            --count_;
+            destroy(data_ + count_, data_ + count_ + 1);
+        }
+        
+        /********************************************************
+         * Удаление элемента в позиции pos за O(1)
+         ********************************************************
+         * На место удаленного элемента переносится последний,
+         * поэтому порядок элементов не сохраняется
+         ********************************************************
+         * \param pos Итератор на удаляемый элемент
+         * \return Итератор на элемент, занявший место удаленного
+         * (end(), если удален последний)
+         */
+        
+        iterator unordered_erase(const_iterator pos) {
+            PVA_ASSERT(owns(pos) && pos.base() != data_ + count_, "Iterator is out of range!");
+            T* place = data_ + (pos.base() - data_);
+            T* last = data_ + count_ - 1;
+            invalidate();
+            if (place != last) {
+                if constexpr (relocate_bitwise) {
+                    destroy(place, place + 1);
+                    std::memcpy(static_cast<void*>(place), last, sizeof(T));
+                    --count_;
+                    count_moves(1);
+                    return make_iterator(place);
+                }
+                else {
+                    *place = pva::move(*last);
+                    count_moves(1);
+                }
+            }
+            destroy(last, last + 1);
+            --count_;
+            return make_iterator(place);
+        }
+        
+        /********************************************************
+         * Удаление всех элементов, для которых pred истинен
+         ********************************************************
+         * Один проход: оставшиеся элементы сдвигаются к началу
+         * с сохранением порядка (побайтово переносимые -
+         * memmove сразу целыми отрезками). Емкость не меняется.
+         * Если pred бросит исключение, вектор остается
+         * корректным, но часть элементов может быть уже удалена
+         ********************************************************
+         * \param pred Условие удаления pred(const T&)
+         * \return Число удаленных элементов
+         */
+        
+        template<class Predicate>
+        std::size_t erase_if(Predicate pred) {
+            T* end = data_ + count_;
+            T* current = data_;
+            while (current != end && !pred(static_cast<const T&>(*current)))
+                ++current;
+            if (current == end)
+                return 0;
+            invalidate();
+            T* result = current;
+            if constexpr (relocate_bitwise) {
+                T* run = current;
+                try {
+                    while (current != end) {
+                        destroy(current, current + 1);
+                        run = ++current;
+                        while (current != end && !pred(static_cast<const T&>(*current)))
+                            ++current;
+                        result = shift_bitwise(run, current, result);
+                    }
+                }
+                catch (...) {
+                    result = shift_bitwise(run, end, result);
+                    count_ = result - data_;
+                    throw;
+                }
+                count_ = result - data_;
+            }
+            else {
+                for (++current; current != end; ++current) {
+                    if (!pred(static_cast<const T&>(*current))) {
+                        *result = pva::move(*current);
+                        ++result;
+                        count_moves(1);
+                    }
+                }
+                truncate(result - data_);
+            }
+            return end - result;
+        }
+        
+        /********************************************************
+         * Удаление элементов с индексами из [first, last)
+         ********************************************************
+         * Индексы должны быть упорядочены по возрастанию и
+         * меньше size() (повторы пропускаются). Один проход по
+         * вектору: отрезки между удаляемыми элементами
+         * сдвигаются к началу с сохранением порядка
+         * (побайтово переносимые - одним memmove на отрезок).
+         * Емкость не меняется
+         ********************************************************
+         * \param first Начало диапазона индексов
+         * \param last Конец диапазона индексов
+         * \return Число удаленных элементов
+         */
+        
+        template<class InputIt, class = typename std::enable_if<detail::is_iterator<InputIt>::value>::type>
+        std::size_t erase_indices(InputIt first, InputIt last) {
+            if (first == last)
+                return 0;
+            invalidate();
+            T* end = data_ + count_;
+            T* result = data_ + std::size_t(*first);
+            T* current = result;
+            for (; first != last; ++first) {
+                const std::size_t index = *first;
+                PVA_ASSERT(index < count_, "Index more than size of vector!");
+                T* erased = data_ + index;
+                if (erased < current) {
+                    PVA_ASSERT(erased + 1 == current, "Indices are not sorted!");
+                    continue;
+                }
+                if constexpr (relocate_bitwise) {
+                    result = shift_bitwise(current, erased, result);
+                    destroy(erased, erased + 1);
+                }
+                else {
+                    count_moves(erased - current);
+                    for (; current != erased; ++current, ++result)
+                        *result = pva::move(*current);
+                }
+                current = erased + 1;
+            }
+            if constexpr (relocate_bitwise) {
+                result = shift_bitwise(current, end, result);
+                count_ = result - data_;
+            }
+            else {
+                count_moves(end - current);
+                for (; current != end; ++current, ++result)
+                    *result = pva::move(*current);
+                truncate(result - data_);
+            }
+            return end - result;
+        }
+        
+        /********************************************************
+         * Удаление элементов с индексами из контейнера indices
+         ********************************************************
+         * \param indices Упорядоченные по возрастанию индексы
+         * \return Число удаленных элементов
+         */
+        
+        template<class Indices, class = decltype(std::begin(std::declval<const Indices&>()))>
+        std::size_t erase_indices(const Indices &indices) {
+            return erase_indices(std::begin(indices), std::end(indices));
+        }
+        
+        /********************************************************
+         * Изменение количества элементов в векторе
+         ********************************************************
+         * Новые элементы создаются конструктором по умолчанию.
+         * Если size больше емкости, она растет согласно GrowthPolicy
+         ********************************************************
+         * \param size Новое количество элементов
+         */
+        
+        void resize(const std::size_t &size) {
+            if (size > size_)
+                grow(size);
+            for (; count_ < size; ++count_)
+                construct(data_ + count_);
+            truncate(size);
+        }
+        
+        /********************************************************
+         * Изменение количества элементов в векторе
+         ********************************************************
+         * Новые элементы заполняются значением value. Если size
+         * больше емкости, она растет согласно GrowthPolicy
+         ********************************************************
+         * \param size Новое количество элементов
+         * \param value Значение новых элементов
+         */
+        
+        void resize(const std::size_t &size, const T &value) {
+            if (size > size_) {
+                T copy(value);
+                grow(size);
+                for (; count_ < size; ++count_)
+                    construct(data_ + count_, copy);
+                return;
+            }
+            for (; count_ < size; ++count_)
+                construct(data_ + count_, value);
+            truncate(size);
+        }
+        
+        /********************************************************
+         * Изменение количества элементов под перезапись
+         ********************************************************
+         * Как resize(size), но новые элементы тривиальных типов
+         * не инициализируются: вызывающий обязан записать их
+         * до чтения (распаковка, чтение из потока). Чтобы при
+         * росте емкости не переносить старые элементы, перед
+         * вызовом вектор можно очистить
+         ********************************************************
+         * \param size Новое количество элементов
+         */
+        
+        void resize_for_overwrite(const std::size_t &size) {
+            if (size > size_)
+                grow(size);
+            if constexpr (std::is_trivially_default_constructible<T>::value &&
+                          detail::default_construct<Allocator, T>::value) {
+                if (count_ < size)
+                    count_ = size;
+            }
+            else {
+                for (; count_ < size; ++count_)
+                    construct(data_ + count_);
+            }
+            truncate(size);
+        }
+        
+        /********************************************************
+         * Доступ к элементу по индексу
+         ********************************************************
+         * \param index Индекс элемента
+         * \return Значение элемента вектора по индексу
+         */
+        
+        T& at(const std::size_t &index) {
+            if (index >= count_)
+                throw std::out_of_range("Index more than size of vector!");
+            return data_[index];
+        }
+        
+        /********************************************************
+         * Доступ к элементу по индексу
+         ********************************************************
+         * \param index Индекс элемента
+         * \return Значение элемента вектора по индексу
+         */
+        
+        const T& at(const std::size_t &index) const {
+            if (index >= count_)
+                throw std::out_of_range("Index more than size of vector!");
+            return data_[index];
+        }
+        
+        /********************************************************
+         * Доступ к первому элементу вектора
+         ********************************************************
+         * \return Ссылку на первый элемент вектора
+         */
+        
+        T& front() {
+            PVA_ASSERT(count_ != 0, "Vector is empty!");
+            return data_[0];
+        }
+        
+        /********************************************************
+         * Доступ к первому элементу вектора
+         ********************************************************
+         * \return Ссылку на первый элемент вектора
+         */
+        
+        const T& front() const {
+            PVA_ASSERT(count_ != 0, "Vector is empty!");
+            return data_[0];
+        }
+        
+        /********************************************************
+         * Доступ к последнему элементу вектора
+         ********************************************************
+         * \return Ссылку на последний элемент вектора
+         */
+        
+        T& back() {
+            PVA_ASSERT(count_ != 0, "Vector is empty!");
+            return data_[count_ - 1];
+        }
+        
+        /********************************************************
+         * Доступ к последнему элементу вектора
+         ********************************************************
+         * \return Ссылку на последний элемент вектора
+         */
+        
+        const T& back() const {
+            PVA_ASSERT(count_ != 0, "Vector is empty!");
+            return data_[count_ - 1];
+        }
+        
+        /******************************************************************
+         * Меняет все свойства вектора 'other' на нынешние свойтсва вектора
+         ******************************************************************
+         * Обмениваются только указатели и размеры, элементы не трогаются.
+         * Элементы, лежащие внутри аллокатора, обмениваются перемещением
+         */
+        
+        void swap(vector &other)
+        noexcept(!detail::has_local_storage<Allocator>::value) {
+            if (local() || other.local()) {
+                vector temp(pva::move(other));
+                other = pva::move(*this);
+                *this = pva::move(temp);
+                return;
+            }
+            if constexpr (alloc_traits::propagate_on_container_swap::value)
+                detail::swap_allocators(this->alloc(), other.alloc());
+            std::size_t size = size_;
+            size_ = other.size_;
+            other.size_ = size;
+            std::size_t count = count_;
+            count_ = other.count_;
+            other.count_ = count;
+            T* data = data_;
+            data_ = other.data_;
+            other.data_ = data;
+        }
+        
+        /********************************************************
+         * Очистка вектора
+         ********************************************************
+         * Элементы разрушаются, емкость не меняется, чтобы
+         * буфер можно было заполнить снова без выделения
+         * памяти (освобождает ее shrink_to_fit)
+         */
+        
+        void clear() noexcept {
+            truncate(0);
+        }
+        
+        /********************************************************
+         * Освобождение вектора от лишних ячеек, под которые выделена память, 
+         * но они не заполнены значениями
+         */
+        
+        void shrink_to_fit() {
+            if (local())
+                return;
+            if (count_ == 0)
+                release();
+            else if (count_ < size_)
+                reallocate(count_);
+        }
+        
+        /********************************************************
+         * Вызов итератора, указывающего на первый элемент
+         ********************************************************
+         * \return Итератор на первый элемент вектора
+         */
+        
+        iterator begin() {
+            return make_iterator(data_);
+        }
+        
+        /********************************************************
+         * Вызов константного итератора, указывающего на первый элемент
+         ********************************************************
+         * \return Итератор на первый элемент вектора
+         */
+        
+        const_iterator begin() const {
+            return make_iterator(const_cast<const T*>(data_));
+        }
+        
+        /********************************************************
+         * Вызов константного итератора, указывающего на первый элемент
+         ********************************************************
+         * \return Итератор на первый элемент вектора
+         */
+        
+        const_iterator cbegin() const {
+            return begin();
+        }
+        
+        /**************************************************************************
+         * Вызов итератора, указывающего на позицию последнего элемента вектора + 1
+         **************************************************************************
+         * \return Итератор на позицию последнего элемента вектора + 1
+         */
+        
+        iterator end() {
+            return make_iterator(data_ + count_);
+        }
+        
+        /**************************************************************************
+         * Вызов константного итератора, указывающего на позицию последнего элемента вектора + 1
+         **************************************************************************
+         * \return Итератор на позицию последнего элемента вектора + 1
+         */
+        
+        const_iterator end() const {
+            return make_iterator(const_cast<const T*>(data_ + count_));
+        }
+        
+        /**************************************************************************
+         * Вызов константного итератора, указывающего на позицию последнего элемента вектора + 1
+         **************************************************************************
+         * \return Итератор на позицию последнего элемента вектора + 1
+         */
+        
+        const_iterator cend() const {
+            return end();
+        }
+        
+        /********************************************************
+         * Вызов обратного итератора, указывающего на последний элемент
+         ********************************************************
+         * \return Обратный итератор на последний элемент вектора
+         */
+        
+        reverse_iterator rbegin() {
+            return reverse_iterator(end());
+        }
+        
+        /********************************************************
+         * Вызов константного обратного итератора, указывающего на последний элемент
+         ********************************************************
+         * \return Обратный итератор на последний элемент вектора
+         */
+        
+        const_reverse_iterator rbegin() const {
+            return const_reverse_iterator(end());
+        }
+        
+        /********************************************************
+         * Вызов константного обратного итератора, указывающего на последний элемент
+         ********************************************************
+         * \return Обратный итератор на последний элемент вектора
+         */
+        
+        const_reverse_iterator crbegin() const {
+            return rbegin();
+        }
+        
+        /********************************************************
+         * Вызов обратного итератора, указывающего на позицию перед первым элементом
+         ********************************************************
+         * \return Обратный итератор на позицию перед первым элементом
+         */
+        
+        reverse_iterator rend() {
+            return reverse_iterator(begin());
+        }
+        
+        /********************************************************
+         * Вызов константного обратного итератора, указывающего на позицию перед первым элементом
+         ********************************************************
+         * \return Обратный итератор на позицию перед первым элементом
+         */
+        
+        const_reverse_iterator rend() const {
+            return const_reverse_iterator(begin());
+        }
+        
+        /********************************************************
+         * Вызов константного обратного итератора, указывающего на позицию перед первым элементом
+         ********************************************************
+         * \return Обратный итератор на позицию перед первым элементом
+         */
+        
+        const_reverse_iterator crend() const {
+            return rend();
+        }
+        
+        /********************************************************
+         * Получение указателя на буфер элементов
+         ********************************************************
+         * \return Указатель на первый элемент (nullptr, если
+         * память не выделена)
+         */
+        
+        T* data() noexcept {
+            return data_;
+        }
+        
+        /********************************************************
+         * Получение указателя на буфер элементов
+         ********************************************************
+         * \return Указатель на первый элемент (nullptr, если
+         * память не выделена)
+         */
+        
+        const T* data() const noexcept {
+            return data_;
+        }
+        
+        /********************************************************
+         * Перегруженный оператор присваивания
+         ********************************************************
+         * Если емкости хватает, память не перевыделяется
+         ********************************************************
+         * \param Ссылка на копируемый вектор
+         * \return Ссылку на вектор
+         */
+        
+        vector& operator =(const vector &copy) {
+            if (&copy == this)
+                return *this;
+            if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+                if (this->alloc() != copy.alloc())
+                    release();
+                this->alloc() = copy.alloc();
+            }
+            assign(copy.data_, copy.data_ + copy.count_);
+            return *this;
+        }
+        
+        /********************************************************
+         * Перегруженный оператор присваивания через rvalue - ссылки (начиная с С++11)
+         ********************************************************
+         * Освобождает свой буфер и забирает буфер у copy. Если
+         * аллокаторы не равны и не передаются при перемещении
+         * или элементы лежат внутри аллокатора copy, элементы
+         * перемещаются по одному
+         ********************************************************
+         * \param rvalue - ссылка на перемещаемый вектор
+         * \return Ссылку на вектор
+         */
+        
+        vector& operator =(vector &&copy)
+        noexcept((alloc_traits::propagate_on_container_move_assignment::value ||
+                  alloc_traits::is_always_equal::value) &&
+                 !detail::has_local_storage<Allocator>::value) {
+            if (&copy == this)
+                return *this;
+            if constexpr (!alloc_traits::propagate_on_container_move_assignment::value ||
+                          detail::has_local_storage<Allocator>::value) {
+                if (copy.local() || (!alloc_traits::propagate_on_container_move_assignment::value &&
+                                     this->alloc() != copy.alloc())) {
+                    move_elements(copy);
+                    return *this;
+                }
+            }
+            release();
+            if constexpr (alloc_traits::propagate_on_container_move_assignment::value)
+                this->alloc() = pva::move(copy.alloc());
+            size_ = copy.size_;
+            count_ = copy.count_;
+            data_ = copy.data_;
+            copy.size_ = 0;
+            copy.count_ = 0;
+            copy.data_ = nullptr;
+            return *this;
+        }
+        
+        /********************************************************
+         * Получение копии аллокатора вектора
+         ********************************************************
+         * \return Аллокатор вектора
+         */
+        
+        allocator_type get_allocator() const {
+            return this->alloc();
+        }
+        
+        /********************************************************
+         * Перегруженный оператор [] (обращение к элементу вектора)
+         ********************************************************
+         * Индекс проверяется только при PVA_CHECKED, для
+         * проверки в любой сборке есть at()
+         ********************************************************
+         * \param size Индекс элемента
+         * \return Ссылку на элемент вектора по индексу
+         */
+        
+        T& operator [](const std::size_t &size) {
+            PVA_ASSERT(size < count_, "Index more than size of vector!");
+            return data_[size];
+        }
+        
+        /********************************************************
+         * Перегруженный оператор [] (обращение к элементу вектора)
+         ********************************************************
+         * Индекс проверяется только при PVA_CHECKED, для
+         * проверки в любой сборке есть at()
+         ********************************************************
+         * \param size Индекс элемента
+         * \return Ссылку на элемент вектора по индексу
+         */
+        
+        const T& operator [](const std::size_t &size) const {
+            PVA_ASSERT(size < count_, "Index more than size of vector!");
+            return data_[size];
+        }
+        
+        /********************************************************
+         * Статистика этого вектора
+         ********************************************************
+         * \return Счетчики за время жизни вектора (нули, если
+         * PVA_STATS = 0)
+         */
+        
+        vector_stats stats() const noexcept {
+#if PVA_STATS
+            return stats_;
+#else
+            return vector_stats();
+#endif
+        }
+        
+        /********************************************************
+         * Сумма статистики всех векторов этого типа
          ********************************************************
-         * \return Итератор
+         * \return Счетчики всех векторов этого типа (нули, если
+         * PVA_STATS = 0)
          */
         
-        iterator& operator --() {
-            --ptr_;
-            return *this;
+        static vector_stats type_stats() noexcept {
+#if PVA_STATS
+            return detail::stats_of<vector>().load();
+#else
+            return vector_stats();
+#endif
         }
+
         
+    private:
         /********************************************************
-         * Перегруженный оператор -- (декремент постфиксный)
+         * Создание итератора на элемент этого вектора
          ********************************************************
-         * \return Итератор
+         * При PVA_CHECKED итератор запоминает счетчик изменений
+         * вектора, чтобы обнаружить обращение после изменения
          */
         
-        iterator operator --(int) {
-            ptr_--;
-            return *this;
+        template<class U>
+        pva::iterator<U> make_iterator(U* ptr) const {
+#if PVA_CHECKED
+            return pva::iterator<U>(ptr, &version_);
+#else
+            return pva::iterator<U>(ptr);
+#endif
         }
         
         /********************************************************
-         * Перегруженный оператор += (сложение, совмещенное с присваиванием)
-         ********************************************************
-         * \param size Число, на которое нужно переместиться по контейнеру, используя итератор
-         * \return Итератор
+         * Проверка, что итератор действителен и указывает в [begin, end]
          */
         
-        iterator& operator +=(const std::size_t &size) {
-            ptr_ += size;
-            return *this;
+        bool owns(const const_iterator &pos) const {
+            return pos.valid() && pos.base() >= data_ && pos.base() <= data_ + count_;
         }
         
         /********************************************************
-         * Перегруженный оператор + (сложение)
-         ********************************************************
-         * \param size Число, на которое нужно переместиться по контейнеру, используя итератор
-         * \return Итератор
+         * Отметка об изменении вектора: при PVA_CHECKED все
+         * созданные ранее итераторы становятся недействительными
          */
         
-        iterator operator +(const std::size_t &size) const {
-            ptr_ += size;
-            return *this;
+        void invalidate() noexcept {
+#if PVA_CHECKED
+            ++version_;
+#endif
         }
         
         /********************************************************
-         * Перегруженный оператор -= (вычитание, совмещенное с присваиванием)
+         * Учет выделения буфера емкостью capacity
          ********************************************************
-         * \param size Число, на которое нужно переместиться по контейнеру, используя итератор
-         * \return Итератор
+         * Функции учета ничего не делают при PVA_STATS = 0
          */
         
-        iterator& operator -=(const std::size_t &size){
-            ptr_ -= size;
-            return *this;
+        void count_allocation(const std::size_t &capacity) noexcept {
+#if PVA_STATS
+            ++stats_.allocations;
+            stats_.bytes_allocated += capacity * sizeof(T);
+            if (stats_.peak_capacity < capacity)
+                stats_.peak_capacity = capacity;
+            detail::stats_of<vector>().allocate(capacity * sizeof(T), capacity);
+#else
+            (void)capacity;
+#endif
         }
         
         /********************************************************
-         * Перегруженный оператор - (вычитание)
-         ********************************************************
-         * \param size Число, на которое нужно переместиться по контейнеру, используя итератор
-         * \return Итератор
+         * Учет освобождения буфера
          */
         
-        iterator operator -(const std::size_t &size) const{
-            return iterator(ptr_ - size);
+        void count_deallocation() noexcept {
+#if PVA_STATS
+            ++stats_.deallocations;
+            detail::stats_of<vector>().deallocate();
+#endif
         }
         
-        /*****************************************************
-         * Получение доступа к указателю вне класса
+        /********************************************************
+         * Учет count скопированных элементов
          */
         
-        T* pointer() const {
-            return ptr_;
+        void count_copies(const std::size_t &count) noexcept {
+#if PVA_STATS
+            stats_.copies += count;
+            detail::stats_of<vector>().copy(count);
+#else
+            (void)count;
+#endif
         }
         
-    protected:
-        T* ptr_; /*< Указатель на элемент*/
-    };
-    
-    /********************************************************
-     * \brief Класс - вектор
-     ********************************************************
-     * Данный класс - реализация класса 'vector' из STL
-     */
-    
-    template<class T>
-    class vector {
-    public:
-        /**********************************************
-         * Конструктор по умолчанию
+        /********************************************************
+         * Учет count перемещенных элементов
          */
         
-        vector()
-        :size_(0), count_(0) {}
+        void count_moves(const std::size_t &count) noexcept {
+#if PVA_STATS
+            stats_.moves += count;
+            detail::stats_of<vector>().move(count);
+#else
+            (void)count;
+#endif
+        }
         
         /********************************************************
-         * Конструктор, который задает вектору определнный размер
-         ********************************************************
-         * \param size Размер вектора
+         * Учет переноса элементов в новый буфер
          */
         
-        explicit vector(const std::size_t &size)
-        :size_(size), count_(0), data_(new T[size_ + 1]) {
-            memset(data_, 0, size_ * data_[0]);
+        void count_reallocation() noexcept {
+#if PVA_STATS
+            ++stats_.reallocations;
+            detail::stats_of<vector>().reallocate();
+#endif
         }
         
         /********************************************************
-         * Конструктор, который задает вектор размерм size и
-         * копирует элементы из массива data в вектор
+         * Выделение неинициализированной памяти через аллокатор
          ********************************************************
-         * \param size Размер вектора
-         * \param data Массив, который скопируется в вектор
+         * Если аллокатор умеет allocate_at_least, capacity
+         * увеличивается до реально выделенного числа элементов
+         ********************************************************
+         * \param capacity Число элементов, под которые нужна память
+         * \return Указатель на память (nullptr при capacity == 0)
          */
         
-        vector(const std::size_t &size, const T* data)
-        :size_(size), count_(0) {
-            data_ = new T[size_ + 1];
-            for (std::size_t i = 0; i < size_; ++i, ++count_)
-                data_[i] = data[i];
+        T* allocate(std::size_t &capacity) {
+            if (capacity == 0)
+                return nullptr;
+            if (capacity > alloc_traits::max_size(this->alloc()))
+                throw std::length_error("Vector is too long!");
+            T* data;
+            if constexpr (detail::has_allocate_at_least<Allocator>::value) {
+                allocation_result<T*> result = this->alloc().allocate_at_least(capacity);
+                capacity = result.count;
+                data = result.ptr;
+            }
+            else
+                data = alloc_traits::allocate(this->alloc(), capacity);
+            count_allocation(capacity);
+            return data;
         }
         
-        /**************************************************************
-         * Конструктор копирования
-         **************************************************************
-         * \param copy Внешний объект, который надо скопировать в новый
+        /********************************************************
+         * Проверка, лежат ли элементы внутри самого аллокатора
+         ********************************************************
+         * Такой буфер нельзя передать другому вектору
          */
         
-        vector(const vector &copy)
-        :size_(copy.size_), count_(copy.count_), data_(new T[size_ + 1]) {
-            for (std::size_t i = 0; i < size_; ++i)
-                data_[i] = copy.data_[i];
+        bool local() const noexcept {
+            if constexpr (detail::has_local_storage<Allocator>::value)
+                return this->alloc().is_local(data_);
+            else
+                return false;
         }
         
-        /**************************************************************
-         * Конструктор перемещения (начиная с С++11)
-         **************************************************************
-         * \param copy Внешний объект, который надо переместить в новый
+        /********************************************************
+         * Освобождение памяти без вызова деструкторов
+         ********************************************************
+         * \param data Указатель на память
+         * \param capacity Число элементов, под которые она выделялась
          */
         
-        vector(vector &&copy)
-        :size_(move(copy.size_)), count_(move(copy.count_)),
-        data_(new T[size_ + 1]) {
-            for (std::size_t i = 0; i < size_; ++i)
-                data_[i] = copy.data_[i];
+        void deallocate(T* data, const std::size_t &capacity) noexcept {
+            if (data) {
+                alloc_traits::deallocate(this->alloc(), data, capacity);
+                count_deallocation();
+            }
         }
         
         /********************************************************
-         * Деструктор
-         ********************************************************
-         * Освобождает память от массива data_
+         * Создание элемента в неинициализированной памяти
          */
         
-        ~vector() {
-            if (data_)
-                delete [] data_;
+        template<class... Args>
+        void construct(T* place, Args&&... args) {
+            alloc_traits::construct(this->alloc(), place, pva::forward<Args>(args)...);
         }
         
         /********************************************************
-         * Резервирование памяти под вектор
-         ********************************************************
-         * \param size Размер, который нужно выделить под вектор
-         * \return True - память выделилась, false - обратное
+         * Вызов деструкторов элементов [first, last)
          */
         
-        bool reserve(const std::size_t &size) {
-            if (size_ == 0) {
-                size_ = size;
-                data_ = new T[size_ + 1];
-                memset(data_, 0, size_ * data_[0]);
-                return true;
-            }
-            return false;
+        void destroy(T* first, T* last) noexcept {
+            for (; first != last; ++first)
+                alloc_traits::destroy(this->alloc(), first);
         }
         
         /********************************************************
-         * Получаем размер вектора
+         * Разрушение исходников после relocate
          ********************************************************
-         * \return Размер вектора, под который выделена памятиь
-         * (не количесвто объектов в векторе)
+         * Побайтово перенесенные объекты теперь живут в новом
+         * месте, поэтому их деструкторы не вызываются
          */
         
-        std::size_t capacity() const {
-            return size_;
+        void destroy_moved_from(T* first, T* last) noexcept {
+            if constexpr (!relocate_bitwise)
+                destroy(first, last);
         }
         
         /********************************************************
-         * Получаем количество элементов в векторе
-         ********************************************************
-         * \return Количество элементов в векторе
+         * Разрушение всех элементов и освобождение буфера
          */
         
-        std::size_t size() const {
-            return count_;
+        void release() noexcept {
+            invalidate();
+            destroy(data_, data_ + count_);
+            deallocate(data_, size_);
+            data_ = nullptr;
+            size_ = 0;
+            count_ = 0;
         }
         
         /********************************************************
-         * Проверка на наличие элементов в векторе
+         * Копирование элементов [first, last) в неинициализированную память dest
          ********************************************************
-         * \return True - элементов нет, false - обратное
+         * При исключении созданные в dest элементы разрушаются
          */
         
-        bool empty() const {
-            if (count_ == 0)
-                return true;
-            return false;
+        template<class It>
+        void uninitialized_copy(It first, It last, T* dest) {
+            if constexpr (copy_bitwise && detail::is_pointer_to<It, T>::value) {
+                if (first != last)
+                    std::memcpy(static_cast<void*>(dest), first, (last - first) * sizeof(T));
+                count_copies(last - first);
+                return;
+            }
+            T* current = dest;
+            try {
+                for (; first != last; ++first, ++current)
+                    construct(current, *first);
+            }
+            catch (...) {
+                destroy(dest, current);
+                throw;
+            }
+            count_copies(current - dest);
         }
         
-        /****************************************************************
-         * Заполняем вектор копиями значения
-         ****************************************************************
-         * \param size Число копий
-         * \param value Значение, которое надо записать size раз в вектор
+        /********************************************************
+         * Перемещение элементов [first, last) в неинициализированную память dest
+         ********************************************************
+         * При исключении созданные в dest элементы разрушаются
          */
         
-        void assign(std::size_t &size, const T &value) {
-            if (size_ != 0)
-                delete [] data_;
-            size_ = size;
-            count_ = size_;
-            data_ = new T[size_ + 1];
-            for (std::size_t i = 0; i < size_; ++i)
-                data_[i] = value;
+        void uninitialized_move(T* first, T* last, T* dest) {
+            T* current = dest;
+            try {
+                for (; first != last; ++first, ++current)
+                    construct(current, pva::move(*first));
+            }
+            catch (...) {
+                destroy(dest, current);
+                throw;
+            }
+            count_moves(current - dest);
         }
         
         /********************************************************
-         * Добавление элемента в конец вектора значений
+         * Перенос элементов [first, last) в неинициализированную память dest
          ********************************************************
-         * \param value Значение вставляемого элемента
+         * Элементы перемещаются, если перемещение не бросает исключений
+         * (или копирование невозможно), иначе копируются. При исключении
+         * созданные в dest элементы разрушаются. Побайтово переносимые
+         * элементы копируются memcpy, и исходники после этого нельзя
+         * разрушать (см. destroy_moved_from)
          */
         
-        void push_back(const T &value) {
-            if (size_ == 0) {
-                ++size_;
-                data_ = new T[size_ + 1];
-                data_[0] = value;
-            }
-            else if (size_ > count_) {
-                data_[count_] = value;
-            }
-            else if (count_ == size_) {
-                T* temp(data_);
-                delete [] data_;
-                ++size_;
-                data_ = new T[size_ + 1];
-                for (std::size_t i = 0; i < size_ - 1; ++i)
-                    data_[i] = temp[i];
-                data_[size_ - 1] = value;
+        void relocate(T* first, T* last, T* dest) {
+            if constexpr (relocate_bitwise) {
+                if (first != last)
+                    std::memcpy(static_cast<void*>(dest), first, (last - first) * sizeof(T));
+                count_moves(last - first);
+                return;
             }
-            ++count_;
+            T* current = dest;
+            try {
+                for (; first != last; ++first, ++current)
+                    construct(current, move_if_noexcept(*first));
+            }
+            catch (...) {
+                destroy(dest, current);
+                throw;
+            }
+            if constexpr (std::is_rvalue_reference<decltype(move_if_noexcept(*first))>::value)
+                count_moves(current - dest);
+            else
+                count_copies(current - dest);
         }
         
         /********************************************************
-         * Добавление элемента в конец вектора значений через rvalue - ссылки (начиная с С++11)
+         * Побайтовый сдвиг отрезка [first, last) в dest (dest <= first)
          ********************************************************
-         * \param value Значение вставляемого элемента
+         * \return Конец сдвинутого отрезка
          */
         
-        void push_back(T &&value) {
-            if (size_ == 0) {
-                ++size_;
-                data_ = new T[size_ + 1];
-                data_[0] = move(value);
-            }
-            else if (size_ > count_) {
-                data_[count_] = move(value);
-            }
-            else if (count_ == size_) {
-                vector temp(size_, data_);
-                delete [] data_;
-                ++size_;
-                data_ = new T[size_ + 1];
-                for (std::size_t i = 0; i < size_ - 1; ++i)
-                    data_[i] = move(temp.data_[i]);
-                data_[size_ - 1] = move(value);
-            }
-            ++count_;
+        T* shift_bitwise(T* first, T* last, T* dest) noexcept {
+            if (first != dest && first != last)
+                std::memmove(static_cast<void*>(dest), first, (last - first) * sizeof(T));
+            count_moves(last - first);
+            return dest + (last - first);
         }
         
         /********************************************************
-         * Доступ к элементу по индексу
+         * Копирование count элементов [first, last) в пустой вектор
          ********************************************************
-         * \param index Индекс элемента
-         * \return Значение элемента вектора по индексу
+         * Используется только в конструкторах: при исключении
+         * память освобождается
          */
         
-        T& at(const std::size_t &index) {
-            if (index > size_)
-                throw std::out_of_range("Index more than size of vector!");
-            return data_[index];
+        template<class It>
+        void copy_construct(It first, It last, const std::size_t &count) {
+            try {
+                uninitialized_copy(first, last, data_);
+            }
+            catch (...) {
+                deallocate(data_, size_);
+                throw;
+            }
+            count_ = count;
         }
         
         /********************************************************
-         * Доступ к элементу по индексу
+         * Размещение страниц нового буфера по узлам NUMA
          ********************************************************
-         * \param index Индекс элемента
-         * \return Значение элемента вектора по индексу
+         * mbind действует на целые страницы, поэтому
+         * размещается только буфер, который, по словам
+         * аллокатора (owns_pages), занимает свои страницы. Буфер
+         * из кучи malloc делит страницы с чужими данными, буфер
+         * внутри аллокатора (inline_allocator) лежит в чужой
+         * памяти - такие не размещаются
          */
         
-        const T& at(const std::size_t &index) const {
-            if (index > size_)
-                throw std::out_of_range("Index more than size of vector!");
-            return data_[index];
+        template<class Policy>
+        void place(const Policy &policy) noexcept {
+            if constexpr (detail::has_owns_pages<Allocator>::value) {
+                if (data_ && !local() && Allocator::owns_pages(size_))
+                    policy.place(data_, size_ * sizeof(T));
+            }
+            else
+                (void)policy;
         }
         
         /********************************************************
-         * Доступ к первому элементу вектора
+         * Создание count копий value в пустом буфере
          ********************************************************
-         * \return Ссылку на первый элемент вектора
+         * Куски создаются на потоках пула политики. Если
+         * элементы создаются через аллокатор или копирование
+         * может бросить исключение, элементы создаются по
+         * одному в вызывающем потоке
          */
         
-        T& front() {
-            return data_;
+        template<class Policy>
+        void fill_parallel(const std::size_t &count, const T &value, const Policy &policy) {
+            if constexpr (construct_parallel) {
+                T* data = data_;
+                construct_slices(count, policy, [data, &value](std::size_t begin, std::size_t end) {
+                    std::uninitialized_fill(data + begin, data + end, value);
+                });
+            }
+            else {
+                for (; count_ < count; ++count_)
+                    construct(data_ + count_, value);
+            }
         }
         
         /********************************************************
-         * Доступ к последнему элементу вектора
+         * Копирование count элементов source в пустой буфер
          ********************************************************
-         * \return Ссылку на последний элемент вектора
+         * Как fill_parallel. При исключении созданные элементы
+         * разрушаются (см. construct_slices)
          */
         
-        T& back() {
-            return data_ + size_;
+        template<class Policy>
+        void copy_parallel(const T* source, const std::size_t &count, const Policy &policy) {
+            if constexpr (construct_parallel) {
+                T* data = data_;
+                construct_slices(count, policy, [data, source](std::size_t begin, std::size_t end) {
+                    if constexpr (copy_bitwise)
+                        std::memcpy(static_cast<void*>(data + begin), source + begin, (end - begin) * sizeof(T));
+                    else
+                        std::uninitialized_copy(source + begin, source + end, data + begin);
+                });
+                count_copies(count);
+            }
+            else {
+                uninitialized_copy(source, source + count, data_);
+                count_ = count;
+            }
         }
         
-        /******************************************************************
-         * Меняет все свойства вектора 'other' на нынешние свойтсва вектора
+        /********************************************************
+         * Создание count элементов пустого буфера кусками
+         ********************************************************
+         * Кусок (не больше policy.slices() штук) записывает
+         * свои границы в журнал. Если policy.run бросит
+         * исключение, когда часть кусков уже создана, их
+         * элементы разрушаются, и буфер остается пустым
+         ********************************************************
+         * \param count Число элементов
+         * \param policy Политика
+         * \param construct_slice Создание элементов [begin, end)
          */
         
-        void swap(vector &other) {
-            vector temp(move(other));
-            if (other.data_)
-                delete [] other.data_;
-            other.size_ = size_ + 1;
-            other.count_ = count_;
-            if (size_ != 0) {
-                other.data_ = new T[other.size_];
-                for (std::size_t i = 0; i < other.size_; ++i)
-                    other.data_[i] = data_[i];
+        template<class Policy, class Function>
+        void construct_slices(const std::size_t &count, const Policy &policy, Function construct_slice) {
+            const std::size_t limit = policy.slices();
+            std::unique_ptr<std::pair<std::size_t, std::size_t>[]> done(
+                new std::pair<std::size_t, std::size_t>[limit]);
+            std::atomic<std::size_t> logged{0};
+            T* data = data_;
+            try {
+                policy.run(count, data, [&](std::size_t begin, std::size_t end) {
+                    construct_slice(begin, end);
+                    const std::size_t index = logged.fetch_add(1, std::memory_order_relaxed);
+                    PVA_ASSERT(index < limit, "Policy ran more slices than it reported!");
+                    if (index < limit)
+                        done[index] = std::make_pair(begin, end);
+                });
             }
-            size_ = temp.size_;
-            count_ = temp.count_;
-            if (size_ != 0) {
-                data_ = new T[size_ + 1];
-                for (std::size_t i = 0; i < size_; ++i)
-                    data_[i] = temp.data_[i];
+            catch (...) {
+                const std::size_t slices = logged.load(std::memory_order_acquire);
+                for (std::size_t k = 0; k < slices && k < limit; ++k)
+                    destroy(data + done[k].first, data + done[k].second);
+                throw;
             }
+            count_ = count;
         }
         
         /********************************************************
-         * Очистка вектора
+         * Поэлементное перемещение содержимого copy в этот вектор
+         ********************************************************
+         * Используется, когда буфер copy нельзя забрать: аллокаторы
+         * не равны или элементы лежат внутри аллокатора copy.
+         * После перемещения copy становится пустым
          */
         
-        void clear() {
-            if (size_ != 0) {
-                if (data_)
-                    delete [] data_;
-                size_ = 0;
-                count_ = 0;
+        void move_elements(vector &copy) {
+            if (copy.count_ > size_) {
+                std::size_t capacity = copy.count_;
+                T* data = allocate(capacity);
+                try {
+                    relocate(copy.data_, copy.data_ + copy.count_, data);
+                }
+                catch (...) {
+                    deallocate(data, capacity);
+                    throw;
+                }
+                release();
+                count_reallocation();
+                data_ = data;
+                size_ = capacity;
+                count_ = copy.count_;
+                copy.destroy_moved_from(copy.data_, copy.data_ + copy.count_);
+                copy.count_ = 0;
+                return;
             }
+            const std::size_t common = count_ < copy.count_ ? count_ : copy.count_;
+            for (std::size_t i = 0; i < common; ++i)
+                data_[i] = pva::move(copy.data_[i]);
+            for (; count_ < copy.count_; ++count_)
+                construct(data_ + count_, pva::move(copy.data_[count_]));
+            count_moves(copy.count_);
+            truncate(copy.count_);
+            copy.truncate(0);
         }
         
         /********************************************************
-         * Освобождение вектора от лишних ячеек, под которые выделена память, 
-         * но они не заполнены значениями
+         * Разрушение элементов с индексами [size, count_)
          */
         
-        void shrink_to_fit() {
-            if (count_ < size_) {
-                vector temp(size_, data_);
-                delete [] data_;
-                size_ = count_;
-                data_ = new T[size_ + 1];
-                for (std::size_t i = 0; i < size_; ++i)
-                    data_[i] = temp.data_[i];
+        void truncate(const std::size_t &size) noexcept {
+            if (size < count_) {
+                invalidate();
+                destroy(data_ + size, data_ + count_);
+                count_ = size;
             }
         }
         
         /********************************************************
-         * Вызов итератора, указывающего на первый элемент
+         * Перенос элементов в новый буфер заданной емкости
          ********************************************************
-         * \return Итератор на первый элемент вектора
+         * Побайтово переносимые элементы по возможности остаются
+         * на месте: буфер расширяется reallocate аллокатора
+         ********************************************************
+         * \param size Новая емкость (не меньше count_)
          */
         
-        iterator<T> begin() {
-            return iterator<T>(data_);
+        void reallocate(const std::size_t &size) {
+            invalidate();
+            std::size_t capacity = size;
+            if constexpr (relocate_bitwise && detail::has_reallocate<Allocator>::value) {
+                if (data_ && capacity != 0 && !local()) {
+                    data_ = this->alloc().reallocate(data_, size_, capacity);
+                    size_ = capacity;
+                    count_deallocation();
+                    count_allocation(capacity);
+                    count_reallocation();
+                    return;
+                }
+            }
+            T* data = allocate(capacity);
+            try {
+                relocate(data_, data_ + count_, data);
+            }
+            catch (...) {
+                deallocate(data, capacity);
+                throw;
+            }
+            destroy_moved_from(data_, data_ + count_);
+            deallocate(data_, size_);
+            count_reallocation();
+            data_ = data;
+            size_ = capacity;
         }
         
-        /**************************************************************************
-         * Вызов итератора, указывающего на позицию последнего элемента вектора + 1
-         **************************************************************************
-         * \return Итератор на позицию последнего элемента вектора + 1
+        /********************************************************
+         * Создание элемента в позиции index с перевыделением памяти
+         ********************************************************
+         * Новый элемент создается до переноса старых, поэтому args
+         * могут ссылаться на элементы этого же вектора
+         ********************************************************
+         * \param index Позиция нового элемента
+         * \param args Аргументы конструктора элемента
+         * \return Ссылку на созданный элемент
          */
         
-        iterator<T> end() {
-            return iterator<T>(data_ + size_ + 1);
+        template<class... Args>
+        T& emplace_reallocate(const std::size_t &index, Args&&... args) {
+            if constexpr (relocate_bitwise && detail::has_reallocate<Allocator>::value) {
+                if (data_ && !local()) {
+                    T value(pva::forward<Args>(args)...);
+                    grow(count_ + 1);
+                    if (index != count_)
+                        std::memmove(static_cast<void*>(data_ + index + 1), data_ + index,
+                                     (count_ - index) * sizeof(T));
+                    count_moves(count_ - index);
+                    construct(data_ + index, pva::move(value));
+                    ++count_;
+                    return data_[index];
+                }
+            }
+            invalidate();
+            std::size_t capacity = GrowthPolicy()(size_, count_ + 1);
+            T* data = allocate(capacity);
+            bool created = false;
+            try {
+                construct(data + index, pva::forward<Args>(args)...);
+                created = true;
+                relocate(data_, data_ + index, data);
+                try {
+                    relocate(data_ + index, data_ + count_, data + index + 1);
+                }
+                catch (...) {
+                    destroy(data, data + index);
+                    throw;
+                }
+            }
+            catch (...) {
+                if (created)
+                    destroy(data + index, data + index + 1);
+                deallocate(data, capacity);
+                throw;
+            }
+            destroy_moved_from(data_, data_ + count_);
+            deallocate(data_, size_);
+            count_reallocation();
+            data_ = data;
+            size_ = capacity;
+            ++count_;
+            return data_[index];
         }
         
         /********************************************************
-         * Перегруженный оператор присваивания
+         * Вставка count элементов [first, last) в позицию index
+         * с перевыделением памяти
          ********************************************************
-         * \param Ссылка на копируемый вектор
-         * \return Ссылку на элемент вектора
+         * Новые элементы копируются сразу на свое место, старые
+         * переносятся вокруг них, так что каждый элемент
+         * перемещается ровно один раз
          */
         
-        T& operator =(const vector &copy) {
-            if (&copy == this)
-                return *this;
-            delete [] data_;
-            size_ = copy.size_;
-            count_ = copy.count_;
-            data_ = new T[size_ + 1];
-            for (std::size_t i = 0; i < size_; ++i)
-                data_[i] = copy.data_[i];
-            return *this;
+        template<class It>
+        void insert_reallocate(const std::size_t &index, It first, It last, const std::size_t &count) {
+            invalidate();
+            std::size_t capacity = GrowthPolicy()(size_, count_ + count);
+            T* data = allocate(capacity);
+            try {
+                uninitialized_copy(first, last, data + index);
+            }
+            catch (...) {
+                deallocate(data, capacity);
+                throw;
+            }
+            try {
+                relocate(data_, data_ + index, data);
+                try {
+                    relocate(data_ + index, data_ + count_, data + index + count);
+                }
+                catch (...) {
+                    destroy(data, data + index);
+                    throw;
+                }
+            }
+            catch (...) {
+                destroy(data + index, data + index + count);
+                deallocate(data, capacity);
+                throw;
+            }
+            destroy_moved_from(data_, data_ + count_);
+            deallocate(data_, size_);
+            count_reallocation();
+            data_ = data;
+            size_ = capacity;
+            count_ += count;
         }
         
         /********************************************************
-         * Перегруженный оператор присваивания через rvalue - ссылки (начиная с С++11)
+         * Увеличение емкости согласно GrowthPolicy
          ********************************************************
-         * \param rvalue - ссылка на копируемый вектор
-         * \return Ссылку на элемент вектора
+         * \param required Минимально необходимая емкость
          */
         
-        T& operator =(vector &&copy) {
-            if (&copy == this)
-                return *this;
-            delete [] data_;
-            size_ = move(copy.size_);
-            count_ = move(copy.count_);
-            data_ = new T[size_ + 1];
-            for (std::size_t i = 0; i < size_; ++i)
-                data_[i] = copy.data_[i];
-            return *this;
+        void grow(const std::size_t &required) {
+            reallocate(GrowthPolicy()(size_, required));
         }
         
         /********************************************************
-         * Перегруженный оператор [] (обращение к элементу вектора)
+         * Увеличение емкости без переноса элементов по одному
          ********************************************************
-         * \param size Индекс элемента
-         * \return Ссылку на элемент вектора по индексу
+         * \param required Минимально необходимая емкость
+         * \return True - буфер расширен через reallocate аллокатора,
+         * false - так расширить нельзя, элементы нужно переносить
          */
         
-        T& operator [](const std::size_t &size);
+        bool grow_in_place(const std::size_t &required) {
+            if constexpr (relocate_bitwise && detail::has_reallocate<Allocator>::value) {
+                if (data_ && !local()) {
+                    grow(required);
+                    return true;
+                }
+            }
+            (void)required;
+            return false;
+        }
         
         /********************************************************
-         * Перегруженный оператор [] (обращение к элементу вектора)
-         ********************************************************
-         * \param size Индекс элемента
-         * \return Ссылку на элемент вектора по индексу
+         * Ссылка, из которой элемент будет перемещен, если
+         * перемещение не бросает исключений, иначе скопирован
          */
         
-        const T& operator [](const std::size_t &size) const;
-
+        static typename std::conditional<
+            !std::is_nothrow_move_constructible<T>::value && std::is_copy_constructible<T>::value,
+            const T&, T&&>::type
+        move_if_noexcept(T &value) noexcept {
+            return pva::move(value);
+        }
         
-    private:
+
+        static constexpr bool relocate_bitwise = is_trivially_relocatable<T>::value &&
+            detail::default_construct<Allocator, T>::value; /*< Элементы переносятся побайтово*/
+        static constexpr bool copy_bitwise = std::is_trivially_copyable<T>::value &&
+            detail::default_construct<Allocator, T>::value; /*< Элементы копируются побайтово*/
+        static constexpr bool construct_parallel = std::is_nothrow_copy_constructible<T>::value &&
+            detail::default_construct<Allocator, T>::value; /*< Элементы можно создавать из нескольких потоков*/
+        
+#if PVA_STATS
+        vector_stats stats_; /*< Счетчики операций (объявлены до data_: его инициализация выделяет память)*/
+#endif
         std::size_t size_; /*< Размер вектора (число возможных элементов вектора)*/
         std::size_t count_; /*< Число элементов в векторе*/
         T *data_; /*< Массив под элементы вектора*/
+#if PVA_CHECKED
+        std::size_t version_ = 0; /*< Счетчик изменений вектора для проверки итераторов*/
+#endif
     };
     
     /********************************************************
@@ -570,52 +2455,73 @@ namespace pva {
      * \param rhs 2-й вектор, в который запишется 1-й
      */
     
-    template<class T>
-    inline void swap(vector<T> &lhs, vector<T> &rhs) {
+    template<class T, class Allocator, class GrowthPolicy>
+    inline void swap(vector<T, Allocator, GrowthPolicy> &lhs, vector<T, Allocator, GrowthPolicy> &rhs)
+    noexcept(noexcept(lhs.swap(rhs))) {
         lhs.swap(rhs);
     }
     
-    /*******************************************************
-     * Перегруженный оператор [] (обращение к элементу вектора)
+    /********************************************************
+     * Удаление всех элементов вектора, для которых pred истинен
+     ********************************************************
+     * Аналог std::erase_if из C++20 (см. vector::erase_if)
      ********************************************************
-     * Описание выше
+     * \param values Вектор
+     * \param pred Условие удаления
+     * \return Число удаленных элементов
      */
     
-    template<class T>
-    T& vector<T>::operator [](const std::size_t &index) {
-        return const_cast<T&>(static_cast<const vector<T> &>(*this)[index])
+    template<class T, class Allocator, class GrowthPolicy, class Predicate>
+    inline std::size_t erase_if(vector<T, Allocator, GrowthPolicy> &values, Predicate pred) {
+        return values.erase_if(pred);
     }
     
-    /*******************************************************
-     * Перегруженный оператор [] (обращение к элементу вектора)
+    /********************************************************
+     * Вектор с выровненным буфером
      ********************************************************
-     * Описание выше
+     * Буфер выровнен на Alignment байт, буферы от
+     * HugePageThreshold байт лежат на больших страницах
+     * (см. aligned_allocator)
      */
     
-    template<class T>
-    const T& vector<T>::operator [](const std::size_t &index) const {
-        if (index > size_)
-            throw std::out_of_range("Index more than size of vector!");
-        return data_[index];
+    template<class T, std::size_t Alignment = 64, std::size_t HugePageThreshold = std::size_t(-1),
+             class GrowthPolicy = growth_double>
+    using aligned_vector = vector<T, aligned_allocator<T, Alignment, HugePageThreshold>, GrowthPolicy>;
+    
+    /********************************************************
+     * Поиск первого различия двух векторов
+     ********************************************************
+     * Для арифметических элементов работает через векторные
+     * ядра (см. compare.h)
+     ********************************************************
+     * \param lhs 1-й вектор
+     * \param rhs 2-й вектор
+     * \return Индекс первого различающегося элемента или
+     * размер меньшего вектора, если он совпадает с началом
+     * большего
+     */
+    
+    template<class T, class Allocator, class GrowthPolicy>
+    inline std::size_t
+    mismatch(const vector<T, Allocator, GrowthPolicy> &lhs, const vector<T, Allocator, GrowthPolicy> &rhs) {
+        return detail::mismatch(lhs.data(), rhs.data(), lhs.size() < rhs.size() ? lhs.size() : rhs.size());
     }
     
     /********************************************************
      * Перегруженный оператор == (сравнение)
      ********************************************************
+     * Целые, перечисления и указатели сравниваются memcmp,
+     * float и double - векторными ядрами (см. compare.h)
+     ********************************************************
      * \param lhs 1-й элемент сравнения
      * \param rhs 2-й элемент сравнения
      * \return True - если вектора равны, false - обратное
      */
     
-    template<class T>
+    template<class T, class Allocator, class GrowthPolicy>
     inline bool
-    operator ==(const vector<T> &lhs, const vector<T> &rhs) {
-        if (lhs.size() != rhs.size())
-            return false;
-        for (std::size_t i = 0; i < lhs.size(); ++i)
-            if (lhs[i] != rhs[i])
-                return false;
-        return true;
+    operator ==(const vector<T, Allocator, GrowthPolicy> &lhs, const vector<T, Allocator, GrowthPolicy> &rhs) {
+        return lhs.size() == rhs.size() && detail::equal(lhs.data(), rhs.data(), lhs.size());
     }
 
     /********************************************************
@@ -626,33 +2532,27 @@ namespace pva {
      * \return True - если вектора не равны, false - обратное
      */
     
-    template<class T>
+    template<class T, class Allocator, class GrowthPolicy>
     inline bool
-    operator !=(const vector<T> &lhs, const vector<T> &rhs) {
+    operator !=(const vector<T, Allocator, GrowthPolicy> &lhs, const vector<T, Allocator, GrowthPolicy> &rhs) {
         return !(lhs == rhs);
     }
     
     /********************************************************
      * Перегруженный оператор < (меньше)
      ********************************************************
+     * Лексикографическое сравнение: совпадающие участки
+     * пропускаются через mismatch
+     ********************************************************
      * \param lhs 1-й элемент сравнения
      * \param rhs 2-й элемент сравнения
      * \return True - если lhs меньше rhs, false - обратное
      */
     
-    template<class T>
+    template<class T, class Allocator, class GrowthPolicy>
     inline bool
-    operator <(const vector<T> &lhs, const vector<T> &rhs) {
-        for (std::size_t i = 0;; ++i) {
-            if (i >= rhs.size())
-                return false;
-            if (i >= lhs.size())
-                return true;
-            if (rhs[i] < lhs[i])
-                return false;
-            if (lhs[i] < rhs[i])
-                return true;
-        }
+    operator <(const vector<T, Allocator, GrowthPolicy> &lhs, const vector<T, Allocator, GrowthPolicy> &rhs) {
+        return detail::less(lhs.data(), lhs.size(), rhs.data(), rhs.size());
     }
     
     /********************************************************
@@ -663,9 +2563,9 @@ namespace pva {
      * \return True - если lhs больше rhs, false - обратное
      */
     
-    template<class T>
+    template<class T, class Allocator, class GrowthPolicy>
     inline bool
-    operator >(const vector<T> &lhs, const vector<T> &rhs) {
+    operator >(const vector<T, Allocator, GrowthPolicy> &lhs, const vector<T, Allocator, GrowthPolicy> &rhs) {
         return rhs < lhs;
     }
     
@@ -677,9 +2577,9 @@ namespace pva {
      * \return True - если lhs больше, либо равен rhs, false - обратное
      */
     
-    template<class T>
+    template<class T, class Allocator, class GrowthPolicy>
     inline bool
-    operator >=(const vector<T> &lhs, const vector<T> &rhs) {
+    operator >=(const vector<T, Allocator, GrowthPolicy> &lhs, const vector<T, Allocator, GrowthPolicy> &rhs) {
         return !(lhs < rhs);
     }
     
@@ -691,9 +2591,9 @@ namespace pva {
      * \return True - если lhs меньше, либо равен rhs, false - обратное
      */
     
-    template<class T>
+    template<class T, class Allocator, class GrowthPolicy>
     inline bool
-    operator <=(const vector<T> &lhs, const vector<T> &rhs) {
+    operator <=(const vector<T, Allocator, GrowthPolicy> &lhs, const vector<T, Allocator, GrowthPolicy> &rhs) {
         return !(lhs > rhs);
     }
     
@@ -705,10 +2605,10 @@ namespace pva {
      * \return True - если итераторы равны, false - обратное
      */
     
-    template<class T>
+    template<class T, class U>
     inline bool
-    operator ==(const iterator<T> &lhs, const iterator<T> &rhs) {
-        return lhs.pointer() == rhs.pointer();
+    operator ==(const iterator<T> &lhs, const iterator<U> &rhs) {
+        return lhs.base() == rhs.base();
     }
     
     /********************************************************
@@ -719,10 +2619,10 @@ namespace pva {
      * \return True - если итераторы не равны, false - обратное
      */
     
-    template<class T>
+    template<class T, class U>
     inline bool
-    operator !=(const iterator<T> &lhs, const iterator<T> &rhs) {
-        return lhs.pointer() != rhs.pointer();
+    operator !=(const iterator<T> &lhs, const iterator<U> &rhs) {
+        return lhs.base() != rhs.base();
     }
     
     /********************************************************
@@ -733,10 +2633,10 @@ namespace pva {
      * \return True - если lhs меньше rhs, false - обратное
      */
     
-    template<class T>
+    template<class T, class U>
     inline bool
-    operator <(const iterator<T> &lhs, const iterator<T> &rhs) {
-        return lhs.pointer() < rhs.pointer();
+    operator <(const iterator<T> &lhs, const iterator<U> &rhs) {
+        return lhs.base() < rhs.base();
     }
     
     /********************************************************
@@ -747,10 +2647,10 @@ namespace pva {
      * \return True - если lhs больше rhs, false - обратное
      */
     
-    template<class T>
+    template<class T, class U>
     inline bool
-    operator >(const iterator<T> &lhs, const iterator<T> &rhs) {
-        return lhs.pointer() > rhs.pointer();
+    operator >(const iterator<T> &lhs, const iterator<U> &rhs) {
+        return lhs.base() > rhs.base();
     }
     
     /********************************************************
@@ -761,10 +2661,10 @@ namespace pva {
      * \return True - если lhs меньше, либо равен rhs, false - обратное
      */
     
-    template<class T>
+    template<class T, class U>
     inline bool
-    operator <=(const iterator<T> &lhs, const iterator<T> &rhs) {
-        return lhs.pointer() <= rhs.pointer();
+    operator <=(const iterator<T> &lhs, const iterator<U> &rhs) {
+        return lhs.base() <= rhs.base();
     }
     
     /********************************************************
@@ -775,9 +2675,39 @@ namespace pva {
      * \return True - если lhs больше, либо равен rhs, false - обратное
      */
     
-    template<class T>
+    template<class T, class U>
     inline bool
-    operator >=(const iterator<T> &lhs, const iterator<T> &rhs) {
-        return lhs.pointer() >= rhs.pointer();
+    operator >=(const iterator<T> &lhs, const iterator<U> &rhs) {
+        return lhs.base() >= rhs.base();
+    }
+    
+    /********************************************************
+     * Перегруженный оператор - (расстояние между итераторами)
+     ********************************************************
+     * \param lhs Уменьшаемое
+     * \param rhs Вычитаемое
+     * \return Число элементов от rhs до lhs
+     */
+    
+    template<class T, class U>
+    inline typename iterator<T>::difference_type
+    operator -(const iterator<T> &lhs, const iterator<U> &rhs) {
+        return lhs.base() - rhs.base();
+    }
+    
+    /********************************************************
+     * Перегруженный оператор + (сложение числа с итератором)
+     ********************************************************
+     * \param size Число, на которое нужно переместиться
+     * \param it Итератор
+     * \return Новый итератор
+     */
+    
+    template<class T>
+    inline iterator<T>
+    operator +(const typename iterator<T>::difference_type &size, const iterator<T> &it) {
+        return it + size;
     }
 }
+
+#include "bit_vector.h"
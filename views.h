@@ -0,0 +1,1014 @@
+/********************************************************
+ * \file
+ * \brief Заголовочный файл с ленивыми представлениями
+ ********************************************************
+ * Файл содержит в себе ленивые представления над
+ * 'vector' и любым диапазоном с begin/end: 'views::filter',
+ * 'views::transform', 'views::take', 'views::stride',
+ * 'views::zip' и 'views::chunk'. Представления
+ * соединяются оператором | в конвейер, который ничего не
+ * копирует и выполняется за один проход, когда его
+ * обходят или собирают в вектор через to_vector()
+ */
+
+#pragma once
+
+#include "vector.h"
+
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace pva {
+    
+    namespace detail {
+        
+        /********************************************************
+         * Проверка, является ли It итератором произвольного
+         * доступа (длина диапазона известна за O(1))
+         */
+        
+        template<class It>
+        struct is_random_access_iterator : std::is_base_of<std::random_access_iterator_tag,
+            typename std::iterator_traits<It>::iterator_category> {};
+        
+        /********************************************************
+         * Сдвиг итератора на count элементов, но не дальше last
+         */
+        
+        template<class It>
+        void advance_bounded(It &it, std::size_t count, const It &last) {
+            if constexpr (is_random_access_iterator<It>::value) {
+                const std::size_t rest = last - it;
+                it += count < rest ? count : rest;
+            }
+            else {
+                for (; count != 0 && it != last; --count)
+                    ++it;
+            }
+        }
+    }
+    
+    /********************************************************
+     * \brief Пространство имен ленивых представлений
+     ********************************************************
+     * Представление хранит базовый диапазон (по значению,
+     * если это представление, и парой итераторов, если это
+     * контейнер) и вычисляет элементы при обходе. Над
+     * диапазонами произвольного доступа (vector, transform,
+     * take, stride, zip и chunk над ними) представления
+     * тоже произвольного доступа: у них есть size() и
+     * operator [], и to_vector() выделяет память один раз
+     * под точное число элементов. После filter длина
+     * неизвестна, и представления становятся однонаправленными.
+     * Итераторы ссылаются на свое представление: оно должно
+     * жить и не перемещаться, пока его обходят
+     */
+    
+    namespace views {
+        
+        /********************************************************
+         * \brief Метка представления: представления копируются
+         * в конвейер по значению, контейнеры - нет
+         */
+        
+        struct view_base {};
+        
+        template<class Allocator = void, class View>
+        auto to_vector(const View &view);
+        
+        /********************************************************
+         * \brief Общая часть представлений
+         ********************************************************
+         * Derived - класс представления с begin() и end()
+         */
+        
+        template<class Derived>
+        class view_interface : public view_base {
+        public:
+            bool empty() const {
+                return derived().begin() == derived().end();
+            }
+            
+            /********************************************************
+             * Сборка представления в вектор за один проход
+             ********************************************************
+             * \return vector<value_type, Allocator> (по умолчанию
+             * с malloc_allocator)
+             */
+            
+            template<class Allocator = void>
+            auto to_vector() const {
+                return views::to_vector<Allocator>(derived());
+            }
+        
+        private:
+            const Derived& derived() const noexcept {
+                return static_cast<const Derived&>(*this);
+            }
+        };
+        
+        /********************************************************
+         * \brief Итератор представления произвольного доступа
+         ********************************************************
+         * Хранит представление и индекс элемента, разыменование
+         * - operator [] представления. value_type берется у
+         * представления: у zip это пара значений, а не ссылок.
+         * Цепочка представлений над вектором сводится к
+         * обращению по индексу к его элементам, и цикл по ней
+         * компилятор сворачивает в один проход
+         */
+        
+        template<class View>
+        class index_iterator {
+        public:
+            typedef std::random_access_iterator_tag iterator_category;
+            typedef decltype(std::declval<const View&>()[0]) reference;
+            typedef typename View::value_type value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef void pointer;
+            
+            index_iterator() noexcept
+            :view_(nullptr), index_(0) {}
+            
+            index_iterator(const View* view, std::size_t index) noexcept
+            :view_(view), index_(index) {}
+            
+            reference operator *() const {
+                return (*view_)[index_];
+            }
+            
+            reference operator [](const difference_type &size) const {
+                return (*view_)[index_ + size];
+            }
+            
+            index_iterator& operator ++() noexcept {
+                ++index_;
+                return *this;
+            }
+            
+            index_iterator operator ++(int) noexcept {
+                index_iterator old(*this);
+                ++index_;
+                return old;
+            }
+            
+            index_iterator& operator --() noexcept {
+                --index_;
+                return *this;
+            }
+            
+            index_iterator operator --(int) noexcept {
+                index_iterator old(*this);
+                --index_;
+                return old;
+            }
+            
+            index_iterator& operator +=(const difference_type &size) noexcept {
+                index_ += size;
+                return *this;
+            }
+            
+            index_iterator operator +(const difference_type &size) const noexcept {
+                return index_iterator(view_, index_ + size);
+            }
+            
+            friend index_iterator operator +(const difference_type &size, const index_iterator &it) noexcept {
+                return it + size;
+            }
+            
+            index_iterator& operator -=(const difference_type &size) noexcept {
+                index_ -= size;
+                return *this;
+            }
+            
+            index_iterator operator -(const difference_type &size) const noexcept {
+                return index_iterator(view_, index_ - size);
+            }
+            
+            difference_type operator -(const index_iterator &other) const noexcept {
+                return difference_type(index_) - difference_type(other.index_);
+            }
+            
+            bool operator ==(const index_iterator &other) const noexcept {
+                return index_ == other.index_;
+            }
+            
+            bool operator !=(const index_iterator &other) const noexcept {
+                return index_ != other.index_;
+            }
+            
+            bool operator <(const index_iterator &other) const noexcept {
+                return index_ < other.index_;
+            }
+            
+            bool operator >(const index_iterator &other) const noexcept {
+                return index_ > other.index_;
+            }
+            
+            bool operator <=(const index_iterator &other) const noexcept {
+                return index_ <= other.index_;
+            }
+            
+            bool operator >=(const index_iterator &other) const noexcept {
+                return index_ >= other.index_;
+            }
+        
+        private:
+            const View* view_; /*< Представление*/
+            std::size_t index_; /*< Индекс элемента*/
+        };
+        
+        /********************************************************
+         * \brief Диапазон [first, last) базового контейнера
+         ********************************************************
+         * Начало любого конвейера: контейнер в нем заменяется
+         * парой своих итераторов. Им же являются куски chunk
+         */
+        
+        template<class It>
+        class subrange : public view_interface<subrange<It>> {
+        public:
+            typedef It iterator;
+            typedef typename std::iterator_traits<It>::value_type value_type;
+            
+            subrange()
+            :first_(), last_() {}
+            
+            subrange(It first, It last)
+            :first_(first), last_(last) {}
+            
+            It begin() const {
+                return first_;
+            }
+            
+            It end() const {
+                return last_;
+            }
+            
+            std::size_t size() const {
+                return last_ - first_;
+            }
+            
+            decltype(auto) operator [](const std::size_t &index) const {
+                return first_[index];
+            }
+        
+        private:
+            It first_; /*< Начало диапазона*/
+            It last_; /*< Конец диапазона*/
+        };
+        
+        /********************************************************
+         * Представление над range
+         ********************************************************
+         * Представление копируется (перемещается), контейнер
+         * заменяется subrange своих итераторов. Временный
+         * контейнер запрещен: он разрушится раньше, чем
+         * конвейер будет обойден
+         */
+        
+        template<class Range>
+        auto all(Range &&range) {
+            typedef typename std::decay<Range>::type range_type;
+            if constexpr (std::is_base_of<view_base, range_type>::value)
+                return range_type(std::forward<Range>(range));
+            else {
+                static_assert(std::is_lvalue_reference<Range>::value, "views over a temporary container would dangle");
+                return subrange<decltype(std::begin(range))>(std::begin(range), std::end(range));
+            }
+        }
+        
+        template<class Range>
+        using all_t = decltype(views::all(std::declval<Range>()));
+        
+        /********************************************************
+         * \brief Адаптор для оператора |
+         ********************************************************
+         * Хранит функцию, которая строит представление из
+         * диапазона слева от |
+         */
+        
+        template<class Function>
+        class range_adaptor {
+        public:
+            explicit range_adaptor(Function make)
+            :make_(std::move(make)) {}
+            
+            template<class Range>
+            friend auto operator |(Range &&range, const range_adaptor &adaptor) {
+                return adaptor.make_(std::forward<Range>(range));
+            }
+        
+        private:
+            Function make_; /*< Построение представления*/
+        };
+        
+        template<class Function>
+        range_adaptor<Function> make_adaptor(Function make) {
+            return range_adaptor<Function>(std::move(make));
+        }
+        
+        /********************************************************
+         * \brief Элементы базы, для которых pred истинен
+         ********************************************************
+         * Однонаправленное: число элементов известно только
+         * после обхода. begin() ищет первый подходящий элемент
+         * при каждом вызове
+         */
+        
+        template<class Base, class Pred>
+        class filter_view : public view_interface<filter_view<Base, Pred>> {
+            typedef typename Base::iterator base_iterator;
+        
+        public:
+            class iterator {
+            public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef typename std::iterator_traits<base_iterator>::value_type value_type;
+                typedef typename std::iterator_traits<base_iterator>::difference_type difference_type;
+                typedef typename std::iterator_traits<base_iterator>::reference reference;
+                typedef typename std::iterator_traits<base_iterator>::pointer pointer;
+                
+                iterator()
+                :current_(), last_(), pred_(nullptr) {}
+                
+                iterator(base_iterator current, base_iterator last, const Pred* pred)
+                :current_(current), last_(last), pred_(pred) {
+                    satisfy();
+                }
+                
+                reference operator *() const {
+                    return *current_;
+                }
+                
+                iterator& operator ++() {
+                    ++current_;
+                    satisfy();
+                    return *this;
+                }
+                
+                iterator operator ++(int) {
+                    iterator old(*this);
+                    ++*this;
+                    return old;
+                }
+                
+                bool operator ==(const iterator &other) const {
+                    return current_ == other.current_;
+                }
+                
+                bool operator !=(const iterator &other) const {
+                    return current_ != other.current_;
+                }
+            
+            private:
+                /********************************************************
+                 * Пропуск элементов, для которых pred ложен
+                 */
+                
+                void satisfy() {
+                    while (current_ != last_ && !(*pred_)(*current_))
+                        ++current_;
+                }
+                
+                base_iterator current_; /*< Текущий элемент базы*/
+                base_iterator last_; /*< Конец базы*/
+                const Pred* pred_; /*< Условие*/
+            };
+            
+            typedef typename iterator::value_type value_type;
+            
+            filter_view(Base base, Pred pred)
+            :base_(std::move(base)), pred_(std::move(pred)) {}
+            
+            iterator begin() const {
+                return iterator(base_.begin(), base_.end(), &pred_);
+            }
+            
+            iterator end() const {
+                return iterator(base_.end(), base_.end(), &pred_);
+            }
+        
+        private:
+            Base base_; /*< Базовый диапазон*/
+            Pred pred_; /*< Условие*/
+        };
+        
+        /********************************************************
+         * \brief Элементы базы, преобразованные fun
+         ********************************************************
+         * fun вызывается при каждом разыменовании итератора,
+         * его результат не запоминается
+         */
+        
+        template<class Base, class Function>
+        class transform_view : public view_interface<transform_view<Base, Function>> {
+            typedef typename Base::iterator base_iterator;
+        
+        public:
+            class forward_iterator {
+            public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef decltype(std::declval<const Function&>()(*std::declval<base_iterator>())) reference;
+                typedef typename std::remove_cv<typename std::remove_reference<reference>::type>::type value_type;
+                typedef typename std::iterator_traits<base_iterator>::difference_type difference_type;
+                typedef void pointer;
+                
+                forward_iterator()
+                :current_(), fun_(nullptr) {}
+                
+                forward_iterator(base_iterator current, const Function* fun)
+                :current_(current), fun_(fun) {}
+                
+                reference operator *() const {
+                    return (*fun_)(*current_);
+                }
+                
+                forward_iterator& operator ++() {
+                    ++current_;
+                    return *this;
+                }
+                
+                forward_iterator operator ++(int) {
+                    forward_iterator old(*this);
+                    ++current_;
+                    return old;
+                }
+                
+                bool operator ==(const forward_iterator &other) const {
+                    return current_ == other.current_;
+                }
+                
+                bool operator !=(const forward_iterator &other) const {
+                    return current_ != other.current_;
+                }
+            
+            private:
+                base_iterator current_; /*< Текущий элемент базы*/
+                const Function* fun_; /*< Преобразование*/
+            };
+            
+            typedef typename forward_iterator::value_type value_type;
+            
+            static constexpr bool random_access = detail::is_random_access_iterator<base_iterator>::value;
+            typedef typename std::conditional<random_access, index_iterator<transform_view>, forward_iterator>::type iterator;
+            
+            transform_view(Base base, Function fun)
+            :base_(std::move(base)), fun_(std::move(fun)) {}
+            
+            iterator begin() const {
+                if constexpr (random_access)
+                    return iterator(this, 0);
+                else
+                    return iterator(base_.begin(), &fun_);
+            }
+            
+            iterator end() const {
+                if constexpr (random_access)
+                    return iterator(this, base_.size());
+                else
+                    return iterator(base_.end(), &fun_);
+            }
+            
+            std::size_t size() const {
+                return base_.size();
+            }
+            
+            decltype(auto) operator [](const std::size_t &index) const {
+                return fun_(base_[index]);
+            }
+        
+        private:
+            Base base_; /*< Базовый диапазон*/
+            Function fun_; /*< Преобразование*/
+        };
+        
+        /********************************************************
+         * \brief Первые count элементов базы
+         ********************************************************
+         * Над однонаправленной базой обход останавливается на
+         * count-м элементе, не дочитывая базу: после него
+         * итератор сразу становится концом, не сдвигая базу
+         * (после filter условие дальше не проверяется)
+         */
+        
+        template<class Base>
+        class take_view : public view_interface<take_view<Base>> {
+            typedef typename Base::iterator base_iterator;
+        
+        public:
+            class forward_iterator {
+            public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef typename std::iterator_traits<base_iterator>::value_type value_type;
+                typedef typename std::iterator_traits<base_iterator>::difference_type difference_type;
+                typedef typename std::iterator_traits<base_iterator>::reference reference;
+                typedef typename std::iterator_traits<base_iterator>::pointer pointer;
+                
+                forward_iterator()
+                :current_(), last_(), rest_(0) {}
+                
+                forward_iterator(base_iterator current, base_iterator last, std::size_t rest)
+                :current_(rest ? current : last), last_(last), rest_(rest) {}
+                
+                reference operator *() const {
+                    return *current_;
+                }
+                
+                forward_iterator& operator ++() {
+                    if (--rest_)
+                        ++current_;
+                    else
+                        current_ = last_;
+                    return *this;
+                }
+                
+                forward_iterator operator ++(int) {
+                    forward_iterator old(*this);
+                    ++*this;
+                    return old;
+                }
+                
+                bool operator ==(const forward_iterator &other) const {
+                    return current_ == other.current_;
+                }
+                
+                bool operator !=(const forward_iterator &other) const {
+                    return current_ != other.current_;
+                }
+            
+            private:
+                base_iterator current_; /*< Текущий элемент базы*/
+                base_iterator last_; /*< Конец базы*/
+                std::size_t rest_; /*< Сколько элементов осталось взять*/
+            };
+            
+            typedef typename forward_iterator::value_type value_type;
+            
+            static constexpr bool random_access = detail::is_random_access_iterator<base_iterator>::value;
+            typedef typename std::conditional<random_access, index_iterator<take_view>, forward_iterator>::type iterator;
+            
+            take_view(Base base, const std::size_t &count)
+            :base_(std::move(base)), count_(count) {}
+            
+            iterator begin() const {
+                if constexpr (random_access)
+                    return iterator(this, 0);
+                else
+                    return iterator(base_.begin(), base_.end(), count_);
+            }
+            
+            iterator end() const {
+                if constexpr (random_access)
+                    return iterator(this, size());
+                else
+                    return iterator(base_.end(), base_.end(), 0);
+            }
+            
+            std::size_t size() const {
+                const std::size_t size = base_.size();
+                return count_ < size ? count_ : size;
+            }
+            
+            decltype(auto) operator [](const std::size_t &index) const {
+                return base_[index];
+            }
+        
+        private:
+            Base base_; /*< Базовый диапазон*/
+            std::size_t count_; /*< Сколько элементов взять*/
+        };
+        
+        /********************************************************
+         * \brief Каждый step-й элемент базы, начиная с первого
+         */
+        
+        template<class Base>
+        class stride_view : public view_interface<stride_view<Base>> {
+            typedef typename Base::iterator base_iterator;
+        
+        public:
+            class forward_iterator {
+            public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef typename std::iterator_traits<base_iterator>::value_type value_type;
+                typedef typename std::iterator_traits<base_iterator>::difference_type difference_type;
+                typedef typename std::iterator_traits<base_iterator>::reference reference;
+                typedef typename std::iterator_traits<base_iterator>::pointer pointer;
+                
+                forward_iterator()
+                :current_(), last_(), step_(1) {}
+                
+                forward_iterator(base_iterator current, base_iterator last, std::size_t step)
+                :current_(current), last_(last), step_(step) {}
+                
+                reference operator *() const {
+                    return *current_;
+                }
+                
+                forward_iterator& operator ++() {
+                    detail::advance_bounded(current_, step_, last_);
+                    return *this;
+                }
+                
+                forward_iterator operator ++(int) {
+                    forward_iterator old(*this);
+                    ++*this;
+                    return old;
+                }
+                
+                bool operator ==(const forward_iterator &other) const {
+                    return current_ == other.current_;
+                }
+                
+                bool operator !=(const forward_iterator &other) const {
+                    return current_ != other.current_;
+                }
+            
+            private:
+                base_iterator current_; /*< Текущий элемент базы*/
+                base_iterator last_; /*< Конец базы*/
+                std::size_t step_; /*< Шаг*/
+            };
+            
+            typedef typename forward_iterator::value_type value_type;
+            
+            static constexpr bool random_access = detail::is_random_access_iterator<base_iterator>::value;
+            typedef typename std::conditional<random_access, index_iterator<stride_view>, forward_iterator>::type iterator;
+            
+            stride_view(Base base, const std::size_t &step)
+            :base_(std::move(base)), step_(step) {
+                if (step == 0)
+                    throw std::invalid_argument("Stride must be positive!");
+            }
+            
+            iterator begin() const {
+                if constexpr (random_access)
+                    return iterator(this, 0);
+                else
+                    return iterator(base_.begin(), base_.end(), step_);
+            }
+            
+            iterator end() const {
+                if constexpr (random_access)
+                    return iterator(this, size());
+                else
+                    return iterator(base_.end(), base_.end(), step_);
+            }
+            
+            std::size_t size() const {
+                return (base_.size() + step_ - 1) / step_;
+            }
+            
+            decltype(auto) operator [](const std::size_t &index) const {
+                return base_[index * step_];
+            }
+        
+        private:
+            Base base_; /*< Базовый диапазон*/
+            std::size_t step_; /*< Шаг*/
+        };
+        
+        /********************************************************
+         * \brief Пары элементов first и second с одинаковыми
+         * индексами
+         ********************************************************
+         * Длина - меньшая из длин диапазонов. Элемент -
+         * std::pair ссылок на элементы баз, в вектор
+         * собирается std::pair значений
+         */
+        
+        template<class First, class Second>
+        class zip_view : public view_interface<zip_view<First, Second>> {
+            typedef typename First::iterator first_iterator;
+            typedef typename Second::iterator second_iterator;
+        
+        public:
+            class forward_iterator {
+            public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef std::pair<typename std::iterator_traits<first_iterator>::value_type,
+                                  typename std::iterator_traits<second_iterator>::value_type> value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef std::pair<typename std::iterator_traits<first_iterator>::reference,
+                                  typename std::iterator_traits<second_iterator>::reference> reference;
+                typedef void pointer;
+                
+                forward_iterator()
+                :first_(), second_() {}
+                
+                forward_iterator(first_iterator first, second_iterator second)
+                :first_(first), second_(second) {}
+                
+                reference operator *() const {
+                    return reference(*first_, *second_);
+                }
+                
+                forward_iterator& operator ++() {
+                    ++first_;
+                    ++second_;
+                    return *this;
+                }
+                
+                forward_iterator operator ++(int) {
+                    forward_iterator old(*this);
+                    ++*this;
+                    return old;
+                }
+                
+                /********************************************************
+                 * Итераторы равны, если совпала позиция хотя бы в
+                 * одном диапазоне: обход заканчивается на конце
+                 * короткого
+                 */
+                
+                bool operator ==(const forward_iterator &other) const {
+                    return first_ == other.first_ || second_ == other.second_;
+                }
+                
+                bool operator !=(const forward_iterator &other) const {
+                    return !(*this == other);
+                }
+            
+            private:
+                first_iterator first_; /*< Текущий элемент first*/
+                second_iterator second_; /*< Текущий элемент second*/
+            };
+            
+            typedef typename forward_iterator::value_type value_type;
+            
+            static constexpr bool random_access = detail::is_random_access_iterator<first_iterator>::value &&
+                                                  detail::is_random_access_iterator<second_iterator>::value;
+            typedef typename std::conditional<random_access, index_iterator<zip_view>, forward_iterator>::type iterator;
+            
+            zip_view(First first, Second second)
+            :first_(std::move(first)), second_(std::move(second)) {}
+            
+            iterator begin() const {
+                if constexpr (random_access)
+                    return iterator(this, 0);
+                else
+                    return iterator(first_.begin(), second_.begin());
+            }
+            
+            iterator end() const {
+                if constexpr (random_access)
+                    return iterator(this, size());
+                else
+                    return iterator(first_.end(), second_.end());
+            }
+            
+            std::size_t size() const {
+                const std::size_t first = first_.size();
+                const std::size_t second = second_.size();
+                return first < second ? first : second;
+            }
+            
+            typename forward_iterator::reference operator [](const std::size_t &index) const {
+                return typename forward_iterator::reference(first_[index], second_[index]);
+            }
+        
+        private:
+            First first_; /*< Первый диапазон*/
+            Second second_; /*< Второй диапазон*/
+        };
+        
+        /********************************************************
+         * \brief База, разбитая на куски по count элементов
+         ********************************************************
+         * Кусок - subrange итераторов базы (последний может
+         * быть короче). Если база - представление, куски
+         * ссылаются на chunk_view и действительны, пока оно
+         * живо
+         */
+        
+        template<class Base>
+        class chunk_view : public view_interface<chunk_view<Base>> {
+            typedef typename Base::iterator base_iterator;
+        
+        public:
+            class forward_iterator {
+            public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef subrange<base_iterator> value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef subrange<base_iterator> reference;
+                typedef void pointer;
+                
+                forward_iterator()
+                :current_(), next_(), last_(), count_(1) {}
+                
+                forward_iterator(base_iterator current, base_iterator last, std::size_t count)
+                :current_(current), next_(current), last_(last), count_(count) {
+                    detail::advance_bounded(next_, count_, last_);
+                }
+                
+                reference operator *() const {
+                    return reference(current_, next_);
+                }
+                
+                forward_iterator& operator ++() {
+                    current_ = next_;
+                    detail::advance_bounded(next_, count_, last_);
+                    return *this;
+                }
+                
+                forward_iterator operator ++(int) {
+                    forward_iterator old(*this);
+                    ++*this;
+                    return old;
+                }
+                
+                bool operator ==(const forward_iterator &other) const {
+                    return current_ == other.current_;
+                }
+                
+                bool operator !=(const forward_iterator &other) const {
+                    return current_ != other.current_;
+                }
+            
+            private:
+                base_iterator current_; /*< Начало куска*/
+                base_iterator next_; /*< Конец куска*/
+                base_iterator last_; /*< Конец базы*/
+                std::size_t count_; /*< Размер куска*/
+            };
+            
+            typedef typename forward_iterator::value_type value_type;
+            
+            static constexpr bool random_access = detail::is_random_access_iterator<base_iterator>::value;
+            typedef typename std::conditional<random_access, index_iterator<chunk_view>, forward_iterator>::type iterator;
+            
+            chunk_view(Base base, const std::size_t &count)
+            :base_(std::move(base)), count_(count) {
+                if (count == 0)
+                    throw std::invalid_argument("Chunk size must be positive!");
+            }
+            
+            iterator begin() const {
+                if constexpr (random_access)
+                    return iterator(this, 0);
+                else
+                    return iterator(base_.begin(), base_.end(), count_);
+            }
+            
+            iterator end() const {
+                if constexpr (random_access)
+                    return iterator(this, size());
+                else
+                    return iterator(base_.end(), base_.end(), count_);
+            }
+            
+            std::size_t size() const {
+                return (base_.size() + count_ - 1) / count_;
+            }
+            
+            subrange<base_iterator> operator [](const std::size_t &index) const {
+                const std::size_t size = base_.size();
+                const std::size_t first = index * count_;
+                const std::size_t last = size - first < count_ ? size : first + count_;
+                const base_iterator begin = base_.begin();
+                return subrange<base_iterator>(begin + first, begin + last);
+            }
+        
+        private:
+            Base base_; /*< Базовый диапазон*/
+            std::size_t count_; /*< Размер куска*/
+        };
+        
+        /********************************************************
+         * Элементы range, для которых pred истинен
+         ********************************************************
+         * \param range Вектор (lvalue) или представление
+         * \param pred Условие
+         */
+        
+        template<class Range, class Pred>
+        auto filter(Range &&range, Pred pred) {
+            return filter_view<all_t<Range>, Pred>(views::all(std::forward<Range>(range)), std::move(pred));
+        }
+        
+        template<class Pred>
+        auto filter(Pred pred) {
+            return make_adaptor([pred](auto &&range) {
+                return views::filter(std::forward<decltype(range)>(range), pred);
+            });
+        }
+        
+        /********************************************************
+         * Элементы range, преобразованные fun
+         ********************************************************
+         * \param range Вектор (lvalue) или представление
+         * \param fun Преобразование элемента
+         */
+        
+        template<class Range, class Function>
+        auto transform(Range &&range, Function fun) {
+            return transform_view<all_t<Range>, Function>(views::all(std::forward<Range>(range)), std::move(fun));
+        }
+        
+        template<class Function>
+        auto transform(Function fun) {
+            return make_adaptor([fun](auto &&range) {
+                return views::transform(std::forward<decltype(range)>(range), fun);
+            });
+        }
+        
+        /********************************************************
+         * Первые count элементов range
+         */
+        
+        template<class Range>
+        auto take(Range &&range, const std::size_t &count) {
+            return take_view<all_t<Range>>(views::all(std::forward<Range>(range)), count);
+        }
+        
+        inline auto take(const std::size_t &count) {
+            return make_adaptor([count](auto &&range) {
+                return views::take(std::forward<decltype(range)>(range), count);
+            });
+        }
+        
+        /********************************************************
+         * Каждый step-й элемент range
+         ********************************************************
+         * \throw std::invalid_argument Если step равен 0
+         */
+        
+        template<class Range>
+        auto stride(Range &&range, const std::size_t &step) {
+            return stride_view<all_t<Range>>(views::all(std::forward<Range>(range)), step);
+        }
+        
+        inline auto stride(const std::size_t &step) {
+            if (step == 0)
+                throw std::invalid_argument("Stride must be positive!");
+            return make_adaptor([step](auto &&range) {
+                return views::stride(std::forward<decltype(range)>(range), step);
+            });
+        }
+        
+        /********************************************************
+         * Пары элементов first и second с одинаковыми индексами
+         */
+        
+        template<class First, class Second>
+        auto zip(First &&first, Second &&second) {
+            return zip_view<all_t<First>, all_t<Second>>(views::all(std::forward<First>(first)),
+                                                         views::all(std::forward<Second>(second)));
+        }
+        
+        /********************************************************
+         * Куски range по count элементов
+         ********************************************************
+         * \throw std::invalid_argument Если count равен 0
+         */
+        
+        template<class Range>
+        auto chunk(Range &&range, const std::size_t &count) {
+            return chunk_view<all_t<Range>>(views::all(std::forward<Range>(range)), count);
+        }
+        
+        inline auto chunk(const std::size_t &count) {
+            if (count == 0)
+                throw std::invalid_argument("Chunk size must be positive!");
+            return make_adaptor([count](auto &&range) {
+                return views::chunk(std::forward<decltype(range)>(range), count);
+            });
+        }
+        
+        /********************************************************
+         * Сборка представления в вектор
+         ********************************************************
+         * Над диапазоном произвольного доступа память
+         * выделяется один раз под size() элементов, и элементы
+         * создаются сразу на месте без проверок емкости. Иначе
+         * элементы добавляются по одному за тот же единственный
+         * проход
+         ********************************************************
+         * \param view Представление
+         * \return vector<value_type, Allocator> (по умолчанию
+         * с malloc_allocator)
+         */
+        
+        template<class Allocator, class View>
+        auto to_vector(const View &view) {
+            typedef typename View::iterator view_iterator;
+            typedef typename View::value_type value_type;
+            typedef typename std::conditional<std::is_void<Allocator>::value, malloc_allocator<value_type>,
+                                              Allocator>::type allocator_type;
+            typedef vector<value_type, allocator_type> result;
+            if constexpr (detail::is_random_access_iterator<view_iterator>::value)
+                return result(view.begin(), view.end());
+            else {
+                result out;
+                for (view_iterator it = view.begin(), last = view.end(); it != last; ++it)
+                    out.emplace_back(*it);
+                return out;
+            }
+        }
+    }
+}